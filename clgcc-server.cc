@@ -0,0 +1,766 @@
+/**
+   https://github.com/bstarynk/clips-rules-gcc
+
+   file clgcc-server.cc is a compile server keeping warm CLIPS
+   environments for the clipsgccplug plugin. To be indented with
+   astyle --style=gnu -s2 clgcc-server.cc
+
+   Copyright © 2020 CEA (Commissariat à l'énergie atomique et aux énergies alternatives)
+   contributed by Basile Starynkevitch.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+**/
+
+/***
+ The protocol, on a UNIX stream socket, is made of messages starting
+ with a keyword. Symbols (kind y) and strings (kind s) are encoded as
+ their kind, their byte length, a colon, then their bytes. From the
+ plugin (see clips-gcc-client.cc):
+
+   HELLO <key>                   # the rules key, see CLGCC_rules_key
+   TEMPLATE <name> <nbslots> <slotname>... s<len>:<deftemplate source>
+   LOAD s<len>:<path>            # a CLIPS file to batch
+   READY                         # answered by OK warm|cold
+   F <name> <value>...           # assert a fact, one value per slot;
+                                 #   consecutive F messages are
+                                 #   asserted as one batch
+   MARK                          # start the facts of a function
+   SCOPED                        # run the rules, then retract since MARK
+   RUN                           # answered by OUT <len> <bytes>...
+                                 #   DIAG <len> <values>... DONE <nbfired>
+   BYE                           # the environment is reset then reused
+
+ Values are - (the slot default), i<integer>, f<float>, y<len>:<bytes>,
+ s<len>:<bytes> or m<count> followed by <count> values. The <len>
+ bytes of a DIAG message are the values, each preceded by a space, of
+ the slots of a gcc-diagnostic fact asserted by the rules. All the
+ environments built for the same key are interchangeable, and every
+ connection gets its own environment, so concurrent compilations of a
+ make -j build are served in parallel, each by its own thread.
+***/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+#include <cstdarg>
+#include <cctype>
+
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <getopt.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+extern "C" {
+#include "clips.h"
+#include "tmpltutl.h"
+};				// end include clips.h as "C"
+
+extern "C" int clgcc_debug;
+extern "C" FILE* clgcc_dbgfile;
+extern "C" const char*CLGCC_basename(const char*);
+extern "C" void CLGCC_dodbgprintf(const char*srcfil, int lin, const char*fmt, ...);
+
+int clgcc_debug;
+FILE* clgcc_dbgfile;
+
+/// a warm environment, with the output captured by its router
+struct clgcc_warm_env_st
+{
+  Environment* wenv;
+  std::string* wcapture;
+};
+
+/// the idle warm environments, by rules key
+static std::mutex clgcc_poolmtx;
+static std::map<std::string,std::vector<clgcc_warm_env_st>> clgcc_idle_envs;
+static unsigned clgcc_max_idle = 8;
+/// the threads pattern matching each batch of F messages, set by -t
+static unsigned clgcc_alpha_threads = 0;
+/// the most values a multifield of an F message may have
+static const long long clgcc_max_multifield = 1 << 20;
+
+
+const char*CLGCC_basename(const char* path)
+{
+  if (!path)
+    return NULL;
+  const char* lastsl = strrchr(path, '/');
+  if (lastsl && lastsl[1])
+    return lastsl+1;
+  return path;
+} // end of CLGCC_basename
+
+
+void
+CLGCC_dodbgprintf(const char*srcfil, int lin, const char*fmt, ...)
+{
+  if (!clgcc_dbgfile)
+    clgcc_dbgfile = stderr;
+  va_list args;
+  va_start (args,fmt);
+  fprintf (clgcc_dbgfile, "¤%s:%d: ", CLGCC_basename(srcfil), lin);
+  vfprintf (clgcc_dbgfile, fmt, args);
+  va_end(args);
+  putc ('\n', clgcc_dbgfile);
+  fflush (clgcc_dbgfile);
+} // end CLGCC_dodbgprintf
+
+
+////////////////////////////////////////////////////////////////
+/// the output of an environment is captured by a router, to be sent
+/// back to the plugin after RUN
+static bool
+clgcc_capture_query(Environment*, const char*logname, void*)
+{
+  return !strcmp(logname, STDOUT) || !strcmp(logname, STDERR)
+         || !strcmp(logname, STDWRN);
+} // end clgcc_capture_query
+
+static void
+clgcc_capture_write(Environment*, const char*, const char*str, void*ctx)
+{
+  static_cast<std::string*>(ctx)->append(str);
+} // end clgcc_capture_write
+
+/// a deftemplate described by some TEMPLATE message
+struct clgcc_template_st
+{
+  std::string tmpl_name;
+  std::vector<std::string> tmpl_slotnames;
+  std::string tmpl_source;
+  std::vector<unsigned short> tmpl_slotix;
+  Fact_Builder* tmpl_builder;
+};
+
+
+class Clgcc_Connection
+{
+  int conn_fd;
+  std::string conn_inbuf;
+  size_t conn_inpos;
+  std::string conn_outbuf;
+  std::string conn_key;
+  std::vector<std::string> conn_loads;
+  std::map<std::string,clgcc_template_st> conn_templates;
+  Environment* conn_env;
+  std::string* conn_capture;
+  Multifield_Builder* conn_mb;
+  /// the first fact index of the current function, see MARK
+  long long conn_mark;
+  /// the rules fired by SCOPED since the last RUN
+  long long conn_nbfired;
+  /// the DIAG messages collected since the last RUN
+  std::string conn_diagnostics;
+  /// true while consecutive F messages are asserted as one batch
+  bool conn_batching;
+  bool fill(size_t nbytes);
+  int peek(void);
+  bool expect(char c);
+  bool read_word(std::string&word);
+  bool read_number(long long&num);
+  bool read_lexeme(char kind, std::string&str);
+  bool read_value(CLIPSValue&val);
+  void send(const std::string&msg);
+  void flush(void);
+  bool checkout_env(bool&warm);
+  void release_env(bool reusable);
+  bool prepare_templates(void);
+  bool assert_fact(void);
+  void end_batch(void);
+  void harvest_diagnostics(void);
+public:
+  Clgcc_Connection(int fd)
+    : conn_fd(fd), conn_inbuf(), conn_inpos(0), conn_outbuf(), conn_key(),
+      conn_loads(), conn_templates(), conn_env(nullptr), conn_capture(nullptr),
+      conn_mb(nullptr), conn_mark(0), conn_nbfired(0), conn_diagnostics(),
+      conn_batching(false) {};
+  ~Clgcc_Connection();
+  void serve(void);
+};				// end class Clgcc_Connection
+
+
+Clgcc_Connection::~Clgcc_Connection()
+{
+  if (conn_env)
+    release_env(false);
+  if (conn_fd >= 0)
+    close(conn_fd);
+} // end Clgcc_Connection::~Clgcc_Connection
+
+
+bool
+Clgcc_Connection::fill(size_t nbytes)
+{
+  if (conn_inpos > 0 && conn_inpos == conn_inbuf.size())
+    {
+      conn_inbuf.clear();
+      conn_inpos = 0;
+    }
+  while (conn_inbuf.size() - conn_inpos < nbytes)
+    {
+      char buf[65536];
+      ssize_t nbr = read(conn_fd, buf, sizeof(buf));
+      if (nbr < 0 && errno == EINTR)
+        continue;
+      if (nbr <= 0)
+        return false;
+      conn_inbuf.append(buf, nbr);
+    }
+  return true;
+} // end Clgcc_Connection::fill
+
+
+int
+Clgcc_Connection::peek(void)
+{
+  if (!fill(1))
+    return EOF;
+  return (unsigned char) conn_inbuf[conn_inpos];
+} // end Clgcc_Connection::peek
+
+
+bool
+Clgcc_Connection::expect(char c)
+{
+  if (peek() != (unsigned char)c)
+    return false;
+  conn_inpos++;
+  return true;
+} // end Clgcc_Connection::expect
+
+
+/// read a word ended by a space or a newline, which is not consumed
+bool
+Clgcc_Connection::read_word(std::string&word)
+{
+  word.clear();
+  for (;;)
+    {
+      int c = peek();
+      if (c == EOF)
+        return false;
+      if (c == ' ' || c == '\n')
+        return !word.empty();
+      word.push_back((char)c);
+      conn_inpos++;
+    }
+} // end Clgcc_Connection::read_word
+
+
+bool
+Clgcc_Connection::read_number(long long&num)
+{
+  std::string word;
+  if (!read_word(word))
+    return false;
+  char*end = nullptr;
+  num = strtoll(word.c_str(), &end, 10);
+  return end && *end == '\0';
+} // end Clgcc_Connection::read_number
+
+
+bool
+Clgcc_Connection::read_lexeme(char kind, std::string&str)
+{
+  if (!expect(kind))
+    return false;
+  std::string lenstr;
+  for (int c = peek(); c != ':'; c = peek())
+    {
+      if (c == EOF || !isdigit(c))
+        return false;
+      lenstr.push_back((char)c);
+      conn_inpos++;
+    }
+  conn_inpos++;
+  size_t len = strtoul(lenstr.c_str(), nullptr, 10);
+  if (!fill(len))
+    return false;
+  str.assign(conn_inbuf, conn_inpos, len);
+  conn_inpos += len;
+  return true;
+} // end Clgcc_Connection::read_lexeme
+
+
+/// read a value, preceded by a space; a void value stands for -
+bool
+Clgcc_Connection::read_value(CLIPSValue&val)
+{
+  if (!expect(' '))
+    return false;
+  int kind = peek();
+  std::string str;
+  switch (kind)
+    {
+    case '-':
+      conn_inpos++;
+      val.voidValue = conn_env->VoidConstant;
+      return true;
+    case 'i':
+    case 'f':
+    case 'm':
+    {
+      conn_inpos++;
+      if (!read_word(str))
+        return false;
+      if (kind == 'f')
+        {
+          val.floatValue = CL_CreateFloat(conn_env, strtod(str.c_str(), nullptr));
+          return true;
+        }
+      char*end = nullptr;
+      long long num = strtoll(str.c_str(), &end, 10);
+      if (!end || *end != '\0')
+        return false;
+      if (kind == 'i')
+        {
+          val.integerValue = CL_CreateInteger(conn_env, num);
+          return true;
+        }
+      /// the values of a multifield are read before it is made, and
+      /// cannot themselves be multifields
+      if (num < 0 || num > clgcc_max_multifield)
+        return false;
+      std::vector<CLIPSValue> comps(num);
+      for (long long ix=0; ix<num; ix++)
+        if (!read_value(comps[ix]) || comps[ix].header->type == CL_VOID_TYPE
+            || comps[ix].header->type == MULTIFIELD_TYPE)
+          return false;
+      for (CLIPSValue&comp: comps)
+        CL_MBAppend(conn_mb, &comp);
+      val.multifieldValue = CL_MBCreate(conn_mb);
+      return true;
+    }
+    case 'y':
+    case 's':
+      if (!read_lexeme(kind, str))
+        return false;
+      val.lexemeValue = (kind=='y')
+                        ? CL_CreateSymbol(conn_env, str.c_str())
+                        : CL_CreateString(conn_env, str.c_str());
+      return true;
+    default:
+      return false;
+    }
+} // end Clgcc_Connection::read_value
+
+
+void
+Clgcc_Connection::send(const std::string&msg)
+{
+  conn_outbuf.append(msg);
+} // end Clgcc_Connection::send
+
+
+void
+Clgcc_Connection::flush(void)
+{
+  size_t off = 0;
+  while (off < conn_outbuf.size())
+    {
+      ssize_t nbw = write(conn_fd, conn_outbuf.data()+off, conn_outbuf.size()-off);
+      if (nbw < 0 && errno == EINTR)
+        continue;
+      if (nbw <= 0)
+        break;
+      off += nbw;
+    }
+  conn_outbuf.clear();
+} // end Clgcc_Connection::flush
+
+
+/// take an idle environment built for our key, or build a new one
+bool
+Clgcc_Connection::checkout_env(bool&warm)
+{
+  {
+    std::lock_guard<std::mutex> lock(clgcc_poolmtx);
+    std::vector<clgcc_warm_env_st>& idlevec = clgcc_idle_envs[conn_key];
+    if (!idlevec.empty())
+      {
+        conn_env = idlevec.back().wenv;
+        conn_capture = idlevec.back().wcapture;
+        idlevec.pop_back();
+        warm = true;
+        return true;
+      }
+  }
+  warm = false;
+  conn_env = CL_CreateEnvironment();
+  if (!conn_env)
+    return false;
+  CL_SetAlphaMatchThreads(conn_env, clgcc_alpha_threads);
+  conn_capture = new std::string;
+  CL_AddRouter(conn_env, "clgcc-capture", 40, clgcc_capture_query, clgcc_capture_write,
+               nullptr, nullptr, nullptr, conn_capture);
+  for (auto& it: conn_templates)
+    if (CL_Build(conn_env, it.second.tmpl_source.c_str()) != BE_NO_ERROR)
+      {
+        fprintf(stderr, "clgcc-server: failed to build deftemplate %s\n",
+                it.first.c_str());
+        release_env(false);
+        return false;
+      }
+  /// the output of these files is sent after the first RUN
+  for (const std::string& curpath: conn_loads)
+    if (!CL_BatchStar(conn_env, curpath.c_str()))
+      fprintf(stderr, "clgcc-server: failed to load %s\n", curpath.c_str());
+  return true;
+} // end Clgcc_Connection::checkout_env
+
+
+/// give back our environment, reset so that it has no facts, unless it
+/// is in some unknown state
+void
+Clgcc_Connection::release_env(bool reusable)
+{
+  end_batch();
+  for (auto& it: conn_templates)
+    if (it.second.tmpl_builder)
+      {
+        CL_FBDispose(it.second.tmpl_builder);
+        it.second.tmpl_builder = nullptr;
+      }
+  if (conn_mb)
+    CL_MBDispose(conn_mb);
+  conn_mb = nullptr;
+  Environment*env = conn_env;
+  conn_env = nullptr;
+  if (reusable)
+    {
+      CL_Reset(env);
+      conn_capture->clear();
+      std::lock_guard<std::mutex> lock(clgcc_poolmtx);
+      std::vector<clgcc_warm_env_st>& idlevec = clgcc_idle_envs[conn_key];
+      if (idlevec.size() < clgcc_max_idle)
+        {
+          idlevec.push_back(clgcc_warm_env_st {env, conn_capture});
+          conn_capture = nullptr;
+          return;
+        }
+    }
+  delete conn_capture;
+  conn_capture = nullptr;
+  CL_DestroyEnvironment(env);
+} // end Clgcc_Connection::release_env
+
+
+/// find the slot positions and make fact builders in our environment
+bool
+Clgcc_Connection::prepare_templates(void)
+{
+  for (auto& it: conn_templates)
+    {
+      clgcc_template_st& tmpl = it.second;
+      Deftemplate*dt = CL_FindDeftemplate(conn_env, tmpl.tmpl_name.c_str());
+      if (!dt)
+        return false;
+      tmpl.tmpl_slotix.clear();
+      for (const std::string& slotname: tmpl.tmpl_slotnames)
+        {
+          unsigned short whichslot = 0;
+          if (!CL_FindSlot(dt, CL_CreateSymbol(conn_env, slotname.c_str()), &whichslot))
+            return false;
+          tmpl.tmpl_slotix.push_back(whichslot);
+        }
+      tmpl.tmpl_builder = CL_CreateFact_Builder(conn_env, tmpl.tmpl_name.c_str());
+      if (!tmpl.tmpl_builder)
+        return false;
+    }
+  conn_mb = CL_CreateMultifield_Builder(conn_env, 8);
+  return true;
+} // end Clgcc_Connection::prepare_templates
+
+
+bool
+Clgcc_Connection::assert_fact(void)
+{
+  std::string name;
+  if (!expect(' ') || !read_word(name))
+    return false;
+  auto it = conn_templates.find(name);
+  if (it == conn_templates.end())
+    return false;
+  clgcc_template_st& tmpl = it->second;
+  for (unsigned short whichslot: tmpl.tmpl_slotix)
+    {
+      CLIPSValue val;
+      if (!read_value(val))
+        return false;
+      if (val.header->type != CL_VOID_TYPE)
+        CL_FBPutSlotByIndex(tmpl.tmpl_builder, whichslot, &val);
+    }
+  if (!expect('\n'))
+    return false;
+  FB_Assert(tmpl.tmpl_builder);
+  return true;
+} // end Clgcc_Connection::assert_fact
+
+
+/// the facts of consecutive F messages go thru the pattern network
+/// as they come, but reach the joins together when another message
+/// ends the batch
+void
+Clgcc_Connection::end_batch(void)
+{
+  if (!conn_batching)
+    return;
+  conn_batching = false;
+  CL_EndAssertBatch(conn_env);
+} // end Clgcc_Connection::end_batch
+
+
+/// encode the gcc-diagnostic facts into DIAG messages; the plugin
+/// removes the duplicates
+void
+Clgcc_Connection::harvest_diagnostics(void)
+{
+  auto it = conn_templates.find("gcc-diagnostic");
+  if (it == conn_templates.end())
+    return;
+  Deftemplate*dt = CL_FindDeftemplate(conn_env, "gcc-diagnostic");
+  for (Fact*fact = dt?CL_GetNextFactInTemplate(dt, nullptr):nullptr; fact;
+       fact = CL_GetNextFactInTemplate(dt, fact))
+    {
+      std::string values;
+      for (const std::string& slotname: it->second.tmpl_slotnames)
+        {
+          CLIPSValue val;
+          values.push_back(' ');
+          if (CL_GetFactSlot(fact, slotname.c_str(), &val) != GSE_NO_ERROR)
+            values.push_back('-');
+          else if (val.header->type == CL_INTEGER_TYPE)
+            values.append("i" + std::to_string(val.integerValue->contents));
+          else if (val.header->type == SYMBOL_TYPE || val.header->type == STRING_TYPE)
+            {
+              size_t len = strlen(val.lexemeValue->contents);
+              values.push_back((val.header->type == SYMBOL_TYPE)?'y':'s');
+              values.append(std::to_string(len));
+              values.push_back(':');
+              values.append(val.lexemeValue->contents, len);
+            }
+          else
+            values.push_back('-');
+        }
+      conn_diagnostics.append("DIAG " + std::to_string(values.size()) + "\n");
+      conn_diagnostics.append(values);
+    }
+} // end Clgcc_Connection::harvest_diagnostics
+
+
+void
+Clgcc_Connection::serve(void)
+{
+  std::string cmd;
+  bool byed = false;
+  while (!byed && read_word(cmd))
+    {
+      if (cmd == "F" && conn_env)
+        {
+          if (!conn_batching)
+            {
+              CL_BeginAssertBatch(conn_env);
+              conn_batching = true;
+            }
+          if (!assert_fact())
+            break;
+          continue;
+        }
+      end_batch();
+      if (cmd == "HELLO" && !conn_env)
+        {
+          if (!expect(' ') || !read_word(conn_key))
+            break;
+        }
+      else if (cmd == "TEMPLATE" && !conn_env)
+        {
+          clgcc_template_st tmpl;
+          long long nbslots = 0;
+          if (!expect(' ') || !read_word(tmpl.tmpl_name)
+              || !expect(' ') || !read_number(nbslots))
+            break;
+          for (long long ix=0; ix<nbslots; ix++)
+            {
+              std::string slotname;
+              if (!expect(' ') || !read_word(slotname))
+                break;
+              tmpl.tmpl_slotnames.push_back(slotname);
+            }
+          if (!expect(' ') || !read_lexeme('s', tmpl.tmpl_source))
+            break;
+          tmpl.tmpl_builder = nullptr;
+          conn_templates[tmpl.tmpl_name] = tmpl;
+        }
+      else if (cmd == "LOAD" && !conn_env)
+        {
+          std::string path;
+          if (!expect(' ') || !read_lexeme('s', path))
+            break;
+          conn_loads.push_back(path);
+        }
+      else if (cmd == "READY" && !conn_env && !conn_key.empty())
+        {
+          bool warm = false;
+          if (!checkout_env(warm))
+            {
+              send("ERROR no environment\n");
+              flush();
+              break;
+            }
+          if (!prepare_templates())
+            {
+              send("ERROR bad deftemplates\n");
+              flush();
+              release_env(false);
+              break;
+            }
+          send(warm?"OK warm\n":"OK cold\n");
+          flush();
+        }
+      else if (cmd == "MARK" && conn_env)
+        {
+          conn_mark = CL_FactMark(conn_env);
+        }
+      else if (cmd == "SCOPED" && conn_env)
+        {
+          /// the output is kept until the next RUN
+          conn_nbfired += CL_Run(conn_env, -1);
+          harvest_diagnostics();
+          CL_RetractFactsSince(conn_env, conn_mark);
+        }
+      else if (cmd == "RUN" && conn_env)
+        {
+          long long nbfired = conn_nbfired + CL_Run(conn_env, -1);
+          conn_nbfired = 0;
+          harvest_diagnostics();
+          if (!conn_capture->empty())
+            {
+              send("OUT " + std::to_string(conn_capture->size()) + "\n");
+              send(*conn_capture);
+              conn_capture->clear();
+            }
+          send(conn_diagnostics);
+          conn_diagnostics.clear();
+          send("DONE " + std::to_string(nbfired) + "\n");
+          flush();
+        }
+      else if (cmd == "BYE" && conn_env)
+        {
+          release_env(true);
+          byed = true;
+        }
+      else
+        break;
+      if (!expect('\n'))
+        break;
+    }
+  CLGCC_DBGPRINTF("serve fd#%d ending %s", conn_fd, byed?"normally":"abruptly");
+} // end Clgcc_Connection::serve
+
+
+static void
+clgcc_serve_connection(int fd)
+{
+  Clgcc_Connection conn(fd);
+  conn.serve();
+} // end clgcc_serve_connection
+
+
+static void
+clgcc_usage(const char*progname)
+{
+  fprintf(stderr, "usage: %s -s <socket-path> [-k <max-idle-environments>]"
+          " [-t <alpha-match-threads>] [-d]\n",
+          progname);
+} // end clgcc_usage
+
+
+int
+main(int argc, char**argv)
+{
+  const char*sockpath = nullptr;
+  int opt = 0;
+  while ((opt = getopt(argc, argv, "s:k:t:dh")) != -1)
+    {
+      switch (opt)
+        {
+        case 's':
+          sockpath = optarg;
+          break;
+        case 'k':
+          clgcc_max_idle = atoi(optarg);
+          break;
+        case 't':
+          clgcc_alpha_threads = atoi(optarg);
+          break;
+        case 'd':
+          clgcc_debug = 1;
+          break;
+        default:
+          clgcc_usage(argv[0]);
+          return EXIT_FAILURE;
+        }
+    }
+  if (!sockpath)
+    {
+      clgcc_usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  signal(SIGPIPE, SIG_IGN);
+  struct sockaddr_un sa;
+  memset (&sa, 0, sizeof(sa));
+  if (strlen(sockpath) >= sizeof(sa.sun_path))
+    {
+      fprintf(stderr, "%s: too long socket path %s\n", argv[0], sockpath);
+      return EXIT_FAILURE;
+    }
+  sa.sun_family = AF_UNIX;
+  strcpy(sa.sun_path, sockpath);
+  int lisfd = socket(AF_UNIX, SOCK_STREAM|SOCK_CLOEXEC, 0);
+  unlink(sockpath);
+  if (lisfd < 0 || bind(lisfd, (struct sockaddr*)&sa, sizeof(sa)) || listen(lisfd, 64))
+    {
+      fprintf(stderr, "%s: cannot listen on %s (%m)\n", argv[0], sockpath);
+      return EXIT_FAILURE;
+    }
+  CLGCC_DBGPRINTF("clgcc-server listening on %s", sockpath);
+  for (;;)
+    {
+      int fd = accept4(lisfd, nullptr, nullptr, SOCK_CLOEXEC);
+      if (fd < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          fprintf(stderr, "%s: accept failed (%m)\n", argv[0]);
+          return EXIT_FAILURE;
+        }
+      std::thread(clgcc_serve_connection, fd).detach();
+    }
+} // end main
+
+// end of file clgcc-server.cc
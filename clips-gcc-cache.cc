@@ -0,0 +1,326 @@
+/**
+   https://github.com/bstarynk/clips-rules-gcc
+
+   file clips-gcc-cache.cc loading CLIPS rule files, perhaps thru a
+   cache of binary images. To be indented with
+   astyle --style=gnu -s2 clips-gcc-cache.cc
+
+   Copyright © 2020 CEA (Commissariat à l'énergie atomique et aux énergies alternatives)
+   contributed by Basile Starynkevitch.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+**/
+#include "clips-gcc.hh"
+
+#include "md5.h"
+
+/// the CLIPS files given by -fplugin-arg-clipsgccplug-load=, in order
+std::vector<std::string> CLGCC_rulefiles;
+
+/// the directory given by -fplugin-arg-clipsgccplug-cache=, or empty
+std::string CLGCC_cachedir;
+
+
+/// the files read while batching our rule files, e.g. by a (load
+/// ...) command in them, see clgcc_record_opened_file
+static std::vector<std::string> clgcc_loaded_files;
+
+
+/// add the contents of a file to an MD5 computation, followed by its
+/// size, which separates the contents of consecutive files
+static bool
+clgcc_md5_file(const std::string& path, struct md5_ctx*ctx)
+{
+  FILE* fil = fopen(path.c_str(), "r");
+  if (!fil)
+    return false;
+  char buf[4096];
+  size_t nbread = 0;
+  long filesize = 0;
+  while ((nbread = fread(buf, 1, sizeof(buf), fil)) > 0)
+    {
+      md5_process_bytes (buf, nbread, ctx);
+      filesize += nbread;
+    }
+  fclose(fil);
+  snprintf(buf, sizeof(buf), "\n#%ld\n", filesize);
+  md5_process_bytes (buf, strlen(buf), ctx);
+  return true;
+} // end clgcc_md5_file
+
+
+static std::string
+clgcc_md5_hex(struct md5_ctx*ctx)
+{
+  unsigned char digest[16];
+  char hexbuf[2*sizeof(digest)+1];
+  md5_finish_ctx (ctx, digest);
+  memset (hexbuf, 0, sizeof(hexbuf));
+  for (unsigned ix=0; ix<sizeof(digest); ix++)
+    snprintf(hexbuf+2*ix, 3, "%02x", digest[ix]);
+  return std::string(hexbuf);
+} // end clgcc_md5_hex
+
+
+/// the hexadecimal MD5 of a single file, or an empty string if it is
+/// unreadable
+static std::string
+clgcc_file_md5(const std::string& path)
+{
+  struct md5_ctx ctx;
+  md5_init_ctx (&ctx);
+  if (!clgcc_md5_file(path, &ctx))
+    return std::string();
+  return clgcc_md5_hex(&ctx);
+} // end clgcc_file_md5
+
+
+/// compute the key of our rule files, an hexadecimal MD5 of the
+/// plugin build (clgcc_md5sum) and of the contents of every rule
+/// file, so changing the plugin or any rule gives another key. Gives
+/// an empty string if some file is unreadable. That key names cached
+/// binary images, and the warm environments of a compile server. The
+/// files which our rule files load are not known before batching
+/// them, so they are not part of the key: a cached image records
+/// them, see clgcc_cached_files_unchanged.
+std::string
+CLGCC_rules_key(void)
+{
+  struct md5_ctx ctx;
+  md5_init_ctx (&ctx);
+  md5_process_bytes (clgcc_md5sum, strlen(clgcc_md5sum)+1, &ctx);
+  for (const std::string& curpath: CLGCC_rulefiles)
+    if (!clgcc_md5_file(curpath, &ctx))
+      {
+        warning(UNKNOWN_LOCATION, "CLIPS-GCC: cannot read CLIPS file %s (%m)",
+                curpath.c_str());
+        return std::string();
+      }
+  return clgcc_md5_hex(&ctx);
+} // end CLGCC_rules_key
+
+
+/// called by CL_GenOpen while batching our rule files, remembers the
+/// other files read, once each
+static void
+clgcc_record_opened_file(Environment*, const char*path, const char*access, void*)
+{
+  if (access[0] != 'r')
+    return;
+  std::string curpath(path);
+  if (std::find(CLGCC_rulefiles.begin(), CLGCC_rulefiles.end(), curpath)
+      != CLGCC_rulefiles.end()
+      || std::find(clgcc_loaded_files.begin(), clgcc_loaded_files.end(), curpath)
+      != clgcc_loaded_files.end())
+    return;
+  clgcc_loaded_files.push_back(curpath);
+} // end clgcc_record_opened_file
+
+
+/// the files loaded when a binary image was saved are listed, with
+/// their MD5, in a text file next to it
+static std::string
+clgcc_cached_files_path(const std::string& cachepath)
+{
+  return cachepath + ".files";
+} // end clgcc_cached_files_path
+
+
+/// check that the files loaded when a binary image was saved are
+/// unchanged, so that batching our rule files again would read the
+/// same files. An image without its list of files is not trusted.
+static bool
+clgcc_cached_files_unchanged(const std::string& cachepath)
+{
+  std::string listpath = clgcc_cached_files_path(cachepath);
+  FILE*fil = fopen(listpath.c_str(), "r");
+  if (!fil)
+    return false;
+  bool unchanged = true;
+  char*line = nullptr;
+  size_t linesize = 0;
+  ssize_t linelen = 0;
+  while (unchanged && (linelen = getline(&line, &linesize, fil)) > 0)
+    {
+      if (line[linelen-1] == '\n')
+        line[--linelen] = '\0';
+      char*space = strchr(line, ' ');
+      if (!space)
+        {
+          unchanged = false;
+          break;
+        }
+      *space = '\0';
+      if (clgcc_file_md5(space+1) != line)
+        {
+          CLGCC_DBGPRINTF("clgcc_cached_files_unchanged %s changed", space+1);
+          unchanged = false;
+        }
+    }
+  free(line);
+  fclose(fil);
+  return unchanged;
+} // end clgcc_cached_files_unchanged
+
+
+static std::string
+clgcc_rules_cache_path(void)
+{
+  std::string key = CLGCC_rules_key();
+  if (key.empty())
+    return key;
+  return CLGCC_cachedir + "/clipsgcc-" + key + ".bin";
+} // end clgcc_rules_cache_path
+
+
+/// try to load a previously saved binary image
+static bool
+clgcc_bload_cached_rules(const std::string& cachepath)
+{
+  if (access(cachepath.c_str(), R_OK))
+    return false;
+  if (!clgcc_cached_files_unchanged(cachepath))
+    {
+      inform(UNKNOWN_LOCATION, "CLIPS-GCC: a file loaded by the CLIPS files"
+             " cached in %s changed", cachepath.c_str());
+      return false;
+    }
+  double startim = CLGCC_cputime();
+  /// the binary image replaces every construct, including our deftemplates
+  CLGCC_dispose_gimple_templates();
+  if (!CL_Bload(CLGCC_env, cachepath.c_str()))
+    {
+      warning(UNKNOWN_LOCATION, "CLIPS-GCC: failed to bload cached CLIPS image %s",
+              cachepath.c_str());
+      /// a bad image is often rejected before anything got cleared
+      if (CL_FindDeftemplate(CLGCC_env, CLGCC_function_exporter.name()))
+        CLGCC_resolve_gimple_templates();
+      else
+        CLGCC_define_gimple_templates();
+      return false;
+    }
+  CLGCC_resolve_gimple_templates();
+  CLGCC_DBGPRINTF("clgcc_bload_cached_rules %s in %.3f s",
+                  cachepath.c_str(), CLGCC_cputime() - startim);
+  return true;
+} // end clgcc_bload_cached_rules
+
+
+/// save the constructs of CLGCC_env, with the list of the files
+/// loaded meanwhile; both are written to temporary files which are
+/// then renamed, so concurrent compilations (e.g. with make -j) never
+/// see a partial image.
+static void
+clgcc_bsave_cached_rules(const std::string& cachepath)
+{
+  if (mkdir(CLGCC_cachedir.c_str(), 0750) && errno != EEXIST)
+    {
+      warning(UNKNOWN_LOCATION, "CLIPS-GCC: cannot make cache directory %s (%m)",
+              CLGCC_cachedir.c_str());
+      return;
+    }
+  char pidbuf[32];
+  snprintf(pidbuf, sizeof(pidbuf), ".%d-tmp", (int)getpid());
+  std::string listpath = clgcc_cached_files_path(cachepath);
+  std::string tmplistpath = listpath + pidbuf;
+  FILE*listfil = fopen(tmplistpath.c_str(), "w");
+  if (!listfil)
+    {
+      warning(UNKNOWN_LOCATION, "CLIPS-GCC: cannot write %s (%m)",
+              tmplistpath.c_str());
+      return;
+    }
+  for (const std::string& curpath: clgcc_loaded_files)
+    {
+      std::string md5 = clgcc_file_md5(curpath);
+      if (md5.empty() || strchr(curpath.c_str(), '\n'))
+        {
+          /// an image depending on such a file is never saved
+          fclose(listfil);
+          unlink(tmplistpath.c_str());
+          return;
+        }
+      fprintf(listfil, "%s %s\n", md5.c_str(), curpath.c_str());
+    }
+  if (fclose(listfil) || rename(tmplistpath.c_str(), listpath.c_str()))
+    {
+      warning(UNKNOWN_LOCATION, "CLIPS-GCC: failed to write %s (%m)",
+              listpath.c_str());
+      unlink(tmplistpath.c_str());
+      return;
+    }
+  std::string tmpath = cachepath + pidbuf;
+  if (!CL_Bsave(CLGCC_env, tmpath.c_str()))
+    {
+      warning(UNKNOWN_LOCATION, "CLIPS-GCC: failed to bsave CLIPS image %s",
+              tmpath.c_str());
+      unlink(tmpath.c_str());
+      return;
+    }
+  if (rename(tmpath.c_str(), cachepath.c_str()))
+    {
+      warning(UNKNOWN_LOCATION, "CLIPS-GCC: failed to rename %s to %s (%m)",
+              tmpath.c_str(), cachepath.c_str());
+      unlink(tmpath.c_str());
+      return;
+    }
+  CLGCC_DBGPRINTF("clgcc_bsave_cached_rules saved %s", cachepath.c_str());
+} // end clgcc_bsave_cached_rules
+
+
+/// load every CLIPS file given with -fplugin-arg-clipsgccplug-load=,
+/// called from CLGCC_starting. With a cache directory, the resulting
+/// constructs are taken from, or saved into, a binary image, which is
+/// not used once some file that our files loaded has changed. Notice
+/// that only constructs are kept in such images, not the side effects
+/// of other top-level commands in the loaded files.
+void
+CLGCC_load_rule_files(void)
+{
+  std::string cachepath;
+  if (CLGCC_rulefiles.empty())
+    return;
+  if (!CLGCC_cachedir.empty())
+    {
+      cachepath = clgcc_rules_cache_path();
+      if (!cachepath.empty() && clgcc_bload_cached_rules(cachepath))
+        {
+          inform(UNKNOWN_LOCATION, "CLIPS-GCC: loaded %d CLIPS files from cached image %s",
+                 (int) CLGCC_rulefiles.size(), cachepath.c_str());
+          return;
+        }
+    }
+  for (const std::string& curpath: CLGCC_rulefiles)
+    {
+      CLGCC_DBGPRINTF("CLGCC_load_rule_files batch %s", curpath.c_str());
+      if (!CL_Batch(CLGCC_env, curpath.c_str()))
+        {
+          warning(UNKNOWN_LOCATION,"CLIPS-GCC: failed to batch CLIPS file %s",
+                  curpath.c_str());
+          cachepath.clear();
+        }
+    }
+  CLGCC_DBGPRINTF("CLGCC_load_rule_files before CL_CommandLoop_Batch");
+  clgcc_loaded_files.clear();
+  CL_SetFileOpenFunction(CLGCC_env, clgcc_record_opened_file, nullptr);
+  CL_CommandLoop_Batch(CLGCC_env);
+  CL_SetFileOpenFunction(CLGCC_env, nullptr, nullptr);
+  CLGCC_DBGPRINTF("CLGCC_load_rule_files after CL_CommandLoop_Batch, %d other files loaded",
+                  (int) clgcc_loaded_files.size());
+  if (!cachepath.empty())
+    clgcc_bsave_cached_rules(cachepath);
+} // end CLGCC_load_rule_files
+
+// end of file clips-gcc-cache.cc
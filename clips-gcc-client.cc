@@ -0,0 +1,251 @@
+/**
+   https://github.com/bstarynk/clips-rules-gcc
+
+   file clips-gcc-client.cc talking to a clgcc-server compile server.
+   To be indented with astyle --style=gnu -s2 clips-gcc-client.cc
+
+   Copyright © 2020 CEA (Commissariat à l'énergie atomique et aux énergies alternatives)
+   contributed by Basile Starynkevitch.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+**/
+#include "clips-gcc.hh"
+
+/// With -fplugin-arg-clipsgccplug-server=<socket>, no CLIPS
+/// environment is created inside cc1. The exported facts are streamed
+/// to the clgcc-server daemon (see clgcc-server.cc for the protocol),
+/// which keeps warm environments with the rules already loaded, and
+/// sends back the output of the rules.
+
+int CLGCC_serverfd = -1;
+std::string CLGCC_serverpath;
+
+/// buffered output to the server
+static std::string clgcc_serverbuf;
+/// buffered input from the server
+static std::string clgcc_serverinput;
+
+#define CLGCC_SERVER_BUFSIZE 65536
+
+
+/// encode a symbol (kind y) or a string (kind s) as its kind, its byte
+/// length, a colon, then its bytes
+void
+CLGCC_encode_lexeme(std::string&out, char kind, const char*str)
+{
+  size_t len = str?strlen(str):0;
+  out.push_back(kind);
+  out.append(std::to_string(len));
+  out.push_back(':');
+  if (len > 0)
+    out.append(str, len);
+} // end CLGCC_encode_lexeme
+
+
+static void
+clgcc_server_flush(void)
+{
+  size_t off = 0;
+  while (off < clgcc_serverbuf.size())
+    {
+      ssize_t nbw = write(CLGCC_serverfd, clgcc_serverbuf.data()+off,
+                          clgcc_serverbuf.size()-off);
+      if (nbw < 0 && errno == EINTR)
+        continue;
+      if (nbw <= 0)
+        fatal_error(UNKNOWN_LOCATION, "CLIPS-GCC: failed to write to server %s (%m)",
+                    CLGCC_serverpath.c_str());
+      off += nbw;
+    }
+  clgcc_serverbuf.clear();
+} // end clgcc_server_flush
+
+
+void
+CLGCC_server_send(const std::string&msg)
+{
+  clgcc_serverbuf.append(msg);
+  if (clgcc_serverbuf.size() >= CLGCC_SERVER_BUFSIZE)
+    clgcc_server_flush();
+} // end CLGCC_server_send
+
+
+/// read from the server until at least nbytes are buffered; false on EOF
+static bool
+clgcc_server_fill(size_t nbytes)
+{
+  while (clgcc_serverinput.size() < nbytes)
+    {
+      char buf[4096];
+      ssize_t nbr = read(CLGCC_serverfd, buf, sizeof(buf));
+      if (nbr < 0 && errno == EINTR)
+        continue;
+      if (nbr <= 0)
+        return false;
+      clgcc_serverinput.append(buf, nbr);
+    }
+  return true;
+} // end clgcc_server_fill
+
+
+/// read a reply line from the server, without its newline
+static bool
+clgcc_server_read_line(std::string&line)
+{
+  size_t eol = std::string::npos;
+  while ((eol = clgcc_serverinput.find('\n')) == std::string::npos)
+    if (!clgcc_server_fill(clgcc_serverinput.size()+1))
+      return false;
+  line = clgcc_serverinput.substr(0, eol);
+  clgcc_serverinput.erase(0, eol+1);
+  return true;
+} // end clgcc_server_read_line
+
+
+/// connect to the server, and describe our deftemplates and the rule
+/// files to it; the server answers once it has a ready environment.
+bool
+CLGCC_connect_server(void)
+{
+  std::string key = CLGCC_rules_key();
+  if (key.empty())
+    return false;
+  struct sockaddr_un sa;
+  memset (&sa, 0, sizeof(sa));
+  if (CLGCC_serverpath.size() >= sizeof(sa.sun_path))
+    {
+      warning(UNKNOWN_LOCATION, "CLIPS-GCC: too long server socket path %s",
+              CLGCC_serverpath.c_str());
+      return false;
+    }
+  sa.sun_family = AF_UNIX;
+  strcpy(sa.sun_path, CLGCC_serverpath.c_str());
+  int fd = socket(AF_UNIX, SOCK_STREAM|SOCK_CLOEXEC, 0);
+  if (fd < 0)
+    return false;
+  if (connect(fd, (struct sockaddr*)&sa, sizeof(sa)))
+    {
+      warning(UNKNOWN_LOCATION, "CLIPS-GCC: cannot connect to server %s (%m)",
+              CLGCC_serverpath.c_str());
+      close(fd);
+      return false;
+    }
+  CLGCC_serverfd = fd;
+  CLGCC_server_send("HELLO " + key + "\n");
+  for (CLGCC_Fact_Exporter*const*pexp = CLGCC_all_exporters; *pexp; pexp++)
+    {
+      CLGCC_Fact_Exporter*exp = *pexp;
+      std::string msg("TEMPLATE ");
+      msg.append(exp->name());
+      msg.push_back(' ');
+      msg.append(std::to_string(exp->nb_slots()));
+      for (unsigned rk=0; rk<exp->nb_slots(); rk++)
+        {
+          msg.push_back(' ');
+          msg.append(exp->slot_name(rk));
+        }
+      msg.push_back(' ');
+      CLGCC_encode_lexeme(msg, 's', exp->source());
+      msg.push_back('\n');
+      CLGCC_server_send(msg);
+    }
+  for (const std::string& curpath: CLGCC_rulefiles)
+    {
+      /// the server has another working directory
+      char*rpath = realpath(curpath.c_str(), nullptr);
+      std::string msg("LOAD ");
+      CLGCC_encode_lexeme(msg, 's', rpath?rpath:curpath.c_str());
+      msg.push_back('\n');
+      CLGCC_server_send(msg);
+      free(rpath);
+    }
+  CLGCC_server_send("READY\n");
+  clgcc_server_flush();
+  std::string reply;
+  if (!clgcc_server_read_line(reply) || reply.compare(0, 3, "OK ") != 0)
+    {
+      warning(UNKNOWN_LOCATION, "CLIPS-GCC: server %s refused us: %s",
+              CLGCC_serverpath.c_str(), reply.c_str());
+      close(fd);
+      CLGCC_serverfd = -1;
+      clgcc_serverbuf.clear();
+      clgcc_serverinput.clear();
+      return false;
+    }
+  CLGCC_DBGPRINTF("CLGCC_connect_server %s fd#%d: %s",
+                  CLGCC_serverpath.c_str(), fd, reply.c_str());
+  return true;
+} // end CLGCC_connect_server
+
+
+/// ask the server to run the rules on the facts sent so far; the output
+/// of the rules is copied to our stdout, and their gcc-diagnostic facts
+/// are kept for CLGCC_emit_diagnostics. Gives the number of fired
+/// rules.
+long long
+CLGCC_server_run(void)
+{
+  assert (CLGCC_serverfd >= 0);
+  CLGCC_server_send("RUN\n");
+  clgcc_server_flush();
+  std::string reply;
+  while (clgcc_server_read_line(reply))
+    {
+      if (reply.compare(0, 4, "OUT ") == 0)
+        {
+          size_t len = strtoul(reply.c_str()+4, nullptr, 10);
+          if (!clgcc_server_fill(len))
+            break;
+          fwrite(clgcc_serverinput.data(), 1, len, stdout);
+          clgcc_serverinput.erase(0, len);
+        }
+      else if (reply.compare(0, 5, "DIAG ") == 0)
+        {
+          size_t len = strtoul(reply.c_str()+5, nullptr, 10);
+          if (!clgcc_server_fill(len))
+            break;
+          if (!CLGCC_decode_diagnostic(clgcc_serverinput.substr(0, len)))
+            warning(UNKNOWN_LOCATION, "CLIPS-GCC: bad diagnostic from server %s",
+                    CLGCC_serverpath.c_str());
+          clgcc_serverinput.erase(0, len);
+        }
+      else if (reply.compare(0, 5, "DONE ") == 0)
+        {
+          fflush(stdout);
+          return atoll(reply.c_str()+5);
+        }
+      else
+        break;
+    }
+  fatal_error(UNKNOWN_LOCATION, "CLIPS-GCC: bad reply from server %s: %s",
+              CLGCC_serverpath.c_str(), reply.c_str());
+  return -1;
+} // end CLGCC_server_run
+
+
+/// tell the server that our translation unit is done, so it can reset
+/// and reuse its environment
+void
+CLGCC_server_bye(void)
+{
+  if (CLGCC_serverfd < 0)
+    return;
+  CLGCC_server_send("BYE\n");
+  clgcc_server_flush();
+  close(CLGCC_serverfd);
+  CLGCC_serverfd = -1;
+} // end CLGCC_server_bye
+
+// end of file clips-gcc-client.cc
@@ -0,0 +1,215 @@
+/**
+   https://github.com/bstarynk/clips-rules-gcc
+
+   file clips-gcc-diagnostic.cc emitting as GCC diagnostics the
+   gcc-diagnostic facts asserted by rules. To be indented with
+   astyle --style=gnu -s2 clips-gcc-diagnostic.cc
+
+   Copyright © 2020 CEA (Commissariat à l'énergie atomique et aux énergies alternatives)
+   contributed by Basile Starynkevitch.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+**/
+#include "clips-gcc.hh"
+
+/// Rules report problems by asserting gcc-diagnostic facts, instead of
+/// printing them from their right hand side. These facts are
+/// collected by CLGCC_harvest_diagnostics after every run of the
+/// rules (before the facts of a function are retracted), then
+/// CLGCC_emit_diagnostics turns them, sorted by location and without
+/// duplicates, into warning_at or inform calls when the translation
+/// unit is finished.
+
+struct clgcc_diagnostic_st
+{
+  std::string diag_file;
+  long long diag_line;
+  long long diag_column;
+  /// false for a warning, true for a note, so a note follows the
+  /// warning at the same place
+  bool diag_note;
+  std::string diag_message;
+  bool operator < (const clgcc_diagnostic_st&other) const
+  {
+    return std::tie(diag_file, diag_line, diag_column, diag_note, diag_message)
+           < std::tie(other.diag_file, other.diag_line, other.diag_column,
+                      other.diag_note, other.diag_message);
+  };
+  bool operator == (const clgcc_diagnostic_st&other) const
+  {
+    return std::tie(diag_file, diag_line, diag_column, diag_note, diag_message)
+           == std::tie(other.diag_file, other.diag_line, other.diag_column,
+                       other.diag_note, other.diag_message);
+  };
+};				// end clgcc_diagnostic_st
+
+static std::vector<clgcc_diagnostic_st> clgcc_diagnostics;
+
+/// a GCC location for each line of the exported statements and
+/// functions, since a rule only knows the file and line of what it
+/// matched. The file names of expanded locations are shared by the
+/// line map, so they are compared as pointers.
+static std::unordered_map<const char*,std::unordered_map<long long,location_t>> clgcc_line_locations;
+
+
+/// called by clgcc_put_location for each exported location
+void
+CLGCC_record_location(const expanded_location&xloc, location_t loc)
+{
+  if (!xloc.file || loc == UNKNOWN_LOCATION)
+    return;
+  clgcc_line_locations[xloc.file].emplace(xloc.line, loc);
+} // end CLGCC_record_location
+
+
+static location_t
+clgcc_find_location(const clgcc_diagnostic_st&diag)
+{
+  for (auto& it: clgcc_line_locations)
+    {
+      if (diag.diag_file != it.first)
+        continue;
+      auto lit = it.second.find(diag.diag_line);
+      if (lit == it.second.end())
+        continue;
+      location_t loc = lit->second;
+      expanded_location xloc = expand_location(loc);
+      if (diag.diag_column > xloc.column)
+        loc = linemap_position_for_loc_and_offset(line_table, loc,
+              diag.diag_column - xloc.column);
+      return loc;
+    }
+  return UNKNOWN_LOCATION;
+} // end clgcc_find_location
+
+
+static void
+clgcc_add_diagnostic(const char*file, long long line, long long column,
+                     const char*severity, const char*message)
+{
+  clgcc_diagnostic_st diag;
+  diag.diag_file = file?file:"";
+  diag.diag_line = line;
+  diag.diag_column = column;
+  diag.diag_note = severity && !strcmp(severity, "note");
+  diag.diag_message = message?message:"";
+  clgcc_diagnostics.push_back(diag);
+} // end clgcc_add_diagnostic
+
+
+/// called after the rules ran, and before their facts are retracted
+void
+CLGCC_harvest_diagnostics(void)
+{
+  auto& diagexp = CLGCC_diagnostic_exporter;
+  Deftemplate*dt = diagexp.deftemplate();
+  if (!CLGCC_env || !dt)
+    return;
+  for (Fact*fact = CL_GetNextFactInTemplate(dt, nullptr); fact;
+       fact = CL_GetNextFactInTemplate(dt, fact))
+    {
+      CLIPSValue vals[CLGCC_DIAGNOSTIC__LAST];
+      bool good = true;
+      for (unsigned rk = 0; good && rk < CLGCC_DIAGNOSTIC__LAST; rk++)
+        good = (CL_GetFactSlot(fact, diagexp.slot_name(rk), vals+rk) == GSE_NO_ERROR);
+      if (!good)
+        {
+          warning(UNKNOWN_LOCATION, "CLIPS-GCC: bad gcc-diagnostic fact f-%lld",
+                  CL_FactIndex(fact));
+          continue;
+        }
+      clgcc_add_diagnostic(vals[CLGCC_DIAGNOSTIC_FILE].lexemeValue->contents,
+                           vals[CLGCC_DIAGNOSTIC_LINE].integerValue->contents,
+                           vals[CLGCC_DIAGNOSTIC_COLUMN].integerValue->contents,
+                           vals[CLGCC_DIAGNOSTIC_SEVERITY].lexemeValue->contents,
+                           vals[CLGCC_DIAGNOSTIC_MESSAGE].lexemeValue->contents);
+    }
+} // end CLGCC_harvest_diagnostics
+
+
+/// decode the slot values of a gcc-diagnostic fact sent by the compile
+/// server in a DIAG message, encoded as in F messages
+bool
+CLGCC_decode_diagnostic(const std::string&msg)
+{
+  std::string strs[CLGCC_DIAGNOSTIC__LAST];
+  long long nums[CLGCC_DIAGNOSTIC__LAST] = {0};
+  size_t pos = 0;
+  for (unsigned rk = 0; rk < CLGCC_DIAGNOSTIC__LAST; rk++)
+    {
+      if (pos+1 >= msg.size() || msg[pos] != ' ')
+        return false;
+      char kind = msg[pos+1];
+      pos += 2;
+      if (kind == 'i')
+        {
+          char*end = nullptr;
+          nums[rk] = strtoll(msg.c_str()+pos, &end, 10);
+          pos = end - msg.c_str();
+        }
+      else if (kind == 'y' || kind == 's')
+        {
+          size_t colon = msg.find(':', pos);
+          if (colon == std::string::npos)
+            return false;
+          size_t len = strtoul(msg.c_str()+pos, nullptr, 10);
+          if (colon+1+len > msg.size())
+            return false;
+          strs[rk] = msg.substr(colon+1, len);
+          pos = colon+1+len;
+        }
+      else if (kind != '-')
+        return false;
+    }
+  clgcc_add_diagnostic(strs[CLGCC_DIAGNOSTIC_FILE].c_str(),
+                       nums[CLGCC_DIAGNOSTIC_LINE],
+                       nums[CLGCC_DIAGNOSTIC_COLUMN],
+                       strs[CLGCC_DIAGNOSTIC_SEVERITY].c_str(),
+                       strs[CLGCC_DIAGNOSTIC_MESSAGE].c_str());
+  return true;
+} // end CLGCC_decode_diagnostic
+
+
+/// called when the translation unit is finished, or at the end of WPA
+void
+CLGCC_emit_diagnostics(void)
+{
+  std::sort(clgcc_diagnostics.begin(), clgcc_diagnostics.end());
+  auto last = std::unique(clgcc_diagnostics.begin(), clgcc_diagnostics.end());
+  CLGCC_DBGPRINTF("CLGCC_emit_diagnostics %ld distinct among %ld",
+                  (long) (last - clgcc_diagnostics.begin()),
+                  (long) clgcc_diagnostics.size());
+  for (auto it = clgcc_diagnostics.begin(); it != last; ++it)
+    {
+      location_t loc = clgcc_find_location(*it);
+      if (loc != UNKNOWN_LOCATION)
+        {
+          if (it->diag_note)
+            inform(loc, "%s", it->diag_message.c_str());
+          else
+            warning_at(loc, 0, "%s", it->diag_message.c_str());
+        }
+      else if (it->diag_note)
+        inform(UNKNOWN_LOCATION, "%s:%lld: %s", it->diag_file.c_str(),
+               it->diag_line, it->diag_message.c_str());
+      else
+        warning_at(UNKNOWN_LOCATION, 0, "%s:%lld: %s", it->diag_file.c_str(),
+                   it->diag_line, it->diag_message.c_str());
+    }
+  clgcc_diagnostics.clear();
+  clgcc_line_locations.clear();
+} // end CLGCC_emit_diagnostics
+
+// end of file clips-gcc-diagnostic.cc
@@ -0,0 +1,998 @@
+/**
+   https://github.com/bstarynk/clips-rules-gcc
+
+   file clips-gcc-gimple.cc exporting GIMPLE as CLIPS facts. To be
+   indented with astyle --style=gnu -s2 clips-gcc-gimple.cc
+
+   Copyright © 2020 CEA (Commissariat à l'énergie atomique et aux énergies alternatives)
+   contributed by Basile Starynkevitch.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+**/
+#include "clips-gcc.hh"
+
+/// Facts are never built by parsing strings (CL_AssertString or
+/// CL_Eval are much too slow for big translation units). Each
+/// exported deftemplate gets one reusable Fact_Builder, and its slots
+/// are filled by position thru CL_FBPutSlotByIndex; these positions
+/// are resolved once, after the deftemplates have been built.
+///
+/// With -fplugin-arg-clipsgccplug-lazy, the costly slots of the
+/// gcc-statement and gcc-ssa-name facts (e.g. their operands) are not
+/// filled when asserting: the fact only keeps its gimple or tree, and
+/// CLIPS calls back the lazy filler of the exporter the first time
+/// some pattern or command reads such a slot.
+
+static CLGCC_lazy_filler_t clgcc_statement_lazy_filler;
+static CLGCC_lazy_filler_t clgcc_ssa_name_lazy_filler;
+
+static const char*const clgcc_translation_unit_slots[CLGCC_TRANSLATION_UNIT__LAST] =
+{
+  "file-path"
+};
+
+static const char*const clgcc_function_slots[CLGCC_FUNCTION__LAST] =
+{
+  "id", "name", "file", "line"
+};
+
+static const char*const clgcc_basic_block_slots[CLGCC_BASIC_BLOCK__LAST] =
+{
+  "function", "index", "predecessors", "successors"
+};
+
+static const char*const clgcc_statement_slots[CLGCC_STATEMENT__LAST] =
+{
+  "function", "basic-block", "rank", "code", "operation",
+  "lhs", "uses", "operands", "callee", "file", "line"
+};
+
+static const char*const clgcc_ssa_name_slots[CLGCC_SSA_NAME__LAST] =
+{
+  "function", "version", "variable", "type", "definition", "default-def"
+};
+
+static const char*const clgcc_lto_slots[CLGCC_LTO__LAST] =
+{
+  "phase", "partition"
+};
+
+static const char*const clgcc_diagnostic_slots[CLGCC_DIAGNOSTIC__LAST] =
+{
+  "file", "line", "column", "severity", "message"
+};
+
+CLGCC_Fact_Exporter CLGCC_translation_unit_exporter
+{
+  "gcc-translation-unit", clgcc_translation_unit_slots, CLGCC_TRANSLATION_UNIT__LAST,
+  R"clipsstr(
+(deftemplate gcc-translation-unit
+  "the source file compiled by GCC"
+  (slot file-path (type STRING)))
+)clipsstr"
+};
+
+CLGCC_Fact_Exporter CLGCC_function_exporter
+{
+  "gcc-function", clgcc_function_slots, CLGCC_FUNCTION__LAST,
+  R"clipsstr(
+(deftemplate gcc-function
+  "a function whose GIMPLE is exported by CLIPS-GCC"
+  (slot id (type INTEGER))
+  (slot name (type STRING))
+  (slot file (type STRING))
+  (slot line (type INTEGER)))
+)clipsstr"
+};
+
+CLGCC_Fact_Exporter CLGCC_basic_block_exporter
+{
+  "gcc-basic-block", clgcc_basic_block_slots, CLGCC_BASIC_BLOCK__LAST,
+  R"clipsstr(
+(deftemplate gcc-basic-block
+  "a basic block of some exported gcc-function"
+  (slot function (type INTEGER))
+  (slot index (type INTEGER))
+  (multislot predecessors (type INTEGER))
+  (multislot successors (type INTEGER)))
+)clipsstr"
+};
+
+CLGCC_Fact_Exporter CLGCC_statement_exporter
+{
+  "gcc-statement", clgcc_statement_slots, CLGCC_STATEMENT__LAST,
+  R"clipsstr(
+(deftemplate gcc-statement
+  "a GIMPLE statement, or PHI node, inside some gcc-basic-block"
+  (slot function (type INTEGER))
+  (slot basic-block (type INTEGER))
+  (slot rank (type INTEGER))
+  (slot code (type SYMBOL))
+  (slot operation (type SYMBOL))
+  (slot lhs (type INTEGER) (default 0))
+  (multislot uses (type INTEGER))
+  (multislot operands)
+  (slot callee (type STRING) (default ""))
+  (slot file (type STRING) (default ""))
+  (slot line (type INTEGER) (default 0)))
+)clipsstr",
+  clgcc_statement_lazy_filler,
+  {
+    CLGCC_STATEMENT_OPERATION, CLGCC_STATEMENT_USES, CLGCC_STATEMENT_OPERANDS,
+    CLGCC_STATEMENT_CALLEE, CLGCC_STATEMENT_FILE, CLGCC_STATEMENT_LINE
+  }
+};
+
+CLGCC_Fact_Exporter CLGCC_ssa_name_exporter
+{
+  "gcc-ssa-name", clgcc_ssa_name_slots, CLGCC_SSA_NAME__LAST,
+  R"clipsstr(
+(deftemplate gcc-ssa-name
+  "an SSA name of some gcc-function"
+  (slot function (type INTEGER))
+  (slot version (type INTEGER))
+  (slot variable (type SYMBOL))
+  (slot type (type SYMBOL))
+  (slot definition (type INTEGER) (default 0))
+  (slot default-def (type SYMBOL) (allowed-symbols FALSE TRUE)))
+)clipsstr",
+  clgcc_ssa_name_lazy_filler,
+  {
+    CLGCC_SSA_NAME_VARIABLE, CLGCC_SSA_NAME_TYPE, CLGCC_SSA_NAME_DEFAULT_DEF
+  }
+};
+
+CLGCC_Fact_Exporter CLGCC_lto_exporter
+{
+  "gcc-lto", clgcc_lto_slots, CLGCC_LTO__LAST,
+  R"clipsstr(
+(deftemplate gcc-lto
+  "the link-time optimization phase running the rules"
+  (slot phase (type SYMBOL) (allowed-symbols compile wpa ltrans))
+  (slot partition (type INTEGER) (default -1)))
+)clipsstr"
+};
+
+CLGCC_Fact_Exporter CLGCC_diagnostic_exporter
+{
+  "gcc-diagnostic", clgcc_diagnostic_slots, CLGCC_DIAGNOSTIC__LAST,
+  R"clipsstr(
+(deftemplate gcc-diagnostic
+  "asserted by rules, emitted as a GCC warning or note when finishing"
+  (slot file (type STRING))
+  (slot line (type INTEGER))
+  (slot column (type INTEGER) (default 0))
+  (slot severity (type SYMBOL) (allowed-symbols warning note))
+  (slot message (type STRING)))
+)clipsstr"
+};
+
+CLGCC_Fact_Exporter*const CLGCC_all_exporters[] =
+{
+  &CLGCC_translation_unit_exporter,
+  &CLGCC_function_exporter,
+  &CLGCC_basic_block_exporter,
+  &CLGCC_statement_exporter,
+  &CLGCC_ssa_name_exporter,
+  &CLGCC_lto_exporter,
+  &CLGCC_diagnostic_exporter,
+  nullptr
+};
+
+/// the multifield builder shared by all exporters; when facts are
+/// sent to a compile server, multifields are encoded in clgcc_mfremote
+static Multifield_Builder* clgcc_mfbuilder;
+static std::string clgcc_mfremote;
+static unsigned clgcc_mfcount;
+
+/// set by -fplugin-arg-clipsgccplug-lazy
+bool CLGCC_lazy;
+
+/// GCC identifiers are unique, so their CLIPS lexemes are interned
+/// here by identifier node, instead of rehashing the same names with
+/// CL_CreateSymbol for every statement. Each cached lexeme is retained
+/// until CLGCC_dispose_gimple_templates, so lives for the whole
+/// translation unit.
+static std::unordered_map<tree,CLIPSLexeme*> clgcc_identifier_symbols;
+static std::unordered_map<tree,CLIPSLexeme*> clgcc_identifier_strings;
+
+CLIPSLexeme*
+CLGCC_identifier_lexeme(tree id, bool isstring)
+{
+  assert (id != NULL_TREE && TREE_CODE(id) == IDENTIFIER_NODE);
+  assert (CLGCC_env != nullptr);
+  auto& cache = isstring?clgcc_identifier_strings:clgcc_identifier_symbols;
+  auto it = cache.find(id);
+  if (it != cache.end())
+    return it->second;
+  CLIPSLexeme* lex = isstring
+                     ? CL_CreateString(CLGCC_env, IDENTIFIER_POINTER(id))
+                     : CL_CreateSymbol(CLGCC_env, IDENTIFIER_POINTER(id));
+  CL_RetainLexeme(CLGCC_env, lex);
+  cache.emplace(id, lex);
+  return lex;
+} // end CLGCC_identifier_lexeme
+
+
+static void
+clgcc_release_identifier_lexemes(void)
+{
+  for (auto& it: clgcc_identifier_symbols)
+    CL_ReleaseLexeme(CLGCC_env, it.second);
+  clgcc_identifier_symbols.clear();
+  for (auto& it: clgcc_identifier_strings)
+    CL_ReleaseLexeme(CLGCC_env, it.second);
+  clgcc_identifier_strings.clear();
+} // end clgcc_release_identifier_lexemes
+
+bool
+CLGCC_Fact_Exporter::is_lazy(void) const
+{
+  return exp_lazyfiller != nullptr && CLGCC_lazy && CLGCC_serverfd < 0;
+} // end CLGCC_Fact_Exporter::is_lazy
+
+void
+CLGCC_Fact_Exporter::build_template(Environment*env)
+{
+  assert (env != nullptr);
+  if (CL_Build(env, exp_source) != BE_NO_ERROR)
+    fatal_error(UNKNOWN_LOCATION, "CLIPS-GCC: failed to build deftemplate %s",
+                exp_name);
+  resolve_template(env);
+} // end CLGCC_Fact_Exporter::build_template
+
+
+/// find an already defined deftemplate, e.g. after some CL_Bload,
+/// with its slot positions, and make its fact builder
+void
+CLGCC_Fact_Exporter::resolve_template(Environment*env)
+{
+  assert (env != nullptr);
+  exp_deftemplate = CL_FindDeftemplate(env, exp_name);
+  if (!exp_deftemplate)
+    fatal_error(UNKNOWN_LOCATION, "CLIPS-GCC: missing deftemplate %s",
+                exp_name);
+  exp_slotix.resize(exp_nbslots);
+  for (unsigned rk=0; rk<exp_nbslots; rk++)
+    {
+      unsigned short whichslot = 0;
+      if (!CL_FindSlot(exp_deftemplate,
+                       CL_CreateSymbol(env, exp_slotnames[rk]), &whichslot))
+        fatal_error(UNKNOWN_LOCATION, "CLIPS-GCC: deftemplate %s has no slot %s",
+                    exp_name, exp_slotnames[rk]);
+      exp_slotix[rk] = whichslot;
+    }
+  /// a CL_Bload resets the lazy slot function of the deftemplate
+  if (!CL_SetDeftemplateLazy(exp_deftemplate,
+                             is_lazy()?CLGCC_Fact_Exporter::lazy_slot:nullptr,
+                             this))
+    fatal_error(UNKNOWN_LOCATION, "CLIPS-GCC: failed to make deftemplate %s lazy",
+                exp_name);
+  exp_builder = CL_CreateFact_Builder(env, exp_name);
+  if (!exp_builder)
+    fatal_error(UNKNOWN_LOCATION, "CLIPS-GCC: failed to create fact builder for %s (error#%d)",
+                exp_name, (int) CL_FBError(env));
+  CLGCC_DBGPRINTF("resolve_template %s @%p with %u slots",
+                  exp_name, (void*)exp_deftemplate, exp_nbslots);
+} // end CLGCC_Fact_Exporter::resolve_template
+
+
+void
+CLGCC_Fact_Exporter::dispose(void)
+{
+  if (exp_builder)
+    CL_FBDispose(exp_builder);
+  exp_builder = nullptr;
+  exp_deftemplate = nullptr;
+} // end CLGCC_Fact_Exporter::dispose
+
+
+void
+CLGCC_Fact_Exporter::put_value(unsigned rk, CLIPSValue*pval)
+{
+  assert (rk < exp_nbslots);
+  /// inside lazy_slot, only the value of the wanted slot is kept
+  if (exp_lazyval)
+    {
+      if (rk == exp_lazyrank)
+        exp_lazyval->value = pval->value;
+      return;
+    }
+  PutSlotError pse = CL_FBPutSlotByIndex(exp_builder, exp_slotix[rk], pval);
+  if (pse != PSE_NO_ERROR)
+    warning(UNKNOWN_LOCATION, "CLIPS-GCC: failed to put slot %s of %s (error#%d)",
+            exp_slotnames[rk], exp_name, (int)pse);
+} // end CLGCC_Fact_Exporter::put_value
+
+
+void
+CLGCC_Fact_Exporter::put_integer(unsigned rk, long long num)
+{
+  if (CLGCC_serverfd >= 0)
+    {
+      assert (rk < exp_nbslots);
+      exp_remote[rk] = "i" + std::to_string(num);
+      return;
+    }
+  CLIPSValue val;
+  val.integerValue = CL_CreateInteger(CLGCC_env, num);
+  put_value(rk, &val);
+} // end CLGCC_Fact_Exporter::put_integer
+
+
+void
+CLGCC_Fact_Exporter::put_symbol(unsigned rk, const char*str)
+{
+  if (CLGCC_serverfd >= 0)
+    {
+      assert (rk < exp_nbslots);
+      exp_remote[rk].clear();
+      CLGCC_encode_lexeme(exp_remote[rk], 'y', str?str:"nil");
+      return;
+    }
+  CLIPSValue val;
+  val.lexemeValue = CL_CreateSymbol(CLGCC_env, str?str:"nil");
+  put_value(rk, &val);
+} // end CLGCC_Fact_Exporter::put_symbol
+
+
+void
+CLGCC_Fact_Exporter::put_string(unsigned rk, const char*str)
+{
+  if (CLGCC_serverfd >= 0)
+    {
+      assert (rk < exp_nbslots);
+      exp_remote[rk].clear();
+      CLGCC_encode_lexeme(exp_remote[rk], 's', str?str:"");
+      return;
+    }
+  CLIPSValue val;
+  val.lexemeValue = CL_CreateString(CLGCC_env, str?str:"");
+  put_value(rk, &val);
+} // end CLGCC_Fact_Exporter::put_string
+
+
+/// put the SYMBOL, or the STRING, naming a GCC identifier
+void
+CLGCC_Fact_Exporter::put_identifier(unsigned rk, tree id, bool isstring)
+{
+  if (CLGCC_serverfd >= 0)
+    {
+      if (isstring)
+        put_string(rk, IDENTIFIER_POINTER(id));
+      else
+        put_symbol(rk, IDENTIFIER_POINTER(id));
+      return;
+    }
+  CLIPSValue val;
+  val.lexemeValue = CLGCC_identifier_lexeme(id, isstring);
+  put_value(rk, &val);
+} // end CLGCC_Fact_Exporter::put_identifier
+
+
+void
+CLGCC_Fact_Exporter::put_boolean(unsigned rk, bool flag)
+{
+  put_symbol(rk, flag?"TRUE":"FALSE");
+} // end CLGCC_Fact_Exporter::put_boolean
+
+
+/// put into a slot the multifield made by the previous CLGCC_mf_append_*
+/// calls, and start a new one
+void
+CLGCC_Fact_Exporter::put_multifield(unsigned rk)
+{
+  if (CLGCC_serverfd >= 0)
+    {
+      assert (rk < exp_nbslots);
+      exp_remote[rk] = "m" + std::to_string(clgcc_mfcount) + clgcc_mfremote;
+      clgcc_mfremote.clear();
+      clgcc_mfcount = 0;
+      return;
+    }
+  CLIPSValue val;
+  val.multifieldValue = CL_MBCreate(clgcc_mfbuilder);
+  put_value(rk, &val);
+} // end CLGCC_Fact_Exporter::put_multifield
+
+
+/// the CL_LazySlotFunction of lazy deftemplates, whose context is
+/// their exporter
+bool
+CLGCC_Fact_Exporter::lazy_slot(Environment*env, Fact*fact, unsigned short whichslot,
+                               CLIPSValue*pval, void*context)
+{
+  CLGCC_Fact_Exporter*exp = static_cast<CLGCC_Fact_Exporter*>(context);
+  void*source = CL_FactLazySource(fact);
+  assert (exp != nullptr && env == CLGCC_env);
+  if (!source)
+    return false;
+  for (unsigned rk: exp->exp_lazyranks)
+    if (exp->exp_slotix[rk] == whichslot)
+      {
+        exp->exp_lazyrank = rk;
+        exp->exp_lazyval = pval;
+        (*exp->exp_lazyfiller)(rk, source);
+        exp->exp_lazyval = nullptr;
+        return true;
+      }
+  return false;
+} // end CLGCC_Fact_Exporter::lazy_slot
+
+
+/// fill the lazy slots of the next asserted fact, or let CLIPS
+/// compute them from source when they are first needed
+void
+CLGCC_Fact_Exporter::put_lazy_slots(void*source)
+{
+  assert (exp_lazyfiller != nullptr);
+  if (is_lazy())
+    {
+      CL_FBSetLazySource(exp_builder, source);
+      return;
+    }
+  for (unsigned rk: exp_lazyranks)
+    (*exp_lazyfiller)(rk, source);
+} // end CLGCC_Fact_Exporter::put_lazy_slots
+
+
+Fact*
+CLGCC_Fact_Exporter::assert_fact(void)
+{
+  if (CLGCC_serverfd >= 0)
+    {
+      /// one line per fact: F, the deftemplate name, then every slot
+      /// value in rank order, or - for the slot default
+      std::string line("F ");
+      line.append(exp_name);
+      for (std::string& curval: exp_remote)
+        {
+          line.push_back(' ');
+          if (curval.empty())
+            line.push_back('-');
+          else
+            line.append(curval);
+          curval.clear();
+        }
+      line.push_back('\n');
+      CLGCC_server_send(line);
+      return nullptr;
+    }
+  Fact* fact = FB_Assert(exp_builder);
+  if (!fact && CL_FBError(CLGCC_env) != FBE_NO_ERROR)
+    warning(UNKNOWN_LOCATION, "CLIPS-GCC: failed to assert %s fact (error#%d)",
+            exp_name, (int) CL_FBError(CLGCC_env));
+  return fact;
+} // end CLGCC_Fact_Exporter::assert_fact
+
+
+/// the value of a multifield, appended by CLGCC_mf_append_* functions
+void
+CLGCC_mf_append_integer(long long num)
+{
+  if (CLGCC_serverfd >= 0)
+    {
+      clgcc_mfremote += " i" + std::to_string(num);
+      clgcc_mfcount++;
+    }
+  else
+    CL_MBAppendInteger(clgcc_mfbuilder, num);
+} // end CLGCC_mf_append_integer
+
+
+void
+CLGCC_mf_append_float(double x)
+{
+  if (CLGCC_serverfd >= 0)
+    {
+      char buf[48];
+      snprintf(buf, sizeof(buf), " f%.17g", x);
+      clgcc_mfremote += buf;
+      clgcc_mfcount++;
+    }
+  else
+    CL_MBAppendFloat(clgcc_mfbuilder, x);
+} // end CLGCC_mf_append_float
+
+
+void
+CLGCC_mf_append_symbol(const char*str)
+{
+  if (CLGCC_serverfd >= 0)
+    {
+      clgcc_mfremote.push_back(' ');
+      CLGCC_encode_lexeme(clgcc_mfremote, 'y', str);
+      clgcc_mfcount++;
+    }
+  else
+    CL_MBAppendSymbol(clgcc_mfbuilder, str);
+} // end CLGCC_mf_append_symbol
+
+
+void
+CLGCC_mf_append_identifier(tree id)
+{
+  if (CLGCC_serverfd >= 0)
+    CLGCC_mf_append_symbol(IDENTIFIER_POINTER(id));
+  else
+    CL_MBAppendCLIPSLexeme(clgcc_mfbuilder, CLGCC_identifier_lexeme(id, false));
+} // end CLGCC_mf_append_identifier
+
+
+void
+CLGCC_mf_append_string(const char*str)
+{
+  if (CLGCC_serverfd >= 0)
+    {
+      clgcc_mfremote.push_back(' ');
+      CLGCC_encode_lexeme(clgcc_mfremote, 's', str);
+      clgcc_mfcount++;
+    }
+  else
+    CL_MBAppendString(clgcc_mfbuilder, str);
+} // end CLGCC_mf_append_string
+
+
+/// called from plugin_init, after CLGCC_env has been created but
+/// before any CLIPS file has been loaded, since rules refer to our
+/// deftemplates.
+void
+CLGCC_define_gimple_templates(void)
+{
+  for (CLGCC_Fact_Exporter*const*pexp = CLGCC_all_exporters; *pexp; pexp++)
+    (*pexp)->build_template(CLGCC_env);
+  if (!clgcc_mfbuilder)
+    clgcc_mfbuilder = CL_CreateMultifield_Builder(CLGCC_env, 8);
+} // end CLGCC_define_gimple_templates
+
+
+/// called after a CL_Bload of a cached rule image, which replaced
+/// our deftemplates with its own copies of them
+void
+CLGCC_resolve_gimple_templates(void)
+{
+  for (CLGCC_Fact_Exporter*const*pexp = CLGCC_all_exporters; *pexp; pexp++)
+    (*pexp)->resolve_template(CLGCC_env);
+  if (!clgcc_mfbuilder)
+    clgcc_mfbuilder = CL_CreateMultifield_Builder(CLGCC_env, 8);
+} // end CLGCC_resolve_gimple_templates
+
+
+/// called before a CL_Bload, and from CLGCC_finishing before
+/// CLGCC_env is destroyed
+void
+CLGCC_dispose_gimple_templates(void)
+{
+  for (CLGCC_Fact_Exporter*const*pexp = CLGCC_all_exporters; *pexp; pexp++)
+    (*pexp)->dispose();
+  if (clgcc_mfbuilder)
+    CL_MBDispose(clgcc_mfbuilder);
+  clgcc_mfbuilder = nullptr;
+  clgcc_release_identifier_lexemes();
+} // end CLGCC_dispose_gimple_templates
+
+
+/// set by -fplugin-arg-clipsgccplug-export-all, e.g. for rule files
+/// only reading some of our facts thru fact-set queries
+bool CLGCC_export_all;
+
+/// facts which no pattern of a loaded rule refers to are not worth
+/// exporting; and the pattern network of a deftemplate knows that
+void
+CLGCC_Fact_Exporter::filter_template(void)
+{
+  exp_wanted = CLGCC_export_all || CLGCC_serverfd >= 0
+               || CL_DeftemplateHasPatterns(exp_deftemplate);
+  CLGCC_DBGPRINTF("filter_template %s is %s", exp_name,
+                  exp_wanted?"wanted":"unwanted");
+} // end CLGCC_Fact_Exporter::filter_template
+
+
+/// called once the CLIPS files are loaded, so only the deftemplates
+/// matched by some rule get exported
+void
+CLGCC_filter_gimple_templates(void)
+{
+  for (CLGCC_Fact_Exporter*const*pexp = CLGCC_all_exporters; *pexp; pexp++)
+    (*pexp)->filter_template();
+} // end CLGCC_filter_gimple_templates
+
+
+/// append to the current multifield a representation of a
+/// GIMPLE operand: an INTEGER or FLOAT for small constants, a STRING
+/// for string constants, a SYMBOL naming declarations, and otherwise
+/// the SYMBOL of its tree code (e.g. ssa_name or mem_ref).
+static void
+clgcc_append_operand(tree op)
+{
+  switch (TREE_CODE(op))
+    {
+    case INTEGER_CST:
+      if (tree_fits_shwi_p(op))
+        {
+          CLGCC_mf_append_integer(tree_to_shwi(op));
+          return;
+        }
+      break;
+    case REAL_CST:
+      if (!TREE_OVERFLOW(op))
+        {
+          REAL_VALUE_TYPE rv = TREE_REAL_CST(op);
+          CLGCC_mf_append_float(real_to_double(&rv));
+          return;
+        }
+      break;
+    case STRING_CST:
+      CLGCC_mf_append_string(TREE_STRING_POINTER(op));
+      return;
+    case VAR_DECL:
+    case PARM_DECL:
+    case RESULT_DECL:
+    case FUNCTION_DECL:
+    case FIELD_DECL:
+    case LABEL_DECL:
+    case CONST_DECL:
+      if (DECL_NAME(op))
+        {
+          CLGCC_mf_append_identifier(DECL_NAME(op));
+          return;
+        }
+      break;
+    default:
+      break;
+    }
+  CLGCC_mf_append_symbol(get_tree_code_name(TREE_CODE(op)));
+} // end clgcc_append_operand
+
+
+static void
+clgcc_put_location(CLGCC_Fact_Exporter&exp, unsigned filerk, unsigned linerk, location_t loc)
+{
+  if (loc == UNKNOWN_LOCATION)
+    return;
+  expanded_location xloc = expand_location(loc);
+  CLGCC_record_location(xloc, loc);
+  if (xloc.file)
+    exp.put_string(filerk, xloc.file);
+  exp.put_integer(linerk, xloc.line);
+} // end clgcc_put_location
+
+
+static void
+clgcc_export_basic_block(function*fun, long funid, basic_block bb)
+{
+  edge e = nullptr;
+  edge_iterator ei;
+  auto& bbexp = CLGCC_basic_block_exporter;
+  bbexp.put_integer(CLGCC_BASIC_BLOCK_FUNCTION, funid);
+  bbexp.put_integer(CLGCC_BASIC_BLOCK_INDEX, bb->index);
+  FOR_EACH_EDGE(e, ei, bb->preds)
+  CLGCC_mf_append_integer(e->src->index);
+  bbexp.put_multifield(CLGCC_BASIC_BLOCK_PREDECESSORS);
+  FOR_EACH_EDGE(e, ei, bb->succs)
+  CLGCC_mf_append_integer(e->dest->index);
+  bbexp.put_multifield(CLGCC_BASIC_BLOCK_SUCCESSORS);
+  bbexp.assert_fact();
+  CLGCC_NONPRINTF("export_basic_block %s bb#%d", function_name(fun), bb->index);
+} // end clgcc_export_basic_block
+
+
+/// the slot of rank rk of the gcc-statement of stmt, which the
+/// statement exporter may fill lazily
+static void
+clgcc_statement_lazy_filler(unsigned rk, void*source)
+{
+  auto& stexp = CLGCC_statement_exporter;
+  gimple*stmt = static_cast<gimple*>(source);
+  gphi*phi = dyn_cast<gphi*>(stmt);
+  switch (rk)
+    {
+    case CLGCC_STATEMENT_OPERATION:
+      if (is_gimple_assign(stmt))
+        stexp.put_symbol(CLGCC_STATEMENT_OPERATION,
+                         get_tree_code_name(gimple_assign_rhs_code(stmt)));
+      else
+        stexp.put_symbol(CLGCC_STATEMENT_OPERATION, nullptr);
+      break;
+    case CLGCC_STATEMENT_USES:
+      if (phi)
+        {
+          for (unsigned ix=0; ix<gimple_phi_num_args(phi); ix++)
+            {
+              tree arg = gimple_phi_arg_def(phi, ix);
+              if (arg && TREE_CODE(arg) == SSA_NAME)
+                CLGCC_mf_append_integer(SSA_NAME_VERSION(arg));
+            }
+        }
+      else
+        {
+          ssa_op_iter opit;
+          tree use = NULL_TREE;
+          FOR_EACH_SSA_TREE_OPERAND(use, stmt, opit, SSA_OP_USE)
+          CLGCC_mf_append_integer(SSA_NAME_VERSION(use));
+        }
+      stexp.put_multifield(CLGCC_STATEMENT_USES);
+      break;
+    case CLGCC_STATEMENT_OPERANDS:
+      if (phi)
+        {
+          for (unsigned ix=0; ix<gimple_phi_num_args(phi); ix++)
+            {
+              tree arg = gimple_phi_arg_def(phi, ix);
+              if (arg)
+                clgcc_append_operand(arg);
+            }
+        }
+      else
+        {
+          for (unsigned ix=0; ix<gimple_num_ops(stmt); ix++)
+            {
+              tree op = gimple_op(stmt, ix);
+              if (op)
+                clgcc_append_operand(op);
+            }
+        }
+      stexp.put_multifield(CLGCC_STATEMENT_OPERANDS);
+      break;
+    case CLGCC_STATEMENT_CALLEE:
+      if (gcall*call = dyn_cast<gcall*>(stmt))
+        {
+          if (gimple_call_internal_p(call))
+            stexp.put_string(CLGCC_STATEMENT_CALLEE,
+                             internal_fn_name(gimple_call_internal_fn(call)));
+          else if (tree fndecl = gimple_call_fndecl(call))
+            {
+              if (DECL_NAME(fndecl))
+                stexp.put_identifier(CLGCC_STATEMENT_CALLEE,
+                                     DECL_NAME(fndecl), true);
+            }
+        }
+      break;
+    case CLGCC_STATEMENT_FILE:
+    case CLGCC_STATEMENT_LINE:
+      /// when lazy, only the wanted one of both slots is kept
+      if (rk == CLGCC_STATEMENT_FILE || stexp.is_lazy())
+        clgcc_put_location(stexp, CLGCC_STATEMENT_FILE, CLGCC_STATEMENT_LINE,
+                           gimple_location(stmt));
+      break;
+    default:
+      gcc_unreachable();
+    }
+} // end clgcc_statement_lazy_filler
+
+
+/// export one statement or PHI node; its rank is the position of
+/// that statement in the function, and is remembered in ssadefs for
+/// the SSA names it defines.
+static void
+clgcc_export_statement(long funid, basic_block bb, gimple*stmt, long rank,
+                       std::vector<long>&ssadefs)
+{
+  auto& stexp = CLGCC_statement_exporter;
+  tree lhs = (gimple_code(stmt) == GIMPLE_PHI)
+             ? gimple_phi_result(stmt) : gimple_get_lhs(stmt);
+  unsigned lhsver = 0;
+  if (lhs && TREE_CODE(lhs) == SSA_NAME)
+    {
+      lhsver = SSA_NAME_VERSION(lhs);
+      if (lhsver < ssadefs.size())
+        ssadefs[lhsver] = rank;
+    }
+  /// ssadefs is still needed by gcc-ssa-name facts
+  if (!stexp.wanted())
+    return;
+  stexp.put_integer(CLGCC_STATEMENT_FUNCTION, funid);
+  stexp.put_integer(CLGCC_STATEMENT_BASIC_BLOCK, bb->index);
+  stexp.put_integer(CLGCC_STATEMENT_RANK, rank);
+  stexp.put_symbol(CLGCC_STATEMENT_CODE, gimple_code_name[gimple_code(stmt)]);
+  stexp.put_integer(CLGCC_STATEMENT_LHS, lhsver);
+  stexp.put_lazy_slots(stmt);
+  stexp.assert_fact();
+} // end clgcc_export_statement
+
+
+/// the slot of rank rk of the gcc-ssa-name of the SSA name source
+static void
+clgcc_ssa_name_lazy_filler(unsigned rk, void*source)
+{
+  auto& ssaexp = CLGCC_ssa_name_exporter;
+  tree name = static_cast<tree>(source);
+  switch (rk)
+    {
+    case CLGCC_SSA_NAME_VARIABLE:
+    {
+      tree id = SSA_NAME_IDENTIFIER(name);
+      if (id)
+        ssaexp.put_identifier(CLGCC_SSA_NAME_VARIABLE, id, false);
+      else
+        ssaexp.put_symbol(CLGCC_SSA_NAME_VARIABLE, nullptr);
+    }
+    break;
+    case CLGCC_SSA_NAME_TYPE:
+      ssaexp.put_symbol(CLGCC_SSA_NAME_TYPE,
+                        TREE_TYPE(name)?get_tree_code_name(TREE_CODE(TREE_TYPE(name))):nullptr);
+      break;
+    case CLGCC_SSA_NAME_DEFAULT_DEF:
+      ssaexp.put_boolean(CLGCC_SSA_NAME_DEFAULT_DEF, SSA_NAME_IS_DEFAULT_DEF(name));
+      break;
+    default:
+      gcc_unreachable();
+    }
+} // end clgcc_ssa_name_lazy_filler
+
+
+static void
+clgcc_export_ssa_names(function*fun, long funid, const std::vector<long>&ssadefs)
+{
+  auto& ssaexp = CLGCC_ssa_name_exporter;
+  unsigned ix = 0;
+  tree name = NULL_TREE;
+  if (!ssaexp.wanted())
+    return;
+  FOR_EACH_SSA_NAME(ix, name, fun)
+  {
+    ssaexp.put_integer(CLGCC_SSA_NAME_FUNCTION, funid);
+    ssaexp.put_integer(CLGCC_SSA_NAME_VERSION, SSA_NAME_VERSION(name));
+    ssaexp.put_integer(CLGCC_SSA_NAME_DEFINITION,
+                       (ix < ssadefs.size())?ssadefs[ix]:0);
+    ssaexp.put_lazy_slots(name);
+    ssaexp.assert_fact();
+  }
+} // end clgcc_export_ssa_names
+
+
+/// export the whole GIMPLE of a function: one gcc-function fact, then
+/// its basic blocks with their statements and PHI nodes, then its SSA
+/// names.  Statement ranks start at 1, so 0 means "no statement". The
+/// facts of a function are asserted as one batch, so each join of the
+/// rules sees all of them in a row.
+long
+CLGCC_export_function(function*fun)
+{
+  assert (fun != nullptr);
+  long funid = DECL_UID(fun->decl);
+  long rank = 0;
+  basic_block bb = nullptr;
+  std::vector<long> ssadefs(num_ssa_names, 0);
+  if (CLGCC_env)
+    CL_BeginAssertBatch(CLGCC_env);
+  if (CLGCC_function_exporter.wanted())
+    {
+      auto& funexp = CLGCC_function_exporter;
+      funexp.put_integer(CLGCC_FUNCTION_ID, funid);
+      funexp.put_string(CLGCC_FUNCTION_NAME, function_name(fun));
+      clgcc_put_location(funexp, CLGCC_FUNCTION_FILE, CLGCC_FUNCTION_LINE,
+                         DECL_SOURCE_LOCATION(fun->decl));
+      funexp.assert_fact();
+    }
+  FOR_EACH_BB_FN(bb, fun)
+  {
+    if (CLGCC_basic_block_exporter.wanted())
+      clgcc_export_basic_block(fun, funid, bb);
+    for (gphi_iterator gpi = gsi_start_phis(bb); !gsi_end_p(gpi); gsi_next(&gpi))
+      clgcc_export_statement(funid, bb, gpi.phi(), ++rank, ssadefs);
+    for (gimple_stmt_iterator gsi = gsi_start_bb(bb); !gsi_end_p(gsi); gsi_next(&gsi))
+      clgcc_export_statement(funid, bb, gsi_stmt(gsi), ++rank, ssadefs);
+  }
+  clgcc_export_ssa_names(fun, funid, ssadefs);
+  if (CLGCC_env)
+    CL_EndAssertBatch(CLGCC_env);
+  CLGCC_DBGPRINTF("CLGCC_export_function %s exported %ld statements",
+                  function_name(fun), rank);
+  return rank;
+} // end CLGCC_export_function
+
+
+/// set by -fplugin-arg-clipsgccplug-alpha-threads=<N>; the facts of
+/// a function are then pattern matched by N threads when its batch
+/// ends
+unsigned CLGCC_alpha_threads;
+
+/// set by -fplugin-arg-clipsgccplug-per-function
+bool CLGCC_per_function;
+
+/// with CLGCC_per_function, the facts of each function are asserted,
+/// the rules are run, then all the facts asserted meanwhile (including
+/// those asserted by the rules) are retracted together, so the fact
+/// base only holds one function at a time. Facts asserted before, like
+/// the gcc-translation-unit one, are kept.
+static void
+clgcc_export_function_scoped(function*fun)
+{
+  if (CLGCC_serverfd >= 0)
+    {
+      CLGCC_phase_timer tim(CLGCC_PHASE_EXPORT);
+      CLGCC_server_send("MARK\n");
+      CLGCC_export_function(fun);
+      CLGCC_server_send("SCOPED\n");
+      return;
+    }
+  long long mark = CL_FactMark(CLGCC_env);
+  {
+    CLGCC_phase_timer tim(CLGCC_PHASE_EXPORT);
+    CLGCC_export_function(fun);
+  }
+  double runstartim = CLGCC_cputime();
+  long long nbfired = 0;
+  {
+    CLGCC_phase_timer tim(CLGCC_PHASE_RUN);
+    nbfired = CL_Run(CLGCC_env, -1);
+    CLGCC_nb_fired += nbfired;
+  }
+  CLGCC_harvest_diagnostics();
+  if (CL_RetractFactsSince(CLGCC_env, mark) != RE_NO_ERROR)
+    warning(UNKNOWN_LOCATION, "CLIPS-GCC: failed to retract facts of function %s",
+            function_name(fun));
+  CLGCC_DBGPRINTF("clgcc_export_function_scoped %s fired %lld rules in %.3f s",
+                  function_name(fun), nbfired, CLGCC_cputime() - runstartim);
+} // end clgcc_export_function_scoped
+
+
+////////////////////////////////////////////////////////////////
+const pass_data clgcc_gimple_pass_data =
+{
+  GIMPLE_PASS,		/* type */
+  "clipsgcc_gimple",	/* name */
+  OPTGROUP_NONE,	/* optinfo_flags */
+  TV_NONE,		/* tv_id */
+  PROP_cfg | PROP_ssa,	/* properties_required */
+  0,			/* properties_provided */
+  0,			/* properties_destroyed */
+  0,			/* todo_flags_start */
+  0,			/* todo_flags_finish */
+};
+
+class clgcc_gimple_pass : public gimple_opt_pass
+{
+public:
+  clgcc_gimple_pass(gcc::context*ctxt)
+    : gimple_opt_pass(clgcc_gimple_pass_data, ctxt)
+  {
+  };
+  virtual bool gate (function*)
+  {
+    return CLGCC_env != nullptr || CLGCC_serverfd >= 0;
+  };
+  virtual unsigned int execute (function*fun)
+  {
+    if (CLGCC_per_function)
+      clgcc_export_function_scoped(fun);
+    else
+      {
+        CLGCC_phase_timer tim(CLGCC_PHASE_EXPORT);
+        CLGCC_export_function(fun);
+      }
+    return 0;
+  };
+};				// end clgcc_gimple_pass
+
+
+/// our pass runs once per function, just after it went into SSA form;
+/// but an LTRANS partition reads functions already in SSA form and
+/// only runs the late passes, so there it runs after the last one
+void
+CLGCC_register_gimple_pass(const char*plugin_name)
+{
+  static struct register_pass_info passinfo;
+  passinfo.pass = new clgcc_gimple_pass(g);
+  passinfo.reference_pass_name =
+    (CLGCC_lto_phase == CLGCC_LTO_LTRANS) ? "optimized" : "ssa";
+  passinfo.ref_pass_instance_number = 1;
+  passinfo.pos_op = PASS_POS_INSERT_AFTER;
+  register_callback (plugin_name, PLUGIN_PASS_MANAGER_SETUP, NULL, &passinfo);
+  CLGCC_DBGPRINTF("CLGCC_register_gimple_pass %s", plugin_name);
+} // end CLGCC_register_gimple_pass
+
+// end of file clips-gcc-gimple.cc
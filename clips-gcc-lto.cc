@@ -0,0 +1,233 @@
+/**
+   https://github.com/bstarynk/clips-rules-gcc
+
+   file clips-gcc-lto.cc running rules in link-time optimization. To
+   be indented with astyle --style=gnu -s2 clips-gcc-lto.cc
+
+   Copyright © 2020 CEA (Commissariat à l'énergie atomique et aux énergies alternatives)
+   contributed by Basile Starynkevitch.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+**/
+#include "clips-gcc.hh"
+
+#include <dirent.h>
+
+#include "md5.h"
+
+/// With -flto, GCC runs our plugin in three kinds of processes: cc1
+/// compiling each translation unit, then a single lto1 doing the
+/// whole program analysis (WPA), then several lto1 processes in
+/// parallel, one per LTRANS partition. Every process has its own
+/// CLGCC_env, so each LTRANS partition is analyzed by its own
+/// environment, without serializing the whole program in one.
+///
+/// With -fplugin-arg-clipsgccplug-lto-dir=DIR, the facts which the
+/// rules asserted while compiling a translation unit (that is, the
+/// facts of deftemplates of the loaded CLIPS files, not our gcc-*
+/// GIMPLE facts) are saved into DIR. The WPA process, which has no
+/// function bodies, loads them all into one environment and runs the
+/// rules once more, so whole program checks combine the results of
+/// every translation unit.
+
+enum clgcc_lto_phase_en CLGCC_lto_phase;
+std::string CLGCC_lto_dir;
+
+static const char*const clgcc_lto_phase_names[] =
+{
+  "none", "compile", "wpa", "ltrans"
+};
+
+
+/// called from plugin_init, once GCC options are known
+void
+CLGCC_detect_lto_phase(void)
+{
+  if (flag_wpa)
+    CLGCC_lto_phase = CLGCC_LTO_WPA;
+  else if (flag_ltrans)
+    CLGCC_lto_phase = CLGCC_LTO_LTRANS;
+  else if (flag_generate_lto)
+    CLGCC_lto_phase = CLGCC_LTO_COMPILE;
+  else
+    CLGCC_lto_phase = CLGCC_LTO_NONE;
+  CLGCC_DBGPRINTF("CLGCC_detect_lto_phase %s",
+                  clgcc_lto_phase_names[CLGCC_lto_phase]);
+} // end CLGCC_detect_lto_phase
+
+
+/// the index of an LTRANS partition, found in the name of its input
+/// file like /tmp/ccXYZ.ltrans3.o, or -1
+static long
+clgcc_ltrans_partition(void)
+{
+  const char*ltr = main_input_filename?strstr(main_input_filename, ".ltrans"):nullptr;
+  if (!ltr)
+    return -1;
+  char*end = nullptr;
+  long part = strtol(ltr + strlen(".ltrans"), &end, 10);
+  if (end == ltr + strlen(".ltrans"))
+    return -1;
+  return part;
+} // end clgcc_ltrans_partition
+
+
+/// called from CLGCC_starting, tells the rules in which phase they run
+void
+CLGCC_lto_assert_phase(void)
+{
+  auto& ltoexp = CLGCC_lto_exporter;
+  if (CLGCC_lto_phase == CLGCC_LTO_NONE || !ltoexp.wanted())
+    return;
+  ltoexp.put_symbol(CLGCC_LTO_PHASE, clgcc_lto_phase_names[CLGCC_lto_phase]);
+  if (CLGCC_lto_phase == CLGCC_LTO_LTRANS)
+    ltoexp.put_integer(CLGCC_LTO_PARTITION, clgcc_ltrans_partition());
+  ltoexp.assert_fact();
+} // end CLGCC_lto_assert_phase
+
+
+/// recompiling a translation unit replaces its saved facts, since
+/// their file is named by the MD5 of the real path of its source
+static std::string
+clgcc_lto_unit_path(void)
+{
+  struct md5_ctx ctx;
+  unsigned char digest[16];
+  char hexbuf[2*sizeof(digest)+1];
+  char*rp = realpath(main_input_filename, nullptr);
+  const char*unitpath = rp?rp:main_input_filename;
+  md5_init_ctx (&ctx);
+  md5_process_bytes (unitpath, strlen(unitpath), &ctx);
+  md5_finish_ctx (&ctx, digest);
+  free(rp);
+  memset (hexbuf, 0, sizeof(hexbuf));
+  for (unsigned ix=0; ix<sizeof(digest); ix++)
+    snprintf(hexbuf+2*ix, 3, "%02x", digest[ix]);
+  return CLGCC_lto_dir + "/unit-" + hexbuf + ".clp";
+} // end clgcc_lto_unit_path
+
+
+/// called from CLGCC_finishing after the rules ran, before CLGCC_env
+/// is destroyed. Our GIMPLE facts are retracted, then the remaining
+/// facts are saved thru a temporary file which is renamed, since the
+/// link may start while another compilation writes its facts.
+void
+CLGCC_lto_save_results(void)
+{
+  if (CLGCC_lto_phase != CLGCC_LTO_COMPILE || CLGCC_lto_dir.empty()
+      || !main_input_filename)
+    return;
+  assert (CLGCC_env != nullptr);
+  for (CLGCC_Fact_Exporter*const*pexp = CLGCC_all_exporters; *pexp; pexp++)
+    {
+      Deftemplate*dt = (*pexp)->deftemplate();
+      if (dt)
+        CL_RetractDeftemplateFacts(dt);
+    }
+  if (mkdir(CLGCC_lto_dir.c_str(), 0750) && errno != EEXIST)
+    {
+      warning(UNKNOWN_LOCATION, "CLIPS-GCC: cannot make LTO directory %s (%m)",
+              CLGCC_lto_dir.c_str());
+      return;
+    }
+  std::string unitpath = clgcc_lto_unit_path();
+  char pidbuf[32];
+  snprintf(pidbuf, sizeof(pidbuf), ".%d-tmp", (int)getpid());
+  std::string tmpath = unitpath + pidbuf;
+  if (!CL_Save_Facts(CLGCC_env, tmpath.c_str(), LOCAL_SAVE)
+      || rename(tmpath.c_str(), unitpath.c_str()))
+    {
+      warning(UNKNOWN_LOCATION, "CLIPS-GCC: failed to save facts of %s into %s",
+              main_input_filename, unitpath.c_str());
+      unlink(tmpath.c_str());
+      return;
+    }
+  CLGCC_DBGPRINTF("CLGCC_lto_save_results %s into %s",
+                  main_input_filename, unitpath.c_str());
+} // end CLGCC_lto_save_results
+
+
+/// load the facts saved by every translation unit
+static long
+clgcc_lto_load_results(void)
+{
+  long nbfiles = 0;
+  DIR*dir = opendir(CLGCC_lto_dir.c_str());
+  if (!dir)
+    {
+      warning(UNKNOWN_LOCATION, "CLIPS-GCC: cannot open LTO directory %s (%m)",
+              CLGCC_lto_dir.c_str());
+      return 0;
+    }
+  std::set<std::string> unitpaths;
+  while (struct dirent*ent = readdir(dir))
+    {
+      size_t namlen = strlen(ent->d_name);
+      if (!strncmp(ent->d_name, "unit-", 5)
+          && namlen > 4 && !strcmp(ent->d_name + namlen - 4, ".clp"))
+        unitpaths.insert(CLGCC_lto_dir + "/" + ent->d_name);
+    }
+  closedir(dir);
+  /// sorted, so the merge does not depend on the directory order
+  for (const std::string& curpath: unitpaths)
+    {
+      if (CL_Load_Facts(CLGCC_env, curpath.c_str()))
+        nbfiles++;
+      else
+        warning(UNKNOWN_LOCATION, "CLIPS-GCC: failed to load facts from %s",
+                curpath.c_str());
+    }
+  return nbfiles;
+} // end clgcc_lto_load_results
+
+
+/// GCC callback at the end of the WPA process, which never gets
+/// PLUGIN_FINISH_UNIT: merge the results of all translation units,
+/// run the rules, then destroy CLGCC_env
+void
+CLGCC_lto_merge(void*gccdata __attribute__((unused)), void*userdata __attribute__((unused)))
+{
+  if (!CLGCC_env)
+    return;
+  long nbfiles = 0;
+  {
+    CLGCC_phase_timer tim(CLGCC_PHASE_LOAD);
+    if (!CLGCC_lto_dir.empty())
+      nbfiles = clgcc_lto_load_results();
+  }
+  {
+    CLGCC_phase_timer tim(CLGCC_PHASE_RUN);
+    double runstartim = CLGCC_cputime();
+    long long nbfired = CL_Run(CLGCC_env, -1);
+    CLGCC_nb_fired += nbfired;
+    CLGCC_DBGPRINTF("CLGCC_lto_merge of %ld units fired %lld rules in %.3f s",
+                    nbfiles, nbfired, CLGCC_cputime() - runstartim);
+  }
+  CLGCC_harvest_diagnostics();
+  CLGCC_emit_diagnostics();
+  inform(UNKNOWN_LOCATION, "CLIPS-GCC: merged the facts of %ld translation units from %s",
+         nbfiles, CLGCC_lto_dir.c_str());
+  CLGCC_stats_sample();
+  {
+    CLGCC_phase_timer tim(CLGCC_PHASE_TEARDOWN);
+    CLGCC_dispose_gimple_templates();
+    if (!CL_DestroyEnvironment(CLGCC_env))
+      fatal_error(UNKNOWN_LOCATION, "CLIPS-GCC: CL_DestroyEnvironment failed");
+    CLGCC_env = nullptr;
+  }
+  CLGCC_stats_report();
+} // end CLGCC_lto_merge
+
+// end of file clips-gcc-lto.cc
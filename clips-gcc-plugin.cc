@@ -89,20 +89,21 @@ CLGCC_starting(void*gccdata __attribute__((unused)), void*userdata __attribute((
          CLGCC_translationunitstr.c_str(),
          cputimbuf,
          CLGCC_basename(__FILE__), __LINE__);
-  {
-    bool ok = CL_ParseDeftemplate (CLGCC_env,
-                                   R"clipsstr(
- (deftemplate gcc-translation-unit 
-  "the source file compiled by GCC"
-  (slot file-path
-   (type STRING)
- ))
-)clipsstr");
-    CLGCC_DBGPRINTF("CLGCC_starting after deftemplate gcc-translation-unit ok=%s", ok?"true":"false");
-  }
-  CLGCC_DBGPRINTF("CLGCC_starting before CL_CommandLoop_Batch");
-  CL_CommandLoop_Batch(CLGCC_env);
-  CLGCC_DBGPRINTF("CLGCC_starting after CL_CommandLoop_Batch");
+  /// a compile server already has the rules loaded
+  if (CLGCC_serverfd < 0)
+    {
+      CLGCC_phase_timer tim(CLGCC_PHASE_LOAD);
+      CLGCC_load_rule_files();
+      CLGCC_filter_gimple_templates();
+    }
+  if (main_input_filename && CLGCC_translation_unit_exporter.wanted())
+    {
+      CLGCC_phase_timer tim(CLGCC_PHASE_EXPORT);
+      auto& tuexp = CLGCC_translation_unit_exporter;
+      tuexp.put_string(CLGCC_TRANSLATION_UNIT_FILE_PATH, main_input_filename);
+      tuexp.assert_fact();
+    }
+  CLGCC_lto_assert_phase();
 } // end CLGCC_starting
 
 
@@ -120,8 +121,47 @@ CLGCC_finishing(void*gccdata __attribute__((unused)), void*userdata __attribute(
          CLGCC_projectstr.c_str(),
          CLGCC_translationunitstr.c_str(),
          cputimbuf, CLGCC_basename(__FILE__), __LINE__);
-  if (!CL_DestroyEnvironment(CLGCC_env))
-    fatal_error(UNKNOWN_LOCATION, "CLIPS-GCC: CL_DestroyEnvironment failed");
+  /// the WPA rules are run by CLGCC_lto_merge
+  if (CLGCC_lto_phase == CLGCC_LTO_WPA)
+    return;
+  if (CLGCC_serverfd >= 0)
+    {
+      double runstartim = CLGCC_cputime();
+      {
+        CLGCC_phase_timer tim(CLGCC_PHASE_RUN);
+        long long nbfired = CLGCC_server_run();
+        CLGCC_nb_fired += nbfired;
+        CLGCC_DBGPRINTF("CLGCC_finishing server fired %lld rules in %.3f s",
+                        nbfired, CLGCC_cputime() - runstartim);
+      }
+      CLGCC_emit_diagnostics();
+      {
+        CLGCC_phase_timer tim(CLGCC_PHASE_TEARDOWN);
+        CLGCC_server_bye();
+      }
+      CLGCC_stats_report();
+      return;
+    }
+  {
+    CLGCC_phase_timer tim(CLGCC_PHASE_RUN);
+    double runstartim = CLGCC_cputime();
+    long long nbfired = CL_Run(CLGCC_env, -1);
+    CLGCC_nb_fired += nbfired;
+    CLGCC_DBGPRINTF("CLGCC_finishing fired %lld rules in %.3f s",
+                    nbfired, CLGCC_cputime() - runstartim);
+  }
+  CLGCC_harvest_diagnostics();
+  CLGCC_emit_diagnostics();
+  CLGCC_lto_save_results();
+  CLGCC_stats_sample();
+  {
+    CLGCC_phase_timer tim(CLGCC_PHASE_TEARDOWN);
+    CLGCC_dispose_gimple_templates();
+    if (!CL_DestroyEnvironment(CLGCC_env))
+      fatal_error(UNKNOWN_LOCATION, "CLIPS-GCC: CL_DestroyEnvironment failed");
+    CLGCC_env = nullptr;
+  }
+  CLGCC_stats_report();
 
 } // end CLGCC_finishing
 
@@ -140,7 +180,6 @@ parse_plugin_arguments (const char*plugin_name, struct plugin_name_args* plargs,
   assert (plargs->help == NULL);
   plargs->version = versbuf;
   plargs->help = "See https://github.com/bstarynk/clips-rules-gcc";
-  auto str_plugin_name = std::string(plugin_name);
   //
   for (struct plugin_argument* plcurarg = plargs->argv;
        (ix<plargc)?(plcurarg = plargs->argv+ix):nullptr; ix++)
@@ -161,6 +200,15 @@ parse_plugin_arguments (const char*plugin_name, struct plugin_name_args* plargs,
                   "CLIPS-GCC plugin %s help:\n", plugin_name);
           printf("\t -fplugin-arg-%s-help #this help\n", plugin_name);
           printf("\t -fplugin-arg-%s-project=<projectname> or $CLIPSGCC_PROJECT\n", plugin_name);
+          printf("\t -fplugin-arg-%s-load=<clipsfile> #load that CLIPS file\n", plugin_name);
+          printf("\t -fplugin-arg-%s-cache=<directory> #cache binary images of loaded CLIPS files\n", plugin_name);
+          printf("\t -fplugin-arg-%s-server=<socket> #run the rules in a clgcc-server daemon\n", plugin_name);
+          printf("\t -fplugin-arg-%s-per-function #run the rules then retract the facts after each function\n", plugin_name);
+          printf("\t -fplugin-arg-%s-stats=<file> #append a JSON line of statistics per translation unit\n", plugin_name);
+          printf("\t -fplugin-arg-%s-lto-dir=<directory> #with -flto, merge the facts of every translation unit at WPA\n", plugin_name);
+          printf("\t -fplugin-arg-%s-export-all #also export facts which no loaded rule matches\n", plugin_name);
+          printf("\t -fplugin-arg-%s-lazy #compute costly slots of GIMPLE facts only when read, implies per-function\n", plugin_name);
+          printf("\t -fplugin-arg-%s-alpha-threads=<N> #pattern match the facts of each function with N threads\n", plugin_name);
         } // end (CLGCC_GOT_PLAIN_OPTION("help")
       ////////////////
       else if (CLGCC_GOT_OPTION("load"))
@@ -171,20 +219,63 @@ parse_plugin_arguments (const char*plugin_name, struct plugin_name_args* plargs,
           else
             {
               CLGCC_DBGPRINTF("CLIPS-GCC: plugin %s will load %s", plugin_name, curval);
-              std::string curpath(curval);
-              todoque.push_back([=]()
-              {
-                CLGCC_DBGPRINTF("CLIPS-GCC: plugin %s loading batch %s",  str_plugin_name.c_str(), curpath.c_str());
-                if (CL_Batch(CLGCC_env, curpath.c_str()))
-                  warning(UNKNOWN_LOCATION,"CLIPS-GCC: plugin %s failed to batch CLIPS file %s",
-                          str_plugin_name.c_str(), curpath.c_str());
-                else
-                  inform(UNKNOWN_LOCATION, "CLIPS-GCC plugin %s did load CLIPS file %s",
-                         str_plugin_name.c_str(), curpath.c_str());
-              });
+              /// loaded by CLGCC_load_rule_files when starting the translation unit
+              CLGCC_rulefiles.push_back(std::string(curval));
             }
         } // end CLGCC_GOT_OPTION("load")
       ////////////////
+      else if (CLGCC_GOT_OPTION("cache"))
+        {
+          CLGCC_cachedir = std::string(curval);
+          CLGCC_DBGPRINTF("CLIPS-GCC: plugin %s caching CLIPS images in %s", plugin_name, curval);
+        } // end CLGCC_GOT_OPTION("cache")
+      ////////////////
+      else if (CLGCC_GOT_OPTION("server"))
+        {
+          CLGCC_serverpath = std::string(curval);
+          CLGCC_DBGPRINTF("CLIPS-GCC: plugin %s using server %s", plugin_name, curval);
+        } // end CLGCC_GOT_OPTION("server")
+      ////////////////
+      else if (CLGCC_GOT_OPTION("lto-dir"))
+        {
+          CLGCC_lto_dir = std::string(curval);
+          CLGCC_DBGPRINTF("CLIPS-GCC: plugin %s saving LTO facts in %s", plugin_name, curval);
+        } // end CLGCC_GOT_OPTION("lto-dir")
+      ////////////////
+      else if (CLGCC_GOT_OPTION("stats"))
+        {
+          CLGCC_statsfile = std::string(curval);
+          CLGCC_DBGPRINTF("CLIPS-GCC: plugin %s writing statistics to %s", plugin_name, curval);
+        } // end CLGCC_GOT_OPTION("stats")
+      ////////////////
+      else if (CLGCC_GOT_PLAIN_OPTION("per-function"))
+        {
+          CLGCC_per_function = true;
+          CLGCC_DBGPRINTF("CLIPS-GCC: plugin %s running rules per function", plugin_name);
+        } // end CLGCC_GOT_PLAIN_OPTION("per-function")
+      ////////////////
+      else if (CLGCC_GOT_PLAIN_OPTION("export-all"))
+        {
+          CLGCC_export_all = true;
+          CLGCC_DBGPRINTF("CLIPS-GCC: plugin %s exporting all GIMPLE facts", plugin_name);
+        } // end CLGCC_GOT_PLAIN_OPTION("export-all")
+      ////////////////
+      else if (CLGCC_GOT_PLAIN_OPTION("lazy"))
+        {
+          /// lazy slots read the GIMPLE, so the rules should run
+          /// while the function is still in SSA form
+          CLGCC_lazy = true;
+          CLGCC_per_function = true;
+          CLGCC_DBGPRINTF("CLIPS-GCC: plugin %s with lazy GIMPLE facts", plugin_name);
+        } // end CLGCC_GOT_PLAIN_OPTION("lazy")
+      ////////////////
+      else if (CLGCC_GOT_OPTION("alpha-threads"))
+        {
+          CLGCC_alpha_threads = atoi(curval);
+          CLGCC_DBGPRINTF("CLIPS-GCC: plugin %s with %u alpha matching threads",
+                          plugin_name, CLGCC_alpha_threads);
+        } // end CLGCC_GOT_OPTION("alpha-threads")
+      ////////////////
       else if (CLGCC_GOT_OPTION("dbgfile"))
         {
           clgcc_dbgfile = fopen(curval, "w+");
@@ -311,17 +402,36 @@ plugin_init (struct plugin_name_args *plugin_info,
                 plugin_name, dbgstr, CLGCC_basename(__FILE__), __LINE__);
       CLGCC_DBGPRINTF("plugin_init %s dbgstr '%s'",   plugin_name, dbgstr);
     }
-  /// the CLIPS environment needs to be created very early
-  CLGCC_env = CL_CreateEnvironment();
-  if (!CLGCC_env)
-    fatal_error(UNKNOWN_LOCATION, "CLIPS-GCC: CL_CreateEnvironment failed");
-  CLGCC_DBGPRINTF("plugin_init %s created CLGCC_env@%p", plugin_name, CLGCC_env);
-  CLGCC_DBGPRINTF("plugin_init %s before registering", plugin_name);
-  register_callback (plugin_name, PLUGIN_START_UNIT, CLGCC_starting, NULL);
-  register_callback (plugin_name, PLUGIN_FINISH_UNIT, CLGCC_finishing, NULL);
   /// initialize global state from arguments, and give information about this plugin
   CLGCC_DBGPRINTF("plugin_init %s before parsing arguments", plugin_name);
   parse_plugin_arguments (plugin_name, plugin_info, todoque);
+  CLGCC_detect_lto_phase();
+  /// the merge at WPA needs a local environment, with every saved fact
+  if (CLGCC_lto_phase == CLGCC_LTO_WPA)
+    CLGCC_serverpath.clear();
+  /// with a reachable compile server, no CLIPS environment is needed here
+  if (!CLGCC_serverpath.empty() && CLGCC_connect_server())
+    inform(UNKNOWN_LOCATION, "CLIPS-GCC plugin %s using server %s",
+           plugin_name, CLGCC_serverpath.c_str());
+  else
+    {
+      CLGCC_phase_timer tim(CLGCC_PHASE_ENVIRONMENT);
+      /// the CLIPS environment needs to be created very early
+      CLGCC_env = CL_CreateEnvironment();
+      if (!CLGCC_env)
+        fatal_error(UNKNOWN_LOCATION, "CLIPS-GCC: CL_CreateEnvironment failed");
+      CLGCC_DBGPRINTF("plugin_init %s created CLGCC_env@%p", plugin_name, CLGCC_env);
+      CL_SetAlphaMatchThreads(CLGCC_env, CLGCC_alpha_threads);
+      CLGCC_stats_watch();
+      /// our deftemplates should exist before any CLIPS file is loaded
+      CLGCC_define_gimple_templates();
+    }
+  CLGCC_DBGPRINTF("plugin_init %s before registering", plugin_name);
+  register_callback (plugin_name, PLUGIN_START_UNIT, CLGCC_starting, NULL);
+  register_callback (plugin_name, PLUGIN_FINISH_UNIT, CLGCC_finishing, NULL);
+  if (CLGCC_lto_phase == CLGCC_LTO_WPA)
+    register_callback (plugin_name, PLUGIN_FINISH, CLGCC_lto_merge, NULL);
+  CLGCC_register_gimple_pass (plugin_name);
   CLGCC_DBGPRINTF("plugin_init %s before todo todoquelength=%zd", plugin_name, todoque.size());
   for (auto todof: todoque)
     todof();
@@ -0,0 +1,192 @@
+/**
+   https://github.com/bstarynk/clips-rules-gcc
+
+   file clips-gcc-stats.cc measuring the phases of the plugin, and
+   reporting them in JSON. To be indented with
+   astyle --style=gnu -s2 clips-gcc-stats.cc
+
+   Copyright © 2020 CEA (Commissariat à l'énergie atomique et aux énergies alternatives)
+   contributed by Basile Starynkevitch.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+**/
+#include "clips-gcc.hh"
+
+#include <fcntl.h>
+
+/// the file given by -fplugin-arg-clipsgccplug-stats=, or empty
+std::string CLGCC_statsfile;
+
+/// CPU time spent in each phase, in seconds
+double CLGCC_phase_time[CLGCC_PHASE__LAST];
+
+static const char*const clgcc_phase_names[CLGCC_PHASE__LAST] =
+{
+  "environment", "rule_loading", "fact_export", "rules_run", "teardown"
+};
+
+/// counters, updated even without a statistics file since that is cheap
+long long CLGCC_nb_fired;
+static long long clgcc_nb_asserted;
+static long long clgcc_nb_retracted;
+/// sampled by CLGCC_stats_sample before the environment is destroyed
+static long long clgcc_nb_partial_matches = -1;
+static long long clgcc_peak_memory = -1;
+
+
+CLGCC_phase_timer::CLGCC_phase_timer(enum clgcc_phase_en phase)
+  : tim_phase(phase), tim_start(CLGCC_cputime())
+{
+  assert (phase < CLGCC_PHASE__LAST);
+} // end CLGCC_phase_timer::CLGCC_phase_timer
+
+
+CLGCC_phase_timer::~CLGCC_phase_timer()
+{
+  CLGCC_phase_time[tim_phase] += CLGCC_cputime() - tim_start;
+} // end CLGCC_phase_timer::~CLGCC_phase_timer
+
+
+static void
+clgcc_count_assert(Environment*, void*, void*)
+{
+  clgcc_nb_asserted++;
+} // end clgcc_count_assert
+
+
+static void
+clgcc_count_retract(Environment*, void*, void*)
+{
+  clgcc_nb_retracted++;
+} // end clgcc_count_retract
+
+
+/// called once CLGCC_env is created, to count its facts
+void
+CLGCC_stats_watch(void)
+{
+  assert (CLGCC_env != nullptr);
+  if (!CL_Add_AssertFunction(CLGCC_env, "clgcc-count-assert",
+                             clgcc_count_assert, 0, nullptr)
+      || !CL_Add_RetractFunction(CLGCC_env, "clgcc-count-retract",
+                                 clgcc_count_retract, 0, nullptr))
+    warning(UNKNOWN_LOCATION, "CLIPS-GCC: failed to count facts");
+} // end CLGCC_stats_watch
+
+
+/// called before CLGCC_env is destroyed
+void
+CLGCC_stats_sample(void)
+{
+  assert (CLGCC_env != nullptr);
+  clgcc_nb_partial_matches = (long long) CL_GetPartialMatchCount(CLGCC_env);
+  clgcc_peak_memory = CL_MemPeak(CLGCC_env);
+} // end CLGCC_stats_sample
+
+
+static void
+clgcc_json_string(std::string&out, const char*str)
+{
+  out.push_back('"');
+  for (const char*pc = str?str:""; *pc; pc++)
+    {
+      switch (*pc)
+        {
+        case '"':
+          out.append("\\\"");
+          break;
+        case '\\':
+          out.append("\\\\");
+          break;
+        case '\n':
+          out.append("\\n");
+          break;
+        case '\t':
+          out.append("\\t");
+          break;
+        default:
+          if ((unsigned char)*pc < ' ')
+            {
+              char buf[8];
+              snprintf(buf, sizeof(buf), "\\u%04x", (unsigned)*pc);
+              out.append(buf);
+            }
+          else
+            out.push_back(*pc);
+        }
+    }
+  out.push_back('"');
+} // end clgcc_json_string
+
+
+/// counters unknown here, e.g. in compile server mode, are null
+static void
+clgcc_json_counter(std::string&out, const char*name, long long num)
+{
+  out.append(", \"");
+  out.append(name);
+  out.append("\": ");
+  if (num < 0)
+    out.append("null");
+  else
+    out.append(std::to_string(num));
+} // end clgcc_json_counter
+
+
+/// append to CLGCC_statsfile one JSON object on a single line for
+/// the current translation unit. Since parallel compilations may
+/// share that file, the line is written by one write(2) in append mode
+void
+CLGCC_stats_report(void)
+{
+  if (CLGCC_statsfile.empty())
+    return;
+  std::string line("{\"project\": ");
+  clgcc_json_string(line, CLGCC_projectstr.c_str());
+  line.append(", \"translation_unit\": ");
+  clgcc_json_string(line, main_input_filename);
+  line.append(", \"server\": ");
+  line.append((CLGCC_serverfd >= 0)?"true":"false");
+  line.append(", \"cpu_time\": {");
+  for (int ph = 0; ph < CLGCC_PHASE__LAST; ph++)
+    {
+      char buf[64];
+      snprintf(buf, sizeof(buf), "%s\"%s\": %.6f", ph?", ":"",
+               clgcc_phase_names[ph], CLGCC_phase_time[ph]);
+      line.append(buf);
+    }
+  line.append("}");
+  bool local = (CLGCC_serverfd < 0);
+  clgcc_json_counter(line, "facts_asserted", local?clgcc_nb_asserted:-1);
+  clgcc_json_counter(line, "facts_retracted", local?clgcc_nb_retracted:-1);
+  clgcc_json_counter(line, "rules_fired", CLGCC_nb_fired);
+  clgcc_json_counter(line, "partial_matches", local?clgcc_nb_partial_matches:-1);
+  clgcc_json_counter(line, "peak_memory", local?clgcc_peak_memory:-1);
+  line.append("}\n");
+  int fd = open(CLGCC_statsfile.c_str(), O_WRONLY|O_APPEND|O_CREAT|O_CLOEXEC, 0644);
+  if (fd < 0)
+    {
+      warning(UNKNOWN_LOCATION, "CLIPS-GCC: cannot open statistics file %s (%m)",
+              CLGCC_statsfile.c_str());
+      return;
+    }
+  if (write(fd, line.c_str(), line.size()) != (ssize_t) line.size())
+    warning(UNKNOWN_LOCATION, "CLIPS-GCC: failed to write statistics file %s (%m)",
+            CLGCC_statsfile.c_str());
+  close(fd);
+  CLGCC_DBGPRINTF("CLGCC_stats_report %s", line.c_str());
+} // end CLGCC_stats_report
+
+// end of file clips-gcc-stats.cc
@@ -37,11 +37,18 @@
 #include <set>
 #include <functional>
 #include <deque>
+#include <vector>
+#include <algorithm>
+#include <tuple>
 
 #include <cstdio>
 #include <cassert>
 
 #include <unistd.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include <time.h>
 #include <math.h>
 #include <string.h>
@@ -75,10 +82,16 @@
 #include "plugin-version.h"
 #include "diagnostic.h"
 #include "context.h"
+#include "real.h"
+#include "function.h"
+#include "ssa.h"
+#include "options.h"
 
 extern "C" {
 #include "clips.h"
 #include "tmpltpsr.h"
+#include "tmpltutl.h"
+#include "reteutil.h"
 };				// end include clips.h as "C"
 
 // For our CLGCC_DBGPRINTF macro in setup.h we need:
@@ -108,4 +121,249 @@ extern "C" Environment* CLGCC_env;
 extern std::string CLGCC_projectstr;
 extern std::string CLGCC_translationunitstr;
 
+////////////////////////////////////////////////////////////////
+//// in clips-gcc-gimple.cc
+
+/// slot ranks of our exported deftemplates; the actual CLIPS slot
+/// positions are computed once in CLGCC_Fact_Exporter::build_template
+enum clgcc_translation_unit_slot_en
+{
+  CLGCC_TRANSLATION_UNIT_FILE_PATH,
+  CLGCC_TRANSLATION_UNIT__LAST
+};
+
+enum clgcc_function_slot_en
+{
+  CLGCC_FUNCTION_ID,
+  CLGCC_FUNCTION_NAME,
+  CLGCC_FUNCTION_FILE,
+  CLGCC_FUNCTION_LINE,
+  CLGCC_FUNCTION__LAST
+};
+
+enum clgcc_basic_block_slot_en
+{
+  CLGCC_BASIC_BLOCK_FUNCTION,
+  CLGCC_BASIC_BLOCK_INDEX,
+  CLGCC_BASIC_BLOCK_PREDECESSORS,
+  CLGCC_BASIC_BLOCK_SUCCESSORS,
+  CLGCC_BASIC_BLOCK__LAST
+};
+
+enum clgcc_statement_slot_en
+{
+  CLGCC_STATEMENT_FUNCTION,
+  CLGCC_STATEMENT_BASIC_BLOCK,
+  CLGCC_STATEMENT_RANK,
+  CLGCC_STATEMENT_CODE,
+  CLGCC_STATEMENT_OPERATION,
+  CLGCC_STATEMENT_LHS,
+  CLGCC_STATEMENT_USES,
+  CLGCC_STATEMENT_OPERANDS,
+  CLGCC_STATEMENT_CALLEE,
+  CLGCC_STATEMENT_FILE,
+  CLGCC_STATEMENT_LINE,
+  CLGCC_STATEMENT__LAST
+};
+
+enum clgcc_ssa_name_slot_en
+{
+  CLGCC_SSA_NAME_FUNCTION,
+  CLGCC_SSA_NAME_VERSION,
+  CLGCC_SSA_NAME_VARIABLE,
+  CLGCC_SSA_NAME_TYPE,
+  CLGCC_SSA_NAME_DEFINITION,
+  CLGCC_SSA_NAME_DEFAULT_DEF,
+  CLGCC_SSA_NAME__LAST
+};
+
+enum clgcc_lto_slot_en
+{
+  CLGCC_LTO_PHASE,
+  CLGCC_LTO_PARTITION,
+  CLGCC_LTO__LAST
+};
+
+enum clgcc_diagnostic_slot_en
+{
+  CLGCC_DIAGNOSTIC_FILE,
+  CLGCC_DIAGNOSTIC_LINE,
+  CLGCC_DIAGNOSTIC_COLUMN,
+  CLGCC_DIAGNOSTIC_SEVERITY,
+  CLGCC_DIAGNOSTIC_MESSAGE,
+  CLGCC_DIAGNOSTIC__LAST
+};
+
+/// computes, thru the put_* member functions, the slot of given rank
+/// of a fact of a lazy exporter from its source (a gimple or a tree)
+typedef void CLGCC_lazy_filler_t(unsigned rk, void*source);
+
+/// an exported deftemplate, with its reusable fact builder
+class CLGCC_Fact_Exporter
+{
+  const char*const exp_name;
+  const char*const*const exp_slotnames;
+  const unsigned exp_nbslots;
+  const char*const exp_source;
+  Deftemplate* exp_deftemplate;
+  Fact_Builder* exp_builder;
+  std::vector<unsigned short> exp_slotix;
+  /// encoded slot values, when facts are sent to a compile server
+  std::vector<std::string> exp_remote;
+  /// for lazy exporters, the filler and the slot ranks it computes
+  CLGCC_lazy_filler_t*const exp_lazyfiller;
+  const std::vector<unsigned> exp_lazyranks;
+  /// the slot being lazily computed, and where its value goes
+  unsigned exp_lazyrank;
+  CLIPSValue* exp_lazyval;
+  /// false when no loaded rule can match our facts
+  bool exp_wanted;
+  void put_value(unsigned rk, CLIPSValue*pval);
+  static bool lazy_slot(Environment*env, Fact*fact, unsigned short whichslot,
+                        CLIPSValue*pval, void*context);
+public:
+  CLGCC_Fact_Exporter(const char*name, const char*const*slotnames, unsigned nbslots, const char*source,
+                      CLGCC_lazy_filler_t*lazyfiller=nullptr, std::vector<unsigned> lazyranks= {})
+    : exp_name(name), exp_slotnames(slotnames), exp_nbslots(nbslots), exp_source(source),
+      exp_deftemplate(nullptr), exp_builder(nullptr), exp_slotix(), exp_remote(nbslots),
+      exp_lazyfiller(lazyfiller), exp_lazyranks(lazyranks),
+      exp_lazyrank(0), exp_lazyval(nullptr), exp_wanted(true) {};
+  const char*name(void) const
+  {
+    return exp_name;
+  };
+  unsigned nb_slots(void) const
+  {
+    return exp_nbslots;
+  };
+  const char*slot_name(unsigned rk) const
+  {
+    return (rk < exp_nbslots)?exp_slotnames[rk]:nullptr;
+  };
+  const char*source(void) const
+  {
+    return exp_source;
+  };
+  Deftemplate*deftemplate(void) const
+  {
+    return exp_deftemplate;
+  };
+  bool wanted(void) const
+  {
+    return exp_wanted;
+  };
+  /// true when the lazy slots are left void in asserted facts
+  bool is_lazy(void) const;
+  void filter_template(void);
+  void build_template(Environment*env);
+  void resolve_template(Environment*env);
+  void dispose(void);
+  void put_integer(unsigned rk, long long num);
+  void put_symbol(unsigned rk, const char*str);
+  void put_string(unsigned rk, const char*str);
+  void put_boolean(unsigned rk, bool flag);
+  void put_identifier(unsigned rk, tree id, bool isstring);
+  void put_multifield(unsigned rk);
+  void put_lazy_slots(void*source);
+  Fact*assert_fact(void);
+};				// end class CLGCC_Fact_Exporter
+
+extern CLGCC_Fact_Exporter CLGCC_translation_unit_exporter;
+extern CLGCC_Fact_Exporter CLGCC_function_exporter;
+extern CLGCC_Fact_Exporter CLGCC_basic_block_exporter;
+extern CLGCC_Fact_Exporter CLGCC_statement_exporter;
+extern CLGCC_Fact_Exporter CLGCC_ssa_name_exporter;
+extern CLGCC_Fact_Exporter CLGCC_lto_exporter;
+extern CLGCC_Fact_Exporter CLGCC_diagnostic_exporter;
+
+/// null terminated
+extern CLGCC_Fact_Exporter*const CLGCC_all_exporters[];
+
+extern void CLGCC_mf_append_integer(long long num);
+extern void CLGCC_mf_append_float(double x);
+extern void CLGCC_mf_append_symbol(const char*str);
+extern void CLGCC_mf_append_string(const char*str);
+extern void CLGCC_mf_append_identifier(tree id);
+extern CLIPSLexeme*CLGCC_identifier_lexeme(tree id, bool isstring);
+extern void CLGCC_define_gimple_templates(void);
+extern void CLGCC_resolve_gimple_templates(void);
+extern void CLGCC_dispose_gimple_templates(void);
+extern bool CLGCC_export_all;
+extern void CLGCC_filter_gimple_templates(void);
+extern long CLGCC_export_function(function*fun);
+extern bool CLGCC_per_function;
+extern unsigned CLGCC_alpha_threads;
+extern bool CLGCC_lazy;
+extern void CLGCC_register_gimple_pass(const char*plugin_name);
+
+////////////////////////////////////////////////////////////////
+//// in clips-gcc-cache.cc
+extern std::vector<std::string> CLGCC_rulefiles;
+extern std::string CLGCC_cachedir;
+extern std::string CLGCC_rules_key(void);
+extern void CLGCC_load_rule_files(void);
+
+////////////////////////////////////////////////////////////////
+//// in clips-gcc-stats.cc, for -fplugin-arg-clipsgccplug-stats=<file>
+enum clgcc_phase_en
+{
+  CLGCC_PHASE_ENVIRONMENT,
+  CLGCC_PHASE_LOAD,
+  CLGCC_PHASE_EXPORT,
+  CLGCC_PHASE_RUN,
+  CLGCC_PHASE_TEARDOWN,
+  CLGCC_PHASE__LAST
+};
+
+/// adds the CPU time of its scope to some phase
+class CLGCC_phase_timer
+{
+  const enum clgcc_phase_en tim_phase;
+  const double tim_start;
+public:
+  CLGCC_phase_timer(enum clgcc_phase_en phase);
+  ~CLGCC_phase_timer();
+  CLGCC_phase_timer(const CLGCC_phase_timer&) = delete;
+};				// end class CLGCC_phase_timer
+
+extern std::string CLGCC_statsfile;
+extern double CLGCC_phase_time[CLGCC_PHASE__LAST];
+extern long long CLGCC_nb_fired;
+extern void CLGCC_stats_watch(void);
+extern void CLGCC_stats_sample(void);
+extern void CLGCC_stats_report(void);
+
+////////////////////////////////////////////////////////////////
+//// in clips-gcc-lto.cc, for -flto
+enum clgcc_lto_phase_en
+{
+  CLGCC_LTO_NONE,
+  CLGCC_LTO_COMPILE,
+  CLGCC_LTO_WPA,
+  CLGCC_LTO_LTRANS
+};
+extern enum clgcc_lto_phase_en CLGCC_lto_phase;
+extern std::string CLGCC_lto_dir;
+extern void CLGCC_detect_lto_phase(void);
+extern void CLGCC_lto_assert_phase(void);
+extern void CLGCC_lto_save_results(void);
+extern void CLGCC_lto_merge(void*gccdata, void*userdata);
+
+////////////////////////////////////////////////////////////////
+//// in clips-gcc-diagnostic.cc, for gcc-diagnostic facts
+extern void CLGCC_record_location(const expanded_location&xloc, location_t loc);
+extern void CLGCC_harvest_diagnostics(void);
+extern bool CLGCC_decode_diagnostic(const std::string&msg);
+extern void CLGCC_emit_diagnostics(void);
+
+////////////////////////////////////////////////////////////////
+//// in clips-gcc-client.cc, for the compile server mode
+extern int CLGCC_serverfd;
+extern std::string CLGCC_serverpath;
+extern void CLGCC_encode_lexeme(std::string&out, char kind, const char*str);
+extern bool CLGCC_connect_server(void);
+extern void CLGCC_server_send(const std::string&msg);
+extern long long CLGCC_server_run(void);
+extern void CLGCC_server_bye(void);
+
 #endif /*clips-gcc.hh */
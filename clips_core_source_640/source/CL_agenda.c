@@ -70,6 +70,7 @@
 #include "crstrtgy.h"
 #include "engine.h"
 #include "envrnmnt.h"
+#include "exprnops.h"
 #include "extnfunc.h"
 #include "memalloc.h"
 #include "moduldef.h"
@@ -85,6 +86,10 @@
 #include "sysdep.h"
 #include "watch.h"
 
+#if DEFGLOBAL_CONSTRUCT
+#include "globldef.h"
+#endif
+
 #include "agenda.h"
 
 /***************************************/
@@ -99,8 +104,32 @@ static struct salienceGroup *ReuseOrCreateSalienceGroup (Environment *,
 							 struct defruleModule
 							 *, int);
 static struct salienceGroup *FindSalienceGroup (struct defruleModule *, int);
+static struct salienceGroup *NextHigherSalienceGroup (struct salienceIndex *,
+						      size_t);
+static void IndexSalienceGroup (struct salienceIndex *, size_t,
+				struct salienceGroup *);
+static unsigned int LowestBit (unsigned long long);
 static void CL_RemoveActivationFromGroup (Environment *, Activation *,
 					  struct defruleModule *);
+static void Update_AgendaSaliences (Environment *, Defmodule *);
+static bool UpdateRuleSaliences (Environment *);
+static unsigned short SalienceDependency (struct expr *);
+static bool SalienceGlobalsChanged (Environment *, struct expr *,
+				    unsigned long long);
+static unsigned long long GlobalsChangeStamp (Environment *);
+
+/*******************************************************/
+/* The system functions which may appear in a dynamic  */
+/*   salience without making it volatile: their value  */
+/*   only depends on their arguments, and they have no */
+/*   side effect.                                      */
+/*******************************************************/
+
+static const char *PureSalienceFunctions[] = {
+  "+", "-", "*", "/", "div", "mod", "abs", "min", "max",
+  "integer", "float", "round", "eq", "neq", "=", "<>",
+  "<", ">", "<=", ">=", "and", "or", "not", NULL
+};
 
 /*************************************************/
 /* Initialize_Agenda: Initializes the activations */
@@ -184,6 +213,8 @@ CL_AddActivation (Environment * theEnv,
   newActivation->randomID = CL_genrand ();
   newActivation->prev = NULL;
   newActivation->next = NULL;
+  newActivation->indexLevels = 0;
+  newActivation->indexLinks = NULL;
 
   CL_AgendaData (theEnv)->NumberOfActivations++;
 
@@ -223,35 +254,72 @@ CL_AddActivation (Environment * theEnv,
 		      theGroup);
 }
 
-/*******************************/
-/* ReuseOrCreateSalienceGroup: */
-/*******************************/
+/****************************************************************/
+/* ReuseOrCreateSalienceGroup: Returns the salience group of an */
+/*   agenda for a salience, creating it if needed. The group is */
+/*   found through the salience index of the agenda, which also */
+/*   gives the group of next higher salience after which a new  */
+/*   group is linked.                                           */
+/****************************************************************/
 static struct salienceGroup *
 ReuseOrCreateSalienceGroup (Environment * theEnv,
 			    struct defruleModule *theRuleModule, int salience)
 {
   struct salienceGroup *theGroup, *lastGroup, *newGroup;
+  struct salienceIndex *theIndex;
+  size_t position;
+  unsigned short i;
 
-  for (lastGroup = NULL, theGroup = theRuleModule->groupings;
-       theGroup != NULL; lastGroup = theGroup, theGroup = theGroup->next)
+  theGroup = FindSalienceGroup (theRuleModule, salience);
+  if (theGroup != NULL)
     {
-      if (theGroup->salience == salience)
-	{
-	  return (theGroup);
-	}
+      return theGroup;
+    }
 
-      if (theGroup->salience < salience)
-	{
-	  break;
-	}
+   /*==============================================*/
+  /* The index is allocated with the first group. */
+   /*==============================================*/
+
+  theIndex = theRuleModule->salienceIndex;
+  if (theIndex == NULL)
+    {
+      theIndex = (struct salienceIndex *)
+	get_mem (theEnv, sizeof (struct salienceIndex));
+      memset (theIndex, 0, sizeof (struct salienceIndex));
+      theRuleModule->salienceIndex = theIndex;
     }
 
+  position = (size_t) (salience - MIN_DEFRULE_SALIENCE);
+  if (theIndex->chunks[position / SALIENCE_INDEX_CHUNK] == NULL)
+    {
+      theIndex->chunks[position / SALIENCE_INDEX_CHUNK] =
+	(struct salienceGroup **)
+	get_mem (theEnv,
+		 sizeof (struct salienceGroup *) * SALIENCE_INDEX_CHUNK);
+      memset (theIndex->chunks[position / SALIENCE_INDEX_CHUNK], 0,
+	      sizeof (struct salienceGroup *) * SALIENCE_INDEX_CHUNK);
+    }
+
+  lastGroup = NextHigherSalienceGroup (theIndex, position);
+
   newGroup = get_struct (theEnv, salienceGroup);
   newGroup->salience = salience;
   newGroup->first = NULL;
   newGroup->last = NULL;
-  newGroup->next = theGroup;
   newGroup->prev = lastGroup;
+  if (lastGroup == NULL)
+    {
+      newGroup->next = theRuleModule->groupings;
+    }
+  else
+    {
+      newGroup->next = lastGroup->next;
+    }
+  newGroup->indexLevels = 0;
+  for (i = 0; i < ACTIVATION_INDEX_LEVELS; i++)
+    {
+      newGroup->indexHead[i] = NULL;
+    }
 
   if (newGroup->next != NULL)
     {
@@ -268,32 +336,167 @@ ReuseOrCreateSalienceGroup (Environment * theEnv,
       theRuleModule->groupings = newGroup;
     }
 
+  IndexSalienceGroup (theIndex, position, newGroup);
+
   return newGroup;
 }
 
-/**********************/
-/* FindSalienceGroup: */
-/**********************/
+/*************************************************************/
+/* FindSalienceGroup: Returns the salience group of an       */
+/*   agenda for a salience, or NULL if the agenda has none.  */
+/*************************************************************/
 static struct salienceGroup *
 FindSalienceGroup (struct defruleModule *theRuleModule, int salience)
 {
-  struct salienceGroup *theGroup;
+  struct salienceIndex *theIndex;
+  size_t position;
+
+  theIndex = theRuleModule->salienceIndex;
+  if ((theIndex == NULL) ||
+      (salience < MIN_DEFRULE_SALIENCE) || (salience > MAX_DEFRULE_SALIENCE))
+    {
+      return NULL;
+    }
+
+  position = (size_t) (salience - MIN_DEFRULE_SALIENCE);
+  if (theIndex->chunks[position / SALIENCE_INDEX_CHUNK] == NULL)
+    {
+      return NULL;
+    }
+
+  return theIndex->chunks[position / SALIENCE_INDEX_CHUNK]
+    [position % SALIENCE_INDEX_CHUNK];
+}
+
+/**************************************************************/
+/* NextHigherSalienceGroup: Returns the salience group of the */
+/*   lowest salience above a position of a salience index, or */
+/*   NULL if there is none. The summary bitmap skips the      */
+/*   words of the bitmap of saliences which are empty.        */
+/**************************************************************/
+static struct salienceGroup *
+NextHigherSalienceGroup (struct salienceIndex *theIndex, size_t position)
+{
+  size_t word;
+  unsigned long long bits, summaryBits;
+
+  position++;
+  if (position >= SALIENCE_RANGE)
+    {
+      return NULL;
+    }
+
+  word = position / 64;
+  bits = theIndex->levels[word] & (~0ULL << (position % 64));
+
+  while (bits == 0)
+    {
+      word++;
+      if (word >= SALIENCE_INDEX_WORDS)
+	{
+	  return NULL;
+	}
+
+      summaryBits = theIndex->summary[word / 64] & (~0ULL << (word % 64));
+      if (summaryBits == 0)
+	{
+	  word = ((word / 64) * 64) + 63;
+	  continue;
+	}
+
+      word = ((word / 64) * 64) + LowestBit (summaryBits);
+      bits = theIndex->levels[word];
+    }
+
+  position = (word * 64) + LowestBit (bits);
+
+  return theIndex->chunks[position / SALIENCE_INDEX_CHUNK]
+    [position % SALIENCE_INDEX_CHUNK];
+}
+
+/**************************************************************/
+/* IndexSalienceGroup: Stores a salience group at a position  */
+/*   of a salience index, or removes the group stored there   */
+/*   if the group is NULL, and updates the bitmaps.           */
+/**************************************************************/
+static void
+IndexSalienceGroup (struct salienceIndex *theIndex,
+		    size_t position, struct salienceGroup *theGroup)
+{
+  size_t word = position / 64;
+
+  theIndex->chunks[position / SALIENCE_INDEX_CHUNK]
+    [position % SALIENCE_INDEX_CHUNK] = theGroup;
 
-  for (theGroup = theRuleModule->groupings;
-       theGroup != NULL; theGroup = theGroup->next)
+  if (theGroup != NULL)
+    {
+      theIndex->levels[word] |= (1ULL << (position % 64));
+      theIndex->summary[word / 64] |= (1ULL << (word % 64));
+    }
+  else
     {
-      if (theGroup->salience == salience)
+      theIndex->levels[word] &= ~(1ULL << (position % 64));
+      if (theIndex->levels[word] == 0)
 	{
-	  return (theGroup);
+	  theIndex->summary[word / 64] &= ~(1ULL << (word % 64));
 	}
+    }
+}
 
-      if (theGroup->salience < salience)
+/*************************************************************/
+/* CL_ReturnSalienceIndex: Returns the salience index of the */
+/*   agenda of a defrule module to the memory manager. The   */
+/*   index only lives while the agenda has salience groups,  */
+/*   since the module can be returned before the last of     */
+/*   its activations when the environment is cleared.        */
+/*************************************************************/
+void
+CL_ReturnSalienceIndex (Environment * theEnv,
+			struct defruleModule *theRuleModule)
+{
+  struct salienceIndex *theIndex;
+  size_t i;
+
+  theIndex = theRuleModule->salienceIndex;
+  if (theIndex == NULL)
+    return;
+
+  for (i = 0; i < SALIENCE_INDEX_CHUNKS; i++)
+    {
+      if (theIndex->chunks[i] != NULL)
 	{
-	  break;
+	  rtn_mem (theEnv,
+		   sizeof (struct salienceGroup *) * SALIENCE_INDEX_CHUNK,
+		   theIndex->chunks[i]);
 	}
     }
 
-  return NULL;
+  rtn_mem (theEnv, sizeof (struct salienceIndex), theIndex);
+  theRuleModule->salienceIndex = NULL;
+}
+
+/*********************************************************/
+/* LowestBit: Returns the position of the lowest bit set */
+/*   in a non-zero word.                                 */
+/*********************************************************/
+static unsigned int
+LowestBit (unsigned long long bits)
+{
+  unsigned int position = 0;
+
+  while ((bits & 0xFF) == 0)
+    {
+      bits >>= 8;
+      position += 8;
+    }
+
+  while ((bits & 0x1) == 0)
+    {
+      bits >>= 1;
+      position++;
+    }
+
+  return position;
 }
 
 /***************************************************************/
@@ -434,6 +637,8 @@ CL_ActivationSetSalience (Activation * actPtr, int value)
 
   temp = actPtr->salience;
   actPtr->salience = value;
+  ((struct defruleModule *) actPtr->theRule->header.whichModule)->
+    reorderNeeded = true;
   return temp;
 }
 
@@ -491,6 +696,15 @@ CL_MoveActivationToTop (Environment * theEnv, Activation * theActivation)
   if (theActivation == theModuleItem->agenda)
     return false;
 
+   /*==============================================*/
+  /* The activation is no longer placed according */
+  /* to the strategy among its salience group.    */
+   /*==============================================*/
+
+  CL_UnindexActivation (theEnv, theActivation,
+			FindSalienceGroup (theModuleItem,
+					   theActivation->salience));
+
    /*=================================================*/
   /* Update the pointers of the activation preceding */
   /* and following the activation being moved.       */
@@ -511,6 +725,7 @@ CL_MoveActivationToTop (Environment * theEnv, Activation * theActivation)
   theModuleItem->agenda->prev = theActivation;
   theActivation->prev = NULL;
   theModuleItem->agenda = theActivation;
+  theModuleItem->reorderNeeded = true;
 
    /*=============================*/
   /* Mark the agenda as changed. */
@@ -558,6 +773,8 @@ CL_DeleteAllActivations (Defmodule * theModule)
       rtn_struct (theEnv, salienceGroup, theGroup);
       theGroup = tempGroup;
     }
+  Get_DefruleModuleItem (theEnv, NULL)->groupings = NULL;
+  CL_ReturnSalienceIndex (theEnv, Get_DefruleModuleItem (theEnv, NULL));
 }
 
 /*******************************************************/
@@ -747,6 +964,7 @@ CL_RemoveActivation (Environment * theEnv,
 
   CL_AgendaData (theEnv)->NumberOfActivations--;
 
+  CL_ReturnActivationIndex (theEnv, theActivation);
   rtn_struct (theEnv, activation, theActivation);
 }
 
@@ -764,6 +982,8 @@ CL_RemoveActivationFromGroup (Environment * theEnv,
   if (theGroup == NULL)
     return;
 
+  CL_UnindexActivation (theEnv, theActivation, theGroup);
+
   if (theActivation == theGroup->first)
     {
       /*====================================================*/
@@ -787,7 +1007,15 @@ CL_RemoveActivationFromGroup (Environment * theEnv,
 	      theGroup->next->prev = theGroup->prev;
 	    }
 
+	  IndexSalienceGroup (theRuleModule->salienceIndex,
+			      (size_t) (theGroup->salience -
+					MIN_DEFRULE_SALIENCE), NULL);
 	  rtn_struct (theEnv, salienceGroup, theGroup);
+
+	  if (theRuleModule->groupings == NULL)
+	    {
+	      CL_ReturnSalienceIndex (theEnv, theRuleModule);
+	    }
 	}
 
       /*======================================================*/
@@ -859,6 +1087,8 @@ CL_RemoveAllActivations (Environment * theEnv)
       rtn_struct (theEnv, salienceGroup, theGroup);
       theGroup = tempGroup;
     }
+  Get_DefruleModuleItem (theEnv, NULL)->groupings = NULL;
+  CL_ReturnSalienceIndex (theEnv, Get_DefruleModuleItem (theEnv, NULL));
 }
 
 /**********************************************/
@@ -931,6 +1161,8 @@ Reorder_Agenda (Defmodule * theModule)
     }
 
   theModuleItem->groupings = NULL;
+  CL_ReturnSalienceIndex (theEnv, theModuleItem);
+  theModuleItem->reorderNeeded = false;
 
    /*=========================================*/
   /* Reorder the activations by placing them */
@@ -942,6 +1174,7 @@ Reorder_Agenda (Defmodule * theModule)
       tempPtr = theActivation->next;
       theActivation->next = NULL;
       theActivation->prev = NULL;
+      CL_ReturnActivationIndex (theEnv, theActivation);
       theGroup =
 	ReuseOrCreateSalienceGroup (theEnv, theModuleItem,
 				    theActivation->salience);
@@ -1111,6 +1344,317 @@ CL_RefreshAll_Agendas (Environment * theEnv)
     }
 }
 
+/****************************************************/
+/* CL_UpdateAll_AgendaSaliences: Brings the agendas */
+/*   of all modules up to date with the dynamic     */
+/*   saliences of their rules. Called after each    */
+/*   rule firing when saliences are evaluated every */
+/*   cycle.                                         */
+/****************************************************/
+void
+CL_UpdateAll_AgendaSaliences (Environment * theEnv)
+{
+  Defmodule *theModule;
+
+  for (theModule = CL_GetNextDefmodule (theEnv, NULL);
+       theModule != NULL; theModule = CL_GetNextDefmodule (theEnv, theModule))
+    {
+      Update_AgendaSaliences (theEnv, theModule);
+    }
+}
+
+/*****************************************************************/
+/* Update_AgendaSaliences: Has the same effect on the agenda of  */
+/*   a module as CL_Refresh_Agenda, without reevaluating the     */
+/*   salience of each activation nor reordering the whole        */
+/*   agenda. The salience of a rule reading only defglobals      */
+/*   through pure functions is evaluated once, and only when one */
+/*   of these defglobals changed since its last evaluation.      */
+/*   Other dynamic saliences are still evaluated for each        */
+/*   activation. Then only the activations whose salience        */
+/*   changed are moved: since the activations of a salience      */
+/*   group are ordered by the strategy alone, this gives the     */
+/*   same agenda as reordering it.                               */
+/*****************************************************************/
+static void
+Update_AgendaSaliences (Environment * theEnv, Defmodule * theModule)
+{
+  struct defruleModule *theModuleItem;
+  Activation *theActivation, *nextActivation;
+  Activation *movedActivations = NULL;
+  struct salienceGroup *theGroup;
+  int salience;
+
+   /*=====================================*/
+  /* If embedded, clear the error flags. */
+   /*=====================================*/
+
+  if (CL_EvaluationData (theEnv)->CurrentExpression == NULL)
+    {
+      CL_ResetErrorFlags (theEnv);
+    }
+
+  theModuleItem = Get_DefruleModuleItem (theEnv, theModule);
+  if (theModuleItem->agenda == NULL)
+    {
+      return;
+    }
+
+   /*=================================================*/
+  /* An activation moved to the top of the agenda or */
+  /* given a salience by the C API is only put back  */
+  /* in its place by reordering the whole agenda.    */
+   /*=================================================*/
+
+  if (theModuleItem->reorderNeeded)
+    {
+      CL_Refresh_Agenda (theModule);
+      return;
+    }
+
+  CL_SaveCurrentModule (theEnv);
+  CL_SetCurrentModule (theEnv, theModule);
+
+   /*==========================================*/
+  /* If no salience was reevaluated, then the */
+  /* activations are already in place.        */
+   /*==========================================*/
+
+  if (!UpdateRuleSaliences (theEnv))
+    {
+      CL_RestoreCurrentModule (theEnv);
+      return;
+    }
+
+   /*=================================================*/
+  /* Detach the activations whose salience changed.  */
+  /* The group of an activation is found through its */
+  /* old salience, so it is only changed afterwards. */
+   /*=================================================*/
+
+  for (theActivation = theModuleItem->agenda;
+       theActivation != NULL; theActivation = nextActivation)
+    {
+      nextActivation = theActivation->next;
+
+      if (theActivation->theRule->dynamicSalience == NULL)
+	{
+	  continue;
+	}
+
+      if (theActivation->theRule->salienceDependency == SALIENCE_VOLATILE)
+	{
+	  salience = CL_EvaluateSalience (theEnv, theActivation->theRule);
+	}
+      else
+	{
+	  salience = theActivation->theRule->salience;
+	}
+
+      if (salience == theActivation->salience)
+	{
+	  continue;
+	}
+
+      CL_DetachActivation (theEnv, theActivation);
+      CL_ReturnActivationIndex (theEnv, theActivation);
+      theActivation->salience = salience;
+      theActivation->next = movedActivations;
+      movedActivations = theActivation;
+    }
+
+   /*==================================================*/
+  /* Place them back according to their new salience. */
+   /*==================================================*/
+
+  while (movedActivations != NULL)
+    {
+      theActivation = movedActivations;
+      movedActivations = theActivation->next;
+      theActivation->next = NULL;
+      theGroup =
+	ReuseOrCreateSalienceGroup (theEnv, theModuleItem,
+				    theActivation->salience);
+      CL_PlaceActivation (theEnv, &(theModuleItem->agenda), theActivation,
+			  theGroup);
+    }
+
+  CL_RestoreCurrentModule (theEnv);
+}
+
+/*****************************************************************/
+/* UpdateRuleSaliences: Reevaluates the dynamic saliences of the */
+/*   rules of the current module which read defglobals changed   */
+/*   since their last evaluation. The dynamic salience of each   */
+/*   rule is analyzed the first time. Returns true if a salience */
+/*   was reevaluated or if a rule has a volatile salience, which */
+/*   is evaluated for each of its activations.                   */
+/*****************************************************************/
+static bool
+UpdateRuleSaliences (Environment * theEnv)
+{
+  Defrule *theRule, *theDisjunct;
+  bool stale, reevaluated = false;
+
+  for (theRule = CL_GetNextDefrule (theEnv, NULL);
+       theRule != NULL; theRule = CL_GetNextDefrule (theEnv, theRule))
+    {
+      for (theDisjunct = theRule;
+	   theDisjunct != NULL; theDisjunct = theDisjunct->disjunct)
+	{
+	  if (theDisjunct->dynamicSalience == NULL)
+	    {
+	      continue;
+	    }
+
+	  if (theDisjunct->salienceDependency == SALIENCE_UNANALYZED)
+	    {
+	      theDisjunct->salienceDependency =
+		SalienceDependency (theDisjunct->dynamicSalience);
+	      stale = true;
+	    }
+	  else
+	    {
+	      stale =
+		SalienceGlobalsChanged (theEnv, theDisjunct->dynamicSalience,
+					theDisjunct->salienceStamp);
+	    }
+
+	  if (theDisjunct->salienceDependency == SALIENCE_VOLATILE)
+	    {
+	      reevaluated = true;
+	    }
+	  else if (stale)
+	    {
+	      theDisjunct->salienceStamp = GlobalsChangeStamp (theEnv);
+	      CL_EvaluateSalience (theEnv, theDisjunct);
+	      reevaluated = true;
+	    }
+	}
+    }
+
+  return reevaluated;
+}
+
+/*****************************************************************/
+/* SalienceDependency: Classifies a dynamic salience expression. */
+/*   SALIENCE_READS_GLOBALS if it is made of constants and       */
+/*   defglobals combined by pure functions, so that its value    */
+/*   only changes with these defglobals, otherwise               */
+/*   SALIENCE_VOLATILE.                                          */
+/*****************************************************************/
+static unsigned short
+SalienceDependency (struct expr *theExpression)
+{
+  const char *functionName;
+  int i;
+
+  for (; theExpression != NULL; theExpression = theExpression->nextArg)
+    {
+      if (CL_ConstantType (theExpression->type))
+	{
+	  continue;
+	}
+
+#if DEFGLOBAL_CONSTRUCT
+      if ((theExpression->type == GBL_VARIABLE) ||
+	  (theExpression->type == MF_GBL_VARIABLE) ||
+	  (theExpression->type == DEFGLOBAL_PTR))
+	{
+	  continue;
+	}
+#endif
+
+      if (theExpression->type != FCALL)
+	{
+	  return SALIENCE_VOLATILE;
+	}
+
+      functionName = ExpressionFunctionCallName (theExpression)->contents;
+      for (i = 0; PureSalienceFunctions[i] != NULL; i++)
+	{
+	  if (strcmp (functionName, PureSalienceFunctions[i]) == 0)
+	    {
+	      break;
+	    }
+	}
+
+      if ((PureSalienceFunctions[i] == NULL) ||
+	  (SalienceDependency (theExpression->argList) == SALIENCE_VOLATILE))
+	{
+	  return SALIENCE_VOLATILE;
+	}
+    }
+
+  return SALIENCE_READS_GLOBALS;
+}
+
+/****************************************************************/
+/* SalienceGlobalsChanged: Returns true if a defglobal read by  */
+/*   an expression was changed after the specified stamp. A     */
+/*   global variable is looked up by name from the current      */
+/*   module as when the expression is evaluated: if it is no    */
+/*   longer found, the expression is considered changed, so its */
+/*   evaluation reports the error.                              */
+/****************************************************************/
+static bool
+SalienceGlobalsChanged (Environment * theEnv,
+			struct expr *theExpression, unsigned long long stamp)
+{
+#if DEFGLOBAL_CONSTRUCT
+  Defglobal *theGlobal;
+  unsigned int count;
+#endif
+
+  for (; theExpression != NULL; theExpression = theExpression->nextArg)
+    {
+#if DEFGLOBAL_CONSTRUCT
+      if ((theExpression->type == GBL_VARIABLE) ||
+	  (theExpression->type == MF_GBL_VARIABLE))
+	{
+	  theGlobal = (Defglobal *)
+	    CL_FindImportedConstruct (theEnv, "defglobal", NULL,
+				      theExpression->lexemeValue->contents,
+				      &count, true, NULL);
+	  if ((theGlobal == NULL) || (count > 1) ||
+	      (theGlobal->changeStamp > stamp))
+	    {
+	      return true;
+	    }
+	}
+      else if ((theExpression->type == DEFGLOBAL_PTR) &&
+	       (((Defglobal *) theExpression->value)->changeStamp > stamp))
+	{
+	  return true;
+	}
+#endif
+
+      if (SalienceGlobalsChanged (theEnv, theExpression->argList, stamp))
+	{
+	  return true;
+	}
+    }
+
+  return false;
+}
+
+/*******************************************************/
+/* GlobalsChangeStamp: Returns the stamp of the latest */
+/*   change made to the value of a defglobal.          */
+/*******************************************************/
+static unsigned long long
+GlobalsChangeStamp (Environment * theEnv)
+{
+#if DEFGLOBAL_CONSTRUCT
+  return DefglobalData (theEnv)->ChangeStamp;
+#else
+#if MAC_XCD
+#pragma unused(theEnv)
+#endif
+  return 0;
+#endif
+}
+
 /*************************************/
 /* CL_Refresh_Agenda: C access routine   */
 /*   for the refresh-agenda command. */
@@ -80,16 +80,10 @@ static Activation *PlaceDepthActivation (Activation *,
 					 struct salienceGroup *);
 static Activation *PlaceBreadthActivation (Activation *,
 					   struct salienceGroup *);
-static Activation *PlaceLEXActivation (Environment *, Activation *,
-				       struct salienceGroup *);
-static Activation *PlaceMEAActivation (Environment *, Activation *,
-				       struct salienceGroup *);
-static Activation *PlaceComplexityActivation (Activation *,
-					      struct salienceGroup *);
-static Activation *PlaceSimplicityActivation (Activation *,
-					      struct salienceGroup *);
-static Activation *PlaceRandomActivation (Activation *,
-					  struct salienceGroup *);
+static Activation *PlaceIndexedActivation (Environment *, Activation *,
+					   struct salienceGroup *);
+static bool ActivationPrecedes (Environment *, Activation *, Activation *);
+static unsigned short ActivationIndexLevels (unsigned long long);
 static int ComparePartial_Matches (Environment *, Activation *, Activation *);
 static const char *CL_GetStrategyName (StrategyType);
 static unsigned long long *SortPartialMatch (Environment *,
@@ -133,31 +127,25 @@ CL_PlaceActivation (Environment * theEnv,
 	  break;
 
 	case LEX_STRATEGY:
-	  placeAfter = PlaceLEXActivation (theEnv, newActivation, theGroup);
-	  break;
-
 	case MEA_STRATEGY:
-	  placeAfter = PlaceMEAActivation (theEnv, newActivation, theGroup);
-	  break;
-
 	case COMPLEXITY_STRATEGY:
-	  placeAfter = PlaceComplexityActivation (newActivation, theGroup);
-	  break;
-
 	case SIMPLICITY_STRATEGY:
-	  placeAfter = PlaceSimplicityActivation (newActivation, theGroup);
-	  break;
-
 	case RANDOM_STRATEGY:
-	  placeAfter = PlaceRandomActivation (newActivation, theGroup);
+	  placeAfter =
+	    PlaceIndexedActivation (theEnv, newActivation, theGroup);
 	  break;
 	}
     }
-  else
+  else if ((CL_AgendaData (theEnv)->Strategy == DEPTH_STRATEGY) ||
+	   (CL_AgendaData (theEnv)->Strategy == BREADTH_STRATEGY))
     {
       theGroup->first = newActivation;
       theGroup->last = newActivation;
     }
+  else
+    {
+      PlaceIndexedActivation (theEnv, newActivation, theGroup);
+    }
 
    /*==============================================================*/
   /* Place the activation at the appropriate place in the agenda. */
@@ -358,104 +346,145 @@ PlaceBreadthActivation (Activation * newActivation,
 }
 
 /*******************************************************************/
-/* PlaceLEXActivation: Dete_rmines the location in the agenda       */
-/*    where a new activation should be placed for the lex          */
-/*    strategy. Returns a pointer to the activation after which    */
-/*    the new activation should be placed (or NULL if the          */
+/* PlaceIndexedActivation: Finds the location in the agenda where  */
+/*    a new activation should be placed for the lex, mea,          */
+/*    complexity, simplicity, and random strategies. Rather than   */
+/*    scanning the activations of the salience group, the search   */
+/*    goes through a skip list, so that placing an activation      */
+/*    takes a logarithmic number of comparisons. The bottom level  */
+/*    of the skip list is the part of the agenda holding the       */
+/*    group, the levels above link a quarter of the activations of */
+/*    the level below. The activation is then linked into the      */
+/*    levels above. Returns a pointer to the activation after      */
+/*    which the new activation should be placed (or NULL if the    */
 /*    activation should be placed at the beginning of the agenda). */
 /*******************************************************************/
 static Activation *
-PlaceLEXActivation (Environment * theEnv,
-		    Activation * newActivation,
-		    struct salienceGroup *theGroup)
+PlaceIndexedActivation (Environment * theEnv,
+			Activation * newActivation,
+			struct salienceGroup *theGroup)
 {
-  unsigned long long timetag;
-  Activation *lastAct, *actPtr;
-  int flag;
+  Activation *update[ACTIVATION_INDEX_LEVELS];
+  Activation *lastAct, *actPtr, *nextPtr;
+  unsigned short level, levels;
+  bool frontPlacement;
 
-   /*============================================*/
-  /* Set up initial info_rmation for the search. */
-   /*============================================*/
+   /*================================================*/
+  /* Find at each level of the skip list the last   */
+  /* activation which stays before the new one.     */
+  /* Since a new activation often goes first in its */
+  /* group, the first activation is checked before. */
+   /*================================================*/
 
-  timetag = newActivation->timetag;
-  if (theGroup->prev == NULL)
-    {
-      lastAct = NULL;
-    }
-  else
+  actPtr = NULL;
+  frontPlacement = ((theGroup->first == NULL) ||
+		    (!ActivationPrecedes (theEnv, theGroup->first,
+					  newActivation)));
+
+  for (level = ACTIVATION_INDEX_LEVELS; level > 0; level--)
     {
-      lastAct = theGroup->prev->last;
+      if (frontPlacement || (level > theGroup->indexLevels))
+	{
+	  update[level - 1] = NULL;
+	  continue;
+	}
+
+      if (actPtr == NULL)
+	{
+	  nextPtr = theGroup->indexHead[level - 1];
+	}
+      else
+	{
+	  nextPtr = actPtr->indexLinks[level - 1].next;
+	}
+
+      while ((nextPtr != NULL) &&
+	     ActivationPrecedes (theEnv, nextPtr, newActivation))
+	{
+	  actPtr = nextPtr;
+	  nextPtr = actPtr->indexLinks[level - 1].next;
+	}
+
+      update[level - 1] = actPtr;
     }
 
-   /*================================================*/
-  /* Look first at the very end of the group to see */
-  /* if the activation should be placed there.      */
-   /*================================================*/
+   /*=========================================*/
+  /* The search ends on the agenda, from the */
+  /* activation found on the level above.    */
+   /*=========================================*/
 
-  actPtr = theGroup->last;
-  if (actPtr != NULL)
+  if (!frontPlacement)
     {
-      flag = ComparePartial_Matches (theEnv, actPtr, newActivation);
-
-      if ((flag == LESS_THAN) ||
-	  ((flag == EQUAL) && (timetag > actPtr->timetag)))
+      if (actPtr == NULL)
 	{
-	  theGroup->last = newActivation;
+	  actPtr = theGroup->first;
+	}
 
-	  return actPtr;
+      while ((actPtr != theGroup->last) && (actPtr->next != NULL) &&
+	     ActivationPrecedes (theEnv, actPtr->next, newActivation))
+	{
+	  actPtr = actPtr->next;
 	}
     }
 
-   /*=========================================================*/
-  /* Find the insertion point in the agenda. The activation  */
-  /* is placed before activations of lower salience and      */
-  /* after activations of higher salience. Among activations */
-  /* of equal salience, the OPS5 lex strategy is used for    */
-  /* dete_rmining placement.                                  */
-   /*=========================================================*/
+   /*===========================================*/
+  /* Link the activation into as many levels   */
+  /* above the agenda as its timetag gives it. */
+   /*===========================================*/
 
-  actPtr = theGroup->first;
-  while (actPtr != NULL)
+  levels = ActivationIndexLevels (newActivation->timetag);
+  if (levels > 0)
     {
-      flag = ComparePartial_Matches (theEnv, actPtr, newActivation);
+      newActivation->indexLevels = levels;
+      newActivation->indexLinks = (struct activationLink *)
+	get_mem (theEnv, sizeof (struct activationLink) * levels);
+    }
 
-      if (flag == LESS_THAN)
+  for (level = 0; level < levels; level++)
+    {
+      newActivation->indexLinks[level].prev = update[level];
+      if (update[level] == NULL)
 	{
-	  lastAct = actPtr;
-	  if (actPtr == theGroup->last)
-	    {
-	      break;
-	    }
-	  else
-	    {
-	      actPtr = actPtr->next;
-	    }
+	  nextPtr = theGroup->indexHead[level];
+	  theGroup->indexHead[level] = newActivation;
 	}
-      else if (flag == GREATER_THAN)
+      else
 	{
-	  break;
+	  nextPtr = update[level]->indexLinks[level].next;
+	  update[level]->indexLinks[level].next = newActivation;
 	}
-      else			/* flag == EQUAL */
+
+      newActivation->indexLinks[level].next = nextPtr;
+      if (nextPtr != NULL)
 	{
-	  if (timetag > actPtr->timetag)
-	    {
-	      lastAct = actPtr;
-	      if (actPtr == theGroup->last)
-		{
-		  break;
-		}
-	      else
-		{
-		  actPtr = actPtr->next;
-		}
-	    }
-	  else
-	    {
-	      break;
-	    }
+	  nextPtr->indexLinks[level].prev = newActivation;
 	}
     }
 
+  if (levels > theGroup->indexLevels)
+    {
+      theGroup->indexLevels = levels;
+    }
+
+   /*=====================================================*/
+  /* The activation is placed after the activation found */
+  /* in its group, or else after the activations of      */
+  /* higher salience.                                    */
+   /*=====================================================*/
+
+  if (actPtr != NULL)
+    {
+      lastAct = actPtr;
+    }
+  else if (theGroup->prev == NULL)
+    {
+      lastAct = NULL;
+    }
+  else
+    {
+      lastAct = theGroup->prev->last;
+    }
+
    /*========================================*/
   /* Update the salience group info_rmation. */
    /*========================================*/
@@ -478,79 +507,41 @@ PlaceLEXActivation (Environment * theEnv,
   return lastAct;
 }
 
-/*******************************************************************/
-/* PlaceMEAActivation: Dete_rmines the location in the agenda       */
-/*    where a new activation should be placed for the mea          */
-/*    strategy. Returns a pointer to the activation after which    */
-/*    the new activation should be placed (or NULL if the          */
-/*    activation should be placed at the beginning of the agenda). */
-/*******************************************************************/
-static Activation *
-PlaceMEAActivation (Environment * theEnv,
-		    Activation * newActivation,
-		    struct salienceGroup *theGroup)
+/*****************************************************************/
+/* ActivationPrecedes: Returns true if an activation of a        */
+/*   salience group stays before a new activation of the group   */
+/*   for the current strategy. For the lex and mea strategies,   */
+/*   the OPS5 comparisons of the partial matches are used, for   */
+/*   the complexity and simplicity strategies the complexity of  */
+/*   the rules, and for the random strategy the random numbers   */
+/*   of the activations. Activations comparing equal are placed  */
+/*   in the order of their timetags.                             */
+/*****************************************************************/
+static bool
+ActivationPrecedes (Environment * theEnv,
+		    Activation * actPtr, Activation * newActivation)
 {
-  unsigned long long timetag;
-  Activation *lastAct, *actPtr;
   int flag;
   unsigned long long cWhoset = 0, oWhoset = 0;
-  bool cSet, oSet;
-
-   /*============================================*/
-  /* Set up initial info_rmation for the search. */
-   /*============================================*/
 
-  timetag = newActivation->timetag;
-  if (theGroup->prev == NULL)
+  switch (CL_AgendaData (theEnv)->Strategy)
     {
-      lastAct = NULL;
-    }
-  else
-    {
-      lastAct = theGroup->prev->last;
-    }
-
-   /*================================================*/
-  /* Look first at the very end of the group to see */
-  /* if the activation should be placed there.      */
-   /*================================================*/
+    case LEX_STRATEGY:
+      flag = ComparePartial_Matches (theEnv, actPtr, newActivation);
+      break;
 
-  actPtr = theGroup->last;
-  if (actPtr != NULL)
-    {
+    case MEA_STRATEGY:
       if (GetMatchingItem (newActivation, 0) != NULL)
 	{
 	  cWhoset = GetMatchingItem (newActivation, 0)->timeTag;
-	  cSet = true;
-	}
-      else
-	{
-	  cSet = false;
 	}
 
       if (GetMatchingItem (actPtr, 0) != NULL)
 	{
 	  oWhoset = GetMatchingItem (actPtr, 0)->timeTag;
-	  oSet = true;
-	}
-      else
-	{
-	  oSet = false;
 	}
 
-      if ((cSet == false) && (oSet == false))
-	{
-	  flag = ComparePartial_Matches (theEnv, actPtr, newActivation);
-	}
-      else if ((cSet == true) && (oSet == false))
-	{
-	  flag = GREATER_THAN;
-	}
-      else if ((cSet == false) && (oSet == true))
-	{
-	  flag = LESS_THAN;
-	}
-      else if (oWhoset < cWhoset)
+      if (oWhoset < cWhoset)
 	{
 	  flag = GREATER_THAN;
 	}
@@ -562,406 +553,158 @@ PlaceMEAActivation (Environment * theEnv,
 	{
 	  flag = ComparePartial_Matches (theEnv, actPtr, newActivation);
 	}
+      break;
 
-      if ((flag == LESS_THAN) ||
-	  ((flag == EQUAL) && (timetag > actPtr->timetag)))
+    case COMPLEXITY_STRATEGY:
+      if (newActivation->theRule->complexity < actPtr->theRule->complexity)
 	{
-	  theGroup->last = newActivation;
-
-	  return actPtr;
+	  flag = LESS_THAN;
 	}
-    }
-
-   /*=========================================================*/
-  /* Find the insertion point in the agenda. The activation  */
-  /* is placed before activations of lower salience and      */
-  /* after activations of higher salience. Among activations */
-  /* of equal salience, the OPS5 mea strategy is used for    */
-  /* dete_rmining placement.                                  */
-   /*=========================================================*/
-
-  actPtr = theGroup->first;
-  while (actPtr != NULL)
-    {
-      cWhoset = 0;
-      oWhoset = 0;
-      if (GetMatchingItem (newActivation, 0) != NULL)
+      else if (newActivation->theRule->complexity >
+	       actPtr->theRule->complexity)
 	{
-	  cWhoset = GetMatchingItem (newActivation, 0)->timeTag;
+	  flag = GREATER_THAN;
 	}
-
-      if (GetMatchingItem (actPtr, 0) != NULL)
+      else
 	{
-	  oWhoset = GetMatchingItem (actPtr, 0)->timeTag;
+	  flag = EQUAL;
 	}
+      break;
 
-      if (oWhoset < cWhoset)
+    case SIMPLICITY_STRATEGY:
+      if (newActivation->theRule->complexity > actPtr->theRule->complexity)
 	{
-	  if (cWhoset > 0)
-	    flag = GREATER_THAN;
-	  else
-	    flag = LESS_THAN;
+	  flag = LESS_THAN;
 	}
-      else if (oWhoset > cWhoset)
+      else if (newActivation->theRule->complexity <
+	       actPtr->theRule->complexity)
 	{
-	  if (oWhoset > 0)
-	    flag = LESS_THAN;
-	  else
-	    flag = GREATER_THAN;
+	  flag = GREATER_THAN;
 	}
       else
 	{
-	  flag = ComparePartial_Matches (theEnv, actPtr, newActivation);
+	  flag = EQUAL;
 	}
+      break;
 
-      if (flag == LESS_THAN)
+    case RANDOM_STRATEGY:
+      if (newActivation->randomID > actPtr->randomID)
 	{
-	  lastAct = actPtr;
-	  if (actPtr == theGroup->last)
-	    {
-	      break;
-	    }
-	  else
-	    {
-	      actPtr = actPtr->next;
-	    }
+	  flag = LESS_THAN;
 	}
-      else if (flag == GREATER_THAN)
+      else if (newActivation->randomID < actPtr->randomID)
 	{
-	  break;
+	  flag = GREATER_THAN;
 	}
-      else			/* flag == EQUAL */
+      else
 	{
-	  if (timetag > actPtr->timetag)
-	    {
-	      lastAct = actPtr;
-	      if (actPtr == theGroup->last)
-		{
-		  break;
-		}
-	      else
-		{
-		  actPtr = actPtr->next;
-		}
-	    }
-	  else
-	    {
-	      break;
-	    }
+	  flag = EQUAL;
 	}
-    }
-
-   /*========================================*/
-  /* Update the salience group info_rmation. */
-   /*========================================*/
+      break;
 
-  if ((lastAct == NULL) ||
-      ((theGroup->prev != NULL) && (theGroup->prev->last == lastAct)))
-    {
-      theGroup->first = newActivation;
+    default:
+      flag = EQUAL;
+      break;
     }
 
-  if ((theGroup->last == NULL) || (theGroup->last == lastAct))
+  if (flag == EQUAL)
     {
-      theGroup->last = newActivation;
+      return (newActivation->timetag > actPtr->timetag);
     }
 
-   /*===========================================*/
-  /* Return the insertion point in the agenda. */
-   /*===========================================*/
-
-  return lastAct;
+  return (flag == LESS_THAN);
 }
 
-/*********************************************************************/
-/* PlaceComplexityActivation: Dete_rmines the location in the agenda  */
-/*    where a new activation should be placed for the complexity     */
-/*    strategy. Returns a pointer to the activation  after which the */
-/*    new activation should be placed (or NULL if the activation     */
-/*    should be placed at the beginning of the agenda).              */
-/*********************************************************************/
-static Activation *
-PlaceComplexityActivation (Activation * newActivation,
-			   struct salienceGroup *theGroup)
+/***************************************************************/
+/* ActivationIndexLevels: Returns the number of levels above   */
+/*   the agenda on which an activation is linked in the skip   */
+/*   list of its salience group, each level holding about a    */
+/*   quarter of the activations of the level below. The levels */
+/*   are derived from the timetag rather than drawn from the   */
+/*   random number generator, which would change the numbers   */
+/*   seen by the random strategy and the random function.      */
+/***************************************************************/
+static unsigned short
+ActivationIndexLevels (unsigned long long timetag)
 {
-  unsigned int complexity;
-  unsigned long long timetag;
-  Activation *lastAct, *actPtr;
-
-   /*========================================*/
-  /* Set up initial info_rmation for search. */
-   /*========================================*/
-
-  timetag = newActivation->timetag;
-  complexity = newActivation->theRule->complexity;
-  if (theGroup->prev == NULL)
-    {
-      lastAct = NULL;
-    }
-  else
-    {
-      lastAct = theGroup->prev->last;
-    }
-
-   /*=========================================================*/
-  /* Find the insertion point in the agenda. The activation  */
-  /* is placed before activations of lower salience and      */
-  /* after activations of higher salience. Among activations */
-  /* of equal salience, the activation is placed before      */
-  /* activations of equal or lessor complexity.              */
-   /*=========================================================*/
-
-  actPtr = theGroup->first;
-  while (actPtr != NULL)
-    {
-      if (complexity < actPtr->theRule->complexity)
-	{
-	  lastAct = actPtr;
-	  if (actPtr == theGroup->last)
-	    {
-	      break;
-	    }
-	  else
-	    {
-	      actPtr = actPtr->next;
-	    }
-	}
-      else if (complexity > actPtr->theRule->complexity)
-	{
-	  break;
-	}
-      else if (timetag > actPtr->timetag)
-	{
-	  lastAct = actPtr;
-	  if (actPtr == theGroup->last)
-	    {
-	      break;
-	    }
-	  else
-	    {
-	      actPtr = actPtr->next;
-	    }
-	}
-      else
-	{
-	  break;
-	}
-    }
-
-   /*========================================*/
-  /* Update the salience group info_rmation. */
-   /*========================================*/
+  unsigned long long bits;
+  unsigned short levels = 0;
 
-  if ((lastAct == NULL) ||
-      ((theGroup->prev != NULL) && (theGroup->prev->last == lastAct)))
+  bits = (timetag * 0x9E3779B97F4A7C15ULL) >> 32;
+  while ((levels < ACTIVATION_INDEX_LEVELS) && ((bits & 0x3) == 0))
     {
-      theGroup->first = newActivation;
+      levels++;
+      bits >>= 2;
     }
 
-  if ((theGroup->last == NULL) || (theGroup->last == lastAct))
-    {
-      theGroup->last = newActivation;
-    }
-
-   /*===========================================*/
-  /* Return the insertion point in the agenda. */
-   /*===========================================*/
-
-  return lastAct;
+  return levels;
 }
 
-/*********************************************************************/
-/* PlaceSimplicityActivation: Dete_rmines the location in the agenda  */
-/*    where a new activation should be placed for the simplicity     */
-/*    strategy. Returns a pointer to the activation  after which the */
-/*    new activation should be placed (or NULL if the activation     */
-/*    should be placed at the beginning of the agenda).              */
-/*********************************************************************/
-static Activation *
-PlaceSimplicityActivation (Activation * newActivation,
-			   struct salienceGroup *theGroup)
+/***************************************************************/
+/* CL_UnindexActivation: Unlinks an activation leaving its     */
+/*   salience group from the levels of the skip list of the    */
+/*   group above the agenda, then returns its links to the     */
+/*   memory manager.                                           */
+/***************************************************************/
+void
+CL_UnindexActivation (Environment * theEnv,
+		      Activation * theActivation,
+		      struct salienceGroup *theGroup)
 {
-  unsigned int complexity;
-  unsigned long long timetag;
-  Activation *lastAct, *actPtr;
+  unsigned short level;
+  struct activationLink *theLink;
 
-   /*============================================*/
-  /* Set up initial info_rmation for the search. */
-   /*============================================*/
+  if (theActivation->indexLinks == NULL)
+    return;
 
-  timetag = newActivation->timetag;
-  complexity = newActivation->theRule->complexity;
-  if (theGroup->prev == NULL)
+  for (level = 0; level < theActivation->indexLevels; level++)
     {
-      lastAct = NULL;
-    }
-  else
-    {
-      lastAct = theGroup->prev->last;
-    }
-
-   /*=========================================================*/
-  /* Find the insertion point in the agenda. The activation  */
-  /* is placed before activations of lower salience and      */
-  /* after activations of higher salience. Among activations */
-  /* of equal salience, the activation is placed after       */
-  /* activations of equal or greater complexity.             */
-   /*=========================================================*/
+      theLink = &theActivation->indexLinks[level];
 
-  actPtr = theGroup->first;
-  while (actPtr != NULL)
-    {
-      if (complexity > actPtr->theRule->complexity)
-	{
-	  lastAct = actPtr;
-	  if (actPtr == theGroup->last)
-	    {
-	      break;
-	    }
-	  else
-	    {
-	      actPtr = actPtr->next;
-	    }
-	}
-      else if (complexity < actPtr->theRule->complexity)
+      if (theLink->prev != NULL)
 	{
-	  break;
+	  theLink->prev->indexLinks[level].next = theLink->next;
 	}
-      else if (timetag > actPtr->timetag)
+      else if ((theGroup != NULL) &&
+	       (theGroup->indexHead[level] == theActivation))
 	{
-	  lastAct = actPtr;
-	  if (actPtr == theGroup->last)
-	    {
-	      break;
-	    }
-	  else
-	    {
-	      actPtr = actPtr->next;
-	    }
+	  theGroup->indexHead[level] = theLink->next;
 	}
-      else
+
+      if (theLink->next != NULL)
 	{
-	  break;
+	  theLink->next->indexLinks[level].prev = theLink->prev;
 	}
     }
 
-   /*========================================*/
-  /* Update the salience group info_rmation. */
-   /*========================================*/
-
-  if ((lastAct == NULL) ||
-      ((theGroup->prev != NULL) && (theGroup->prev->last == lastAct)))
-    {
-      theGroup->first = newActivation;
-    }
-
-  if ((theGroup->last == NULL) || (theGroup->last == lastAct))
-    {
-      theGroup->last = newActivation;
-    }
-
-   /*===========================================*/
-  /* Return the insertion point in the agenda. */
-   /*===========================================*/
-
-  return (lastAct);
-}
-
-/*******************************************************************/
-/* PlaceRandomActivation: Dete_rmines the location in the agenda    */
-/*    where a new activation should be placed for the random       */
-/*    strategy. Returns a pointer to the activation  after which   */
-/*    the new activation should be placed (or NULL if the          */
-/*    activation should be placed at the beginning of the agenda). */
-/*******************************************************************/
-static Activation *
-PlaceRandomActivation (Activation * newActivation,
-		       struct salienceGroup *theGroup)
-{
-  int randomID;
-  unsigned long long timetag;
-  Activation *lastAct, *actPtr;
-
-   /*============================================*/
-  /* Set up initial info_rmation for the search. */
-   /*============================================*/
-
-  timetag = newActivation->timetag;
-  randomID = newActivation->randomID;
-  if (theGroup->prev == NULL)
-    {
-      lastAct = NULL;
-    }
-  else
-    {
-      lastAct = theGroup->prev->last;
-    }
-
-   /*=========================================================*/
-  /* Find the insertion point in the agenda. The activation  */
-  /* is placed before activations of lower salience and      */
-  /* after activations of higher salience. Among activations */
-  /* of equal salience, the placement of the activation is   */
-  /* dete_rmined through the generation of a random number.   */
-   /*=========================================================*/
-
-  actPtr = theGroup->first;
-  while (actPtr != NULL)
+  if (theGroup != NULL)
     {
-      if (randomID > actPtr->randomID)
+      while ((theGroup->indexLevels > 0) &&
+	     (theGroup->indexHead[theGroup->indexLevels - 1] == NULL))
 	{
-	  lastAct = actPtr;
-	  if (actPtr == theGroup->last)
-	    {
-	      break;
-	    }
-	  else
-	    {
-	      actPtr = actPtr->next;
-	    }
+	  theGroup->indexLevels--;
 	}
-      else if (randomID < actPtr->randomID)
-	{
-	  break;
-	}
-      else if (timetag > actPtr->timetag)
-	{
-	  lastAct = actPtr;
-	  if (actPtr == theGroup->last)
-	    {
-	      break;
-	    }
-	  else
-	    {
-	      actPtr = actPtr->next;
-	    }
-	}
-      else
-	{
-	  break;
-	}
-    }
-
-   /*========================================*/
-  /* Update the salience group info_rmation. */
-   /*========================================*/
-
-  if ((lastAct == NULL) ||
-      ((theGroup->prev != NULL) && (theGroup->prev->last == lastAct)))
-    {
-      theGroup->first = newActivation;
-    }
-
-  if ((theGroup->last == NULL) || (theGroup->last == lastAct))
-    {
-      theGroup->last = newActivation;
     }
 
-   /*===========================================*/
-  /* Return the insertion point in the agenda. */
-   /*===========================================*/
+  CL_ReturnActivationIndex (theEnv, theActivation);
+}
 
-  return (lastAct);
+/**************************************************************/
+/* CL_ReturnActivationIndex: Returns the skip list links of   */
+/*   an activation to the memory manager without unlinking    */
+/*   them, when its salience group is discarded as a whole.   */
+/**************************************************************/
+void
+CL_ReturnActivationIndex (Environment * theEnv, Activation * theActivation)
+{
+  if (theActivation->indexLinks == NULL)
+    return;
+
+  rtn_mem (theEnv,
+	   sizeof (struct activationLink) * theActivation->indexLevels,
+	   theActivation->indexLinks);
+  theActivation->indexLinks = NULL;
+  theActivation->indexLevels = 0;
 }
 
 /*********************************************************/
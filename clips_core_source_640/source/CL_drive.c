@@ -60,6 +60,10 @@
 #include "constant.h"
 #include "engine.h"
 #include "envrnmnt.h"
+#if DEFTEMPLATE_CONSTRUCT
+#include "factgen.h"
+#include "factmngr.h"
+#endif
 #include "incrrset.h"
 #include "lgcldpnd.h"
 #include "memalloc.h"
@@ -67,6 +71,7 @@
 #include "reteutil.h"
 #include "retract.h"
 #include "router.h"
+#include "ruledef.h"
 
 #include "drive.h"
 
@@ -77,6 +82,15 @@
 static void EmptyDrive (Environment *, struct joinNode *,
 			struct partialMatch *, int);
 static void JoinNetErrorMessage (Environment *, struct joinNode *);
+static struct compiledJoinTests *JoinTests (Environment *,
+					    struct joinNode *);
+static struct joinTestCode *CompileJoinTest (Environment *, struct expr *,
+					     bool);
+static void ReleaseJoinTest (Environment *, struct joinTestCode *);
+static bool EvaluateJoinTestCode (Environment *, struct joinTestCode *,
+				  struct joinNode *);
+static bool EvaluateJoinTestStep (Environment *, struct joinTestStep *,
+				  UDFValue *);
 
 /************************************************/
 /* Network_Assert: Primary routine for filtering */
@@ -296,19 +310,19 @@ Network_AssertRight (Environment * theEnv,
 	{
 	  if (join->patternIsExists)
 	    {
-	      CL_AddBlockedLink (lhsBinds, rhsBinds);
+	      CL_AddBlockedLink (theEnv, lhsBinds, rhsBinds);
 	      CL_PPDrive (theEnv, lhsBinds, NULL, join, operation);
 	    }
 	  else if (join->patternIsNegated || join->joinFromTheRight)
 	    {
-	      CL_AddBlockedLink (lhsBinds, rhsBinds);
+	      CL_AddBlockedLink (theEnv, lhsBinds, rhsBinds);
 	      if (lhsBinds->children != NULL)
 		{
 		  CL_PosEntry_RetractBeta (theEnv, lhsBinds,
 					   lhsBinds->children, operation);
 		}
 	      /*
-	         if (lhsBinds->dependents != NULL)
+	         if (PMDependents (lhsBinds) != NULL)
 	         { CL_RemoveLogicalSupport(theEnv,lhsBinds); }
 	       */
 	    }
@@ -433,6 +447,21 @@ Network_AssertLeft (Environment * theEnv,
     {
       rhsBinds = CL_GetRightBetaMemory (join, entryHashValue);
     }
+  else if ((((struct patternNodeHeader *)
+	      join->rightSideEntryStructure)->firstHash == NULL) ||
+	   (((struct patternNodeHeader *)
+	     join->rightSideEntryStructure)->flushing &&
+	    (operation == NETWORK_RETRACT)))
+    {
+      /*==================================================*/
+      /* An empty alpha memory has nothing to compare the */
+      /* partial match with, so its hash isn't searched.  */
+      /* Neither is one whose matches are all retracted   */
+      /* by a bulk retraction.                            */
+      /*==================================================*/
+
+      rhsBinds = NULL;
+    }
   else
     {
       rhsBinds =
@@ -567,7 +596,7 @@ Network_AssertLeft (Environment * theEnv,
 
 	  else if (join->patternIsExists)
 	    {
-	      CL_AddBlockedLink (lhsBinds, rhsBinds);
+	      CL_AddBlockedLink (theEnv, lhsBinds, rhsBinds);
 	      CL_PPDrive (theEnv, lhsBinds, NULL, join, operation);
 	      EngineData (theEnv)->GlobalLHSBinds = oldLHSBinds;
 	      EngineData (theEnv)->GlobalRHSBinds = oldRHSBinds;
@@ -588,7 +617,7 @@ Network_AssertLeft (Environment * theEnv,
 
 	  else
 	    {
-	      CL_AddBlockedLink (lhsBinds, rhsBinds);
+	      CL_AddBlockedLink (theEnv, lhsBinds, rhsBinds);
 	      break;
 	    }
 	}
@@ -662,6 +691,7 @@ CL_EvaluateJoinExpression (Environment * theEnv,
 {
   UDFValue theResult;
   bool andLogic, result = true;
+  struct compiledJoinTests *compiled;
 
    /*======================================*/
   /* A NULL expression evaluates to true. */
@@ -670,6 +700,26 @@ CL_EvaluateJoinExpression (Environment * theEnv,
   if (joinExpr == NULL)
     return true;
 
+   /*================================================*/
+  /* Use the compiled fo_rm of the network tests of  */
+  /* the join when join test compilation is enabled. */
+   /*================================================*/
+
+  if ((compiled = JoinTests (theEnv, joinPtr)) != NULL)
+    {
+      if (joinExpr == joinPtr->networkTest)
+	{
+	  return EvaluateJoinTestCode (theEnv, compiled->networkTest,
+				       joinPtr);
+	}
+      else if (joinExpr == joinPtr->secondaryNetworkTest)
+	{
+	  return EvaluateJoinTestCode (theEnv,
+				       compiled->secondaryNetworkTest,
+				       joinPtr);
+	}
+    }
+
    /*====================================================*/
   /* Initialize some variables which allow this routine */
   /* to avoid calling the "and" and "or" functions if   */
@@ -870,6 +920,8 @@ CL_BetaMemoryHashValue (Environment * theEnv,
   struct joinNode *oldJoin;
   unsigned long hashValue = 0;
   unsigned long multiplier = 1;
+  struct compiledJoinTests *compiled;
+  struct joinTestStep *theStep = NULL;
   union
   {
     void *vv;
@@ -897,6 +949,24 @@ CL_BetaMemoryHashValue (Environment * theEnv,
   EngineData (theEnv)->GlobalRHSBinds = rbinds;
   EngineData (theEnv)->GlobalJoin = joinPtr;
 
+   /*==============================================*/
+  /* The compiled fo_rm of a hash expression has a  */
+  /* step for each of the expressions linked       */
+  /* together in it, so they are walked in step.   */
+   /*==============================================*/
+
+  if ((compiled = JoinTests (theEnv, joinPtr)) != NULL)
+    {
+      if (hashExpr == joinPtr->leftHash)
+	{
+	  theStep = compiled->leftHash->steps;
+	}
+      else if (hashExpr == joinPtr->rightHash)
+	{
+	  theStep = compiled->rightHash->steps;
+	}
+    }
+
    /*=========================================*/
   /* CL_Evaluate each of the expressions linked */
   /* together in the join expression.        */
@@ -904,11 +974,21 @@ CL_BetaMemoryHashValue (Environment * theEnv,
 
   while (hashExpr != NULL)
     {
+      /*=================================*/
+      /* CL_Evaluate a compiled expression. */
+      /*=================================*/
+
+      if (theStep != NULL)
+	{
+	  EvaluateJoinTestStep (theEnv, theStep, &theResult);
+	  theStep++;
+	}
+
       /*================================*/
       /* CL_Evaluate a primitive function. */
       /*================================*/
 
-      if ((CL_EvaluationData (theEnv)->PrimitivesArray[hashExpr->type] ==
+      else if ((CL_EvaluationData (theEnv)->PrimitivesArray[hashExpr->type] ==
 	   NULL) ? false :
 	  CL_EvaluationData (theEnv)->PrimitivesArray[hashExpr->
 						      type]->evaluateFunction
@@ -987,6 +1067,314 @@ CL_BetaMemoryHashValue (Environment * theEnv,
   return hashValue;
 }
 
+/***************************************************************/
+/* JoinTests: Returns the compiled network tests and hash      */
+/*   expressions of a join, compiling them the first time they */
+/*   are needed, or NULL when join test compilation is off.    */
+/***************************************************************/
+static struct compiledJoinTests *
+JoinTests (Environment * theEnv, struct joinNode *joinPtr)
+{
+  if ((joinPtr == NULL) || (!DefruleData (theEnv)->CompileJoinTestsFlag))
+    {
+      return NULL;
+    }
+
+  if (joinPtr->compiledTests == NULL)
+    {
+      CL_CompileJoinTests (theEnv, joinPtr);
+    }
+
+  return joinPtr->compiledTests;
+}
+
+/*************************************************************/
+/* CL_CompileJoinTests: Compiles the network tests and hash     */
+/*   expressions of a join into arrays of steps which can be */
+/*   evaluated without decoding the expressions again. The   */
+/*   expressions of the join are not modified, so the join   */
+/*   can still be saved or printed as usual.                 */
+/*************************************************************/
+void
+CL_CompileJoinTests (Environment * theEnv, struct joinNode *joinPtr)
+{
+  struct compiledJoinTests *compiled;
+
+  if (joinPtr->compiledTests != NULL)
+    {
+      return;
+    }
+
+  compiled = get_struct (theEnv, compiledJoinTests);
+  compiled->networkTest =
+    CompileJoinTest (theEnv, joinPtr->networkTest, true);
+  compiled->secondaryNetworkTest =
+    CompileJoinTest (theEnv, joinPtr->secondaryNetworkTest, true);
+  compiled->leftHash = CompileJoinTest (theEnv, joinPtr->leftHash, false);
+  compiled->rightHash = CompileJoinTest (theEnv, joinPtr->rightHash, false);
+
+  joinPtr->compiledTests = compiled;
+}
+
+/**********************************************************/
+/* CL_ReleaseJoinTests: Returns the compiled network tests   */
+/*   and hash expressions of a join before it is deleted. */
+/**********************************************************/
+void
+CL_ReleaseJoinTests (Environment * theEnv, struct joinNode *joinPtr)
+{
+  struct compiledJoinTests *compiled;
+
+  compiled = joinPtr->compiledTests;
+  if (compiled == NULL)
+    {
+      return;
+    }
+
+  ReleaseJoinTest (theEnv, compiled->networkTest);
+  ReleaseJoinTest (theEnv, compiled->secondaryNetworkTest);
+  ReleaseJoinTest (theEnv, compiled->leftHash);
+  ReleaseJoinTest (theEnv, compiled->rightHash);
+  rtn_struct (theEnv, compiledJoinTests, compiled);
+
+  joinPtr->compiledTests = NULL;
+}
+
+/****************************************************************/
+/* CompileJoinTest: Compiles a network test (whose top level   */
+/*   "and" or "or" function is unwrapped as done by            */
+/*   CL_EvaluateJoinExpression) or a hash expression (whose       */
+/*   linked expressions are all evaluated) into an array with   */
+/*   one step for each expression. A NULL expression still has */
+/*   a compiled fo_rm, with no steps.                            */
+/****************************************************************/
+static struct joinTestCode *
+CompileJoinTest (Environment * theEnv, struct expr *theExpr, bool isTest)
+{
+  struct joinTestCode *theCode;
+  struct joinTestStep *theStep;
+  struct expr *tmpPtr;
+  struct entityRecord *thePrimitive;
+  unsigned short count = 0;
+  bool andLogic = true;
+#if DEFTEMPLATE_CONSTRUCT
+  struct factCompVarsJN1Call *hack;
+#endif
+
+  if (isTest && (theExpr != NULL))
+    {
+      if (theExpr->value == ExpressionData (theEnv)->PTR_AND)
+	{
+	  theExpr = theExpr->argList;
+	}
+      else if (theExpr->value == ExpressionData (theEnv)->PTR_OR)
+	{
+	  andLogic = false;
+	  theExpr = theExpr->argList;
+	}
+    }
+
+  for (tmpPtr = theExpr; tmpPtr != NULL; tmpPtr = tmpPtr->nextArg)
+    {
+      count++;
+    }
+
+  theCode = get_var_struct (theEnv, joinTestCode,
+			    sizeof (struct joinTestStep) *
+			    ((count == 0) ? 0 : (count - 1)));
+  theCode->andLogic = andLogic;
+  theCode->stepCount = count;
+
+  for (theStep = theCode->steps; theExpr != NULL;
+       theExpr = theExpr->nextArg, theStep++)
+    {
+      thePrimitive =
+	CL_EvaluationData (theEnv)->PrimitivesArray[theExpr->type];
+
+      theStep->kind = JOIN_STEP_GENERAL;
+      theStep->pass = false;
+      theStep->fail = false;
+      theStep->p2rhs = false;
+      theStep->pattern1 = 0;
+      theStep->slot1 = 0;
+      theStep->pattern2 = 0;
+      theStep->slot2 = 0;
+      theStep->evaluateFunction = NULL;
+      theStep->theExpression = theExpr;
+
+      /*========================================*/
+      /* The order of these tests is the one of */
+      /* CL_EvaluateJoinExpression, which handles  */
+      /* primitives before "and" and "or".      */
+      /*========================================*/
+
+      if ((thePrimitive != NULL) && (thePrimitive->evaluateFunction != NULL))
+	{
+#if DEFTEMPLATE_CONSTRUCT
+	  if (isTest && (theExpr->type == FACT_JN_CMP1))
+	    {
+	      hack = (struct factCompVarsJN1Call *)
+		((CLIPSBitMap *) theExpr->value)->contents;
+	      theStep->kind = JOIN_STEP_SLOT_COMPARE;
+	      theStep->pass = hack->pass;
+	      theStep->fail = hack->fail;
+	      theStep->p2rhs = hack->p2rhs;
+	      theStep->pattern1 = hack->pattern1;
+	      theStep->slot1 = hack->slot1;
+	      theStep->pattern2 = hack->pattern2;
+	      theStep->slot2 = hack->slot2;
+	      continue;
+	    }
+#endif
+	  theStep->kind = JOIN_STEP_PRIMITIVE;
+	  theStep->evaluateFunction = thePrimitive->evaluateFunction;
+	}
+      else if (isTest &&
+	       ((theExpr->value == ExpressionData (theEnv)->PTR_OR) ||
+		(theExpr->value == ExpressionData (theEnv)->PTR_AND)))
+	{
+	  theStep->kind = JOIN_STEP_NESTED;
+	}
+    }
+
+  return theCode;
+}
+
+/*************************************************/
+/* ReleaseJoinTest: Returns the memory used by a */
+/*   compiled network test or hash expression.   */
+/*************************************************/
+static void
+ReleaseJoinTest (Environment * theEnv, struct joinTestCode *theCode)
+{
+  if (theCode == NULL)
+    {
+      return;
+    }
+
+  rtn_var_struct (theEnv, joinTestCode,
+		  sizeof (struct joinTestStep) *
+		  ((theCode->stepCount == 0) ? 0 : (theCode->stepCount - 1)),
+		  theCode);
+}
+
+/******************************************************************/
+/* EvaluateJoinTestCode: CL_Evaluates a compiled network test with   */
+/*   the same short cut logic and error handling as               */
+/*   CL_EvaluateJoinExpression, which still evaluates the nested     */
+/*   "and" and "or" functions.                                    */
+/******************************************************************/
+static bool
+EvaluateJoinTestCode (Environment * theEnv,
+		      struct joinTestCode *theCode, struct joinNode *joinPtr)
+{
+  UDFValue theResult;
+  struct joinTestStep *theStep, *lastStep;
+  bool result = true;
+
+  lastStep = theCode->steps + theCode->stepCount;
+  for (theStep = theCode->steps; theStep < lastStep; theStep++)
+    {
+      switch (theStep->kind)
+	{
+	case JOIN_STEP_NESTED:
+	  result =
+	    CL_EvaluateJoinExpression (theEnv, theStep->theExpression,
+				       joinPtr);
+	  if (CL_EvaluationData (theEnv)->CL_EvaluationError)
+	    {
+	      return false;
+	    }
+	  break;
+
+	case JOIN_STEP_GENERAL:
+	  CL_EvaluateExpression (theEnv, theStep->theExpression, &theResult);
+	  if (CL_EvaluationData (theEnv)->CL_EvaluationError)
+	    {
+	      JoinNetErrorMessage (theEnv, joinPtr);
+	      return false;
+	    }
+	  result = (theResult.value != FalseSymbol (theEnv));
+	  break;
+
+	default:
+	  result = EvaluateJoinTestStep (theEnv, theStep, &theResult);
+	  break;
+	}
+
+      if ((theCode->andLogic == true) && (result == false))
+	{
+	  return false;
+	}
+      else if ((theCode->andLogic == false) && (result == true))
+	{
+	  return true;
+	}
+    }
+
+  return result;
+}
+
+/*************************************************************/
+/* EvaluateJoinTestStep: CL_Evaluates a compiled slot comparison */
+/*   or primitive, or else the expression of the step, into  */
+/*   theResult. Slot comparisons only return their result.   */
+/*************************************************************/
+static bool
+EvaluateJoinTestStep (Environment * theEnv,
+		      struct joinTestStep *theStep, UDFValue * theResult)
+{
+  struct expr *oldArgument;
+  bool rv;
+#if DEFTEMPLATE_CONSTRUCT
+  Fact *fact1, *fact2;
+#endif
+
+  switch (theStep->kind)
+    {
+#if DEFTEMPLATE_CONSTRUCT
+    case JOIN_STEP_SLOT_COMPARE:
+      fact1 = (Fact *)
+	EngineData (theEnv)->GlobalRHSBinds->binds[theStep->pattern1].gm.
+	theMatch->matchingItem;
+
+      if (theStep->p2rhs)
+	{
+	  fact2 = (Fact *)
+	    EngineData (theEnv)->GlobalRHSBinds->binds[theStep->pattern2].gm.
+	    theMatch->matchingItem;
+	}
+      else
+	{
+	  fact2 = (Fact *)
+	    EngineData (theEnv)->GlobalLHSBinds->binds[theStep->pattern2].gm.
+	    theMatch->matchingItem;
+	}
+
+      if (FactSlotContents (theEnv, fact1, theStep->slot1)->value !=
+	  FactSlotContents (theEnv, fact2, theStep->slot2)->value)
+	{
+	  return theStep->fail;
+	}
+
+      return theStep->pass;
+#endif
+
+    case JOIN_STEP_PRIMITIVE:
+      oldArgument = CL_EvaluationData (theEnv)->CurrentExpression;
+      CL_EvaluationData (theEnv)->CurrentExpression = theStep->theExpression;
+      rv = (*theStep->evaluateFunction) (theEnv,
+					 theStep->theExpression->value,
+					 theResult);
+      CL_EvaluationData (theEnv)->CurrentExpression = oldArgument;
+      return rv;
+
+    default:
+      CL_EvaluateExpression (theEnv, theStep->theExpression, theResult);
+      return (theResult->value != FalseSymbol (theEnv));
+    }
+}
+
 /*******************************************************************/
 /* CL_PPDrive: Handles the merging of an alpha memory partial match   */
 /*   with a beta memory partial match for a join that has positive */
@@ -1202,7 +1590,7 @@ EmptyDrive (Environment * theEnv,
 	  return;
 	}
 
-      CL_AddBlockedLink (notParent, rhsBinds);
+      CL_AddBlockedLink (theEnv, notParent, rhsBinds);
 
       if (notParent->children != NULL)
 	{
@@ -1210,7 +1598,7 @@ EmptyDrive (Environment * theEnv,
 				   operation);
 	}
       /*
-         if (notParent->dependents != NULL)
+         if (PMDependents (notParent) != NULL)
          { CL_RemoveLogicalSupport(theEnv,notParent); }
        */
 
@@ -1231,7 +1619,7 @@ EmptyDrive (Environment * theEnv,
 	{
 	  return;
 	}
-      CL_AddBlockedLink (existsParent, rhsBinds);
+      CL_AddBlockedLink (theEnv, existsParent, rhsBinds);
     }
 
    /*============================================*/
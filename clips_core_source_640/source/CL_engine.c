@@ -99,6 +99,7 @@
 #include "commline.h"
 #include "constant.h"
 #include "envrnmnt.h"
+#include "factmch.h"
 #include "factmngr.h"
 #include "inscom.h"
 #include "memalloc.h"
@@ -200,6 +201,9 @@ CL_Run (Environment * theEnv, long long runLimit)
   int danglingConstructs;
   GCBlock gcb;
   bool error = false;
+#if DEFTEMPLATE_CONSTRUCT
+  unsigned int batchDepth;
+#endif
 
    /*=====================================================*/
   /* Make sure the run command is not already executing. */
@@ -211,6 +215,23 @@ CL_Run (Environment * theEnv, long long runLimit)
     }
   EngineData (theEnv)->Already_Running = true;
 
+   /*===============================================*/
+  /* The rules are not fired inside a batch of     */
+  /* assertions: the matches kept for an open      */
+  /* batch are sent to the join network first, and */
+  /* the batch is suspended so the facts asserted  */
+  /* by the rules are matched right away.          */
+   /*===============================================*/
+
+#if DEFTEMPLATE_CONSTRUCT
+  batchDepth = FactData (theEnv)->AssertBatchDepth;
+  if (batchDepth > 0)
+    {
+      CL_FlushBatchAlphaMatches (theEnv);
+      FactData (theEnv)->AssertBatchDepth = 0;
+    }
+#endif
+
    /*========================================*/
   /* Set up the frame for tracking garbage. */
    /*========================================*/
@@ -559,7 +580,7 @@ CL_Run (Environment * theEnv, long long runLimit)
 
       if (GetSalience_Evaluation (theEnv) == EVERY_CYCLE)
 	{
-	  CL_RefreshAll_Agendas (theEnv);
+	  CL_UpdateAll_AgendaSaliences (theEnv);
 	}
 
       /*========================================*/
@@ -756,9 +777,14 @@ CL_Run (Environment * theEnv, long long runLimit)
   CL_CallPeriodicTasks (theEnv);
 
    /*===================================*/
-  /* Return the number of rules fired. */
+  /* Reopen the suspended batch, then  */
+  /* return the number of rules fired. */
    /*===================================*/
 
+#if DEFTEMPLATE_CONSTRUCT
+  FactData (theEnv)->AssertBatchDepth = batchDepth;
+#endif
+
   EngineData (theEnv)->Already_Running = false;
   return rulesFired;
 }
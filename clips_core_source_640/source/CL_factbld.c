@@ -1003,6 +1003,20 @@ CL_DestroyFactPatternNetwork (Environment * theEnv,
     }
 }
 
+/************************************************************/
+/* CL_DeftemplateHasPatterns: Returns true if some pattern  */
+/*   of a rule currently refers to the deftemplate, so that */
+/*   its facts can be matched.                              */
+/************************************************************/
+bool
+CL_DeftemplateHasPatterns (Deftemplate * theDeftemplate)
+{
+  if (theDeftemplate == NULL)
+    return false;
+
+  return (theDeftemplate->patternNetwork != NULL);
+}
+
 #if (! RUN_TIME) && (! BLOAD_ONLY)
 
 /***********************************************************/
@@ -9,6 +9,7 @@
 /*************************************************************/
 /* Purpose: Provides the facts, assert, retract, save-facts, */
 /*   load-facts, set-fact-duplication, get-fact-duplication, */
+/*   set-alpha-match-threads, get-alpha-match-threads,       */
 /*   assert-string, and fact-index commands and functions.   */
 /*                                                           */
 /* Principal Programmer(s):                                  */
@@ -145,6 +146,9 @@ CL_FactCommandDefinitions (Environment * theEnv)
 	     "CL_AssertCommand", NULL);
   CL_AddUDF (theEnv, "retract", "v", 1, UNBOUNDED, "fly", CL_RetractCommand,
 	     "CL_RetractCommand", NULL);
+  CL_AddUDF (theEnv, "retract-deftemplate-facts", "v", 1, 1, "y",
+	     CL_RetractDeftemplateFactsCommand,
+	     "CL_RetractDeftemplateFactsCommand", NULL);
   CL_AddUDF (theEnv, "assert-string", "bf", 1, 1, "s",
 	     CL_AssertStringFunction, "CL_AssertStringFunction", NULL);
   CL_AddUDF (theEnv, "str-assert", "bf", 1, 1, "s", CL_AssertStringFunction,
@@ -156,6 +160,12 @@ CL_FactCommandDefinitions (Environment * theEnv)
   CL_AddUDF (theEnv, "set-fact-duplication", "b", 1, 1, NULL,
 	     CL_SetFactDuplicationCommand, "CL_SetFactDuplicationCommand",
 	     NULL);
+  CL_AddUDF (theEnv, "get-alpha-match-threads", "l", 0, 0, NULL,
+	     CL_GetAlphaMatchThreadsCommand,
+	     "CL_GetAlphaMatchThreadsCommand", NULL);
+  CL_AddUDF (theEnv, "set-alpha-match-threads", "l", 1, 1, "l",
+	     CL_SetAlphaMatchThreadsCommand,
+	     "CL_SetAlphaMatchThreadsCommand", NULL);
 
   CL_AddUDF (theEnv, "save-facts", "b", 1, UNBOUNDED, "y;sy",
 	     CL_Save_FactsCommand, "CL_Save_FactsCommand", NULL);
@@ -313,7 +323,6 @@ CL_RetractCommand (Environment * theEnv,
 		   UDFContext * context, UDFValue * returnValue)
 {
   long long factIndex;
-  Fact *ptr;
   UDFValue theArg;
 
    /*================================*/
@@ -362,22 +371,13 @@ CL_RetractCommand (Environment * theEnv,
 	      return;
 	    }
 
-	 /*================================================*/
-	  /* See if a fact with the specified index exists. */
-	 /*================================================*/
+	 /*==============================================*/
+	  /* CL_Retract the fact with the specified index */
+	  /* if it exists, otherwise print an error       */
+	  /* message.                                     */
+	 /*==============================================*/
 
-	  ptr = CL_FindIndexedFact (theEnv, factIndex);
-
-	 /*=====================================*/
-	  /* If the fact exists then retract it, */
-	  /* otherwise print an error message.   */
-	 /*=====================================*/
-
-	  if (ptr != NULL)
-	    {
-	      CL_Retract (ptr);
-	    }
-	  else
+	  if (CL_RetractIndexedFact (theEnv, factIndex) == RE_NOT_FOUND_ERROR)
 	    {
 	      char tempBuffer[20];
 	      CL_gensprintf (tempBuffer, "f-%lld", factIndex);
@@ -411,6 +411,36 @@ CL_RetractCommand (Environment * theEnv,
     }
 }
 
+/***********************************************************/
+/* CL_RetractDeftemplateFactsCommand: H/L access routine   */
+/*   for the retract-deftemplate-facts command.            */
+/***********************************************************/
+void
+CL_RetractDeftemplateFactsCommand (Environment * theEnv,
+				   UDFContext * context,
+				   UDFValue * returnValue)
+{
+  const char *deftemplateName;
+  Deftemplate *theDeftemplate;
+
+  deftemplateName =
+    CL_GetConstructName (context, "retract-deftemplate-facts",
+			 "deftemplate name");
+  if (deftemplateName == NULL)
+    return;
+
+  theDeftemplate = CL_FindDeftemplate (theEnv, deftemplateName);
+  if (theDeftemplate == NULL)
+    {
+      CL_CantFindItemErrorMessage (theEnv, "deftemplate", deftemplateName,
+				   true);
+      Set_EvaluationError (theEnv, true);
+      return;
+    }
+
+  CL_RetractDeftemplateFacts (theDeftemplate);
+}
+
 /***************************************************/
 /* CL_SetFactDuplicationCommand: H/L access routine   */
 /*   for the set-fact-duplication command.         */
@@ -457,6 +487,47 @@ CL_GetFactDuplicationCommand (Environment * theEnv,
     CL_CreateBoolean (theEnv, CL_GetFactDuplication (theEnv));
 }
 
+/****************************************************/
+/* CL_SetAlphaMatchThreadsCommand: H/L access routine */
+/*   for the set-alpha-match-threads command.       */
+/****************************************************/
+void
+CL_SetAlphaMatchThreadsCommand (Environment * theEnv,
+				UDFContext * context, UDFValue * returnValue)
+{
+  UDFValue theArg;
+  long long threadCount;
+
+  returnValue->integerValue =
+    CL_CreateInteger (theEnv, CL_GetAlphaMatchThreads (theEnv));
+
+  if (!CL_UDFFirstArgument (context, INTEGER_BIT, &theArg))
+    {
+      return;
+    }
+
+  threadCount = theArg.integerValue->contents;
+  if ((threadCount < 0) || (threadCount > ALPHA_MATCH_MAX_THREADS))
+    {
+      CL_UDFInvalidArgumentMessage (context, "integer from 0 to 64");
+      return;
+    }
+
+  CL_SetAlphaMatchThreads (theEnv, (unsigned int) threadCount);
+}
+
+/****************************************************/
+/* CL_GetAlphaMatchThreadsCommand: H/L access routine */
+/*   for the get-alpha-match-threads command.       */
+/****************************************************/
+void
+CL_GetAlphaMatchThreadsCommand (Environment * theEnv,
+				UDFContext * context, UDFValue * returnValue)
+{
+  returnValue->integerValue =
+    CL_CreateInteger (theEnv, CL_GetAlphaMatchThreads (theEnv));
+}
+
 /*******************************************/
 /* CL_FactIndexFunction: H/L access routine   */
 /*   for the fact-index function.          */
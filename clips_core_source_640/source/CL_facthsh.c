@@ -75,44 +75,106 @@
 /***************************************/
 
 static Fact *FactExists (Environment *, Fact *, size_t);
+static unsigned long long HashFactFields (Multifield *, unsigned long long);
+static struct factHashEntry **FactHashBucket (Environment *, size_t);
 static struct factHashEntry **CL_CreateFactHashTable (Environment *, size_t);
 static void ResizeFactHashTable (Environment *);
+static void MoveFactHashBuckets (Environment *, unsigned long);
 static void CL_ResetFactHashTable (Environment *);
-
-/************************************************/
-/* CL_HashFact: Returns the hash value for a fact. */
-/************************************************/
+#if DEVELOPER
+static void ShowFactHashBuckets (Environment *, struct factHashEntry **,
+				 unsigned long);
+#endif
+static void ResizeFactIndexTable (Environment *, unsigned long);
+
+/*****************************************************************/
+/* CL_HashFact: Returns the hash value for a fact, which is also */
+/*   stored in the fact. Two facts are duplicates only if they   */
+/*   have the same deftemplate and the same atoms in the same    */
+/*   fields, so the addresses of the deftemplate and of the      */
+/*   atoms are hashed, rather than their contents.               */
+/*****************************************************************/
 size_t
 CL_HashFact (Fact * theFact)
 {
-  size_t count = 0;
+  unsigned long long count;
 
-   /*============================================*/
-  /* Get a hash value for the deftemplate name. */
-   /*============================================*/
+  count = HashFactFields (&theFact->theProposition,
+			  (unsigned long long) (size_t) theFact->
+			  whichDeftemplate);
 
-  count += theFact->whichDeftemplate->header.name->bucket * 73981;
+   /*=============================================*/
+  /* Mix the bits of the hash value, so that its */
+  /* low bits depend on every field of the fact. */
+   /*=============================================*/
 
-   /*=================================================*/
-  /* Add in the hash value for the rest of the fact. */
-   /*=================================================*/
+  count ^= count >> 33;
+  count *= 0xff51afd7ed558ccdULL;
+  count ^= count >> 33;
+  count *= 0xc4ceb9fe1a85ec53ULL;
+  count ^= count >> 33;
 
-  count += CL_HashMultifield (&theFact->theProposition, 0);
+  theFact->hashValue = (unsigned long) count;
 
-   /*================================*/
-  /* Make sure the hash value falls */
-  /* in the appropriate range.      */
-   /*================================*/
+  return theFact->hashValue;
+}
 
-  theFact->hashValue = (unsigned long) count;
+/*************************************************************/
+/* HashFactFields: Combines the fields of a multifield with  */
+/*   a hash value. Each field multiplies the value, so facts */
+/*   having the same atoms in other slots hash differently.  */
+/*************************************************************/
+static unsigned long long
+HashFactFields (Multifield * theSegment, unsigned long long count)
+{
+  size_t i;
+  CLIPSValue *fieldPtr;
 
-   /*========================*/
-  /* Return the hash value. */
-   /*========================*/
+  fieldPtr = theSegment->contents;
+  for (i = 0; i < theSegment->length; i++)
+    {
+      if (fieldPtr[i].header->type == MULTIFIELD_TYPE)
+	{
+	  count = (count + fieldPtr[i].multifieldValue->length) *
+	    0x9e3779b97f4a7c15ULL;
+	  count = HashFactFields (fieldPtr[i].multifieldValue, count);
+	}
+      else
+	{
+	  count = (count + (unsigned long long) (size_t) fieldPtr[i].value) *
+	    0x9e3779b97f4a7c15ULL;
+	}
+      count ^= count >> 29;
+    }
 
   return count;
 }
 
+/*****************************************************************/
+/* FactHashBucket: Returns the bucket of the fact hash table for */
+/*   a hash value. While the table grows, a bucket of the old    */
+/*   table not yet moved to the new one is used instead.         */
+/*****************************************************************/
+static struct factHashEntry **
+FactHashBucket (Environment * theEnv, size_t hashValue)
+{
+  unsigned long oldLocation;
+
+  if (FactData (theEnv)->OldFactHashTable != NULL)
+    {
+      oldLocation = hashValue &
+	(FactData (theEnv)->OldFactHashTableSize - 1);
+      if (oldLocation >= FactData (theEnv)->FactHashBucketsMoved)
+	{
+	  return &FactData (theEnv)->OldFactHashTable[oldLocation];
+	}
+    }
+
+  return &FactData (theEnv)->FactHashTable[hashValue &
+					   (FactData (theEnv)->
+					    FactHashTableSize - 1)];
+}
+
 /**********************************************/
 /* FactExists: Dete_rmines if a specified fact */
 /*   already exists in the fact hash table.   */
@@ -122,12 +184,10 @@ FactExists (Environment * theEnv, Fact * theFact, size_t hashValue)
 {
   struct factHashEntry *theFactHash;
 
-  hashValue = (hashValue % FactData (theEnv)->FactHashTableSize);
-
-  for (theFactHash = FactData (theEnv)->FactHashTable[hashValue];
+  for (theFactHash = *FactHashBucket (theEnv, hashValue);
        theFactHash != NULL; theFactHash = theFactHash->next)
     {
-      if (theFact->hashValue != theFactHash->theFact->hashValue)
+      if (theFact->hashValue != theFactHash->hashValue)
 	{
 	  continue;
 	}
@@ -151,22 +211,25 @@ FactExists (Environment * theEnv, Fact * theFact, size_t hashValue)
 void
 CL_AddHashedFact (Environment * theEnv, Fact * theFact, size_t hashValue)
 {
-  struct factHashEntry *newhash, *temp;
+  struct factHashEntry *newhash, **theBucket;
 
-  if (FactData (theEnv)->NumberOf_Facts >
-      FactData (theEnv)->FactHashTableSize)
+  if (FactData (theEnv)->OldFactHashTable != NULL)
+    {
+      MoveFactHashBuckets (theEnv, FACT_HASH_MOVE_STEP);
+    }
+  else if (FactData (theEnv)->NumberOf_Facts >
+	   FactData (theEnv)->FactHashTableSize)
     {
       ResizeFactHashTable (theEnv);
     }
 
   newhash = get_struct (theEnv, factHashEntry);
   newhash->theFact = theFact;
+  newhash->hashValue = theFact->hashValue;
 
-  hashValue = (hashValue % FactData (theEnv)->FactHashTableSize);
-
-  temp = FactData (theEnv)->FactHashTable[hashValue];
-  FactData (theEnv)->FactHashTable[hashValue] = newhash;
-  newhash->next = temp;
+  theBucket = FactHashBucket (theEnv, hashValue);
+  newhash->next = *theBucket;
+  *theBucket = newhash;
 }
 
 /******************************************/
@@ -176,39 +239,31 @@ CL_AddHashedFact (Environment * theEnv, Fact * theFact, size_t hashValue)
 bool
 CL_RemoveHashedFact (Environment * theEnv, Fact * theFact)
 {
-  size_t hashValue;
-  struct factHashEntry *hptr, *prev;
+  struct factHashEntry *hptr, **hptrPtr;
 
-  hashValue = CL_HashFact (theFact);
-  hashValue = (hashValue % FactData (theEnv)->FactHashTableSize);
+  if (FactData (theEnv)->OldFactHashTable != NULL)
+    {
+      MoveFactHashBuckets (theEnv, FACT_HASH_MOVE_STEP);
+    }
 
-  for (hptr = FactData (theEnv)->FactHashTable[hashValue], prev = NULL;
-       hptr != NULL; hptr = hptr->next)
+   /*=========================================================*/
+  /* The hash value stored when the fact was asserted is the */
+  /* one of its bucket, since the fact isn't hashed again.   */
+   /*=========================================================*/
+
+  for (hptrPtr = FactHashBucket (theEnv, theFact->hashValue);
+       (hptr = *hptrPtr) != NULL; hptrPtr = &hptr->next)
     {
       if (hptr->theFact == theFact)
 	{
-	  if (prev == NULL)
-	    {
-	      FactData (theEnv)->FactHashTable[hashValue] = hptr->next;
-	      rtn_struct (theEnv, factHashEntry, hptr);
-	      if (FactData (theEnv)->NumberOf_Facts == 1)
-		{
-		  CL_ResetFactHashTable (theEnv);
-		}
-	      return true;
-	    }
-	  else
+	  *hptrPtr = hptr->next;
+	  rtn_struct (theEnv, factHashEntry, hptr);
+	  if (FactData (theEnv)->NumberOf_Facts == 1)
 	    {
-	      prev->next = hptr->next;
-	      rtn_struct (theEnv, factHashEntry, hptr);
-	      if (FactData (theEnv)->NumberOf_Facts == 1)
-		{
-		  CL_ResetFactHashTable (theEnv);
-		}
-	      return true;
+	      CL_ResetFactHashTable (theEnv);
 	    }
+	  return true;
 	}
-      prev = hptr;
     }
 
   return false;
@@ -224,7 +279,8 @@ FactWillBe_Asserted (Environment * theEnv, Fact * theFact)
   Fact *tempPtr;
   size_t hashValue;
 
-  if (FactData (theEnv)->FactDuplication)
+  if (FactData (theEnv)->FactDuplication ||
+      theFact->whichDeftemplate->noDuplicateCheck)
     return true;
 
   hashValue = CL_HashFact (theFact);
@@ -315,6 +371,14 @@ CL_InitializeFactHashTable (Environment * theEnv)
   FactData (theEnv)->FactHashTable =
     CL_CreateFactHashTable (theEnv, SIZE_FACT_HASH);
   FactData (theEnv)->FactHashTableSize = SIZE_FACT_HASH;
+  FactData (theEnv)->OldFactHashTable = NULL;
+  FactData (theEnv)->OldFactHashTableSize = 0;
+  FactData (theEnv)->FactHashBucketsMoved = 0;
+
+  FactData (theEnv)->FactIndexTable = NULL;
+  FactData (theEnv)->FactIndexTableSize = 0;
+  FactData (theEnv)->FactIndexTableCount = 0;
+  ResizeFactIndexTable (theEnv, SIZE_FACT_INDEX_HASH);
 }
 
 /*******************************************************************/
@@ -338,33 +402,64 @@ CL_CreateFactHashTable (Environment * theEnv, size_t tableSize)
   return theTable;
 }
 
-/************************/
-/* ResizeFactHashTable: */
-/************************/
+/****************************************************************/
+/* ResizeFactHashTable: Replaces the fact hash table with one   */
+/*   twice as large. The entries of the old table are not all   */
+/*   copied at once, which would stall the assertion which      */
+/*   grows the table: each later addition or removal of a fact  */
+/*   moves a few buckets of the old table to the new one. The   */
+/*   table is then twice as large as the number of facts, so    */
+/*   the old one is empty long before the next resize. Since    */
+/*   the sizes are powers of two, hash values being well mixed, */
+/*   a bucket of the old table only splits into the buckets of  */
+/*   the new table with the same index and that index plus the  */
+/*   old size.                                                  */
+/****************************************************************/
 static void
 ResizeFactHashTable (Environment * theEnv)
 {
-  unsigned long i, newSize, newLocation;
-  struct factHashEntry **theTable, **newTable;
-  struct factHashEntry *theEntry, *nextEntry;
+  unsigned long newSize;
 
-  theTable = FactData (theEnv)->FactHashTable;
+  newSize = FactData (theEnv)->FactHashTableSize * 2;
 
-  newSize = (FactData (theEnv)->FactHashTableSize * 2) + 1;
-  newTable = CL_CreateFactHashTable (theEnv, newSize);
+  FactData (theEnv)->OldFactHashTable = FactData (theEnv)->FactHashTable;
+  FactData (theEnv)->OldFactHashTableSize =
+    FactData (theEnv)->FactHashTableSize;
+  FactData (theEnv)->FactHashBucketsMoved = 0;
+
+  FactData (theEnv)->FactHashTable = CL_CreateFactHashTable (theEnv, newSize);
+  FactData (theEnv)->FactHashTableSize = newSize;
+}
+
+/***************************************************************/
+/* MoveFactHashBuckets: Moves the entries of the next buckets  */
+/*   of the old fact hash table to the new one, then frees the */
+/*   old table once all of its buckets have been moved.        */
+/***************************************************************/
+static void
+MoveFactHashBuckets (Environment * theEnv, unsigned long bucketCount)
+{
+  unsigned long newLocation;
+  struct factHashEntry **theTable, **newTable;
+  struct factHashEntry *theEntry, *nextEntry;
 
-    /*========================================*/
-  /* Copy the old entries to the new table. */
-    /*========================================*/
+  theTable = FactData (theEnv)->OldFactHashTable;
+  newTable = FactData (theEnv)->FactHashTable;
 
-  for (i = 0; i < FactData (theEnv)->FactHashTableSize; i++)
+  while ((bucketCount-- > 0) &&
+	 (FactData (theEnv)->FactHashBucketsMoved <
+	  FactData (theEnv)->OldFactHashTableSize))
     {
-      theEntry = theTable[i];
+      theEntry = theTable[FactData (theEnv)->FactHashBucketsMoved];
+      theTable[FactData (theEnv)->FactHashBucketsMoved] = NULL;
+      FactData (theEnv)->FactHashBucketsMoved++;
+
       while (theEntry != NULL)
 	{
 	  nextEntry = theEntry->next;
 
-	  newLocation = theEntry->theFact->hashValue % newSize;
+	  newLocation =
+	    theEntry->hashValue & (FactData (theEnv)->FactHashTableSize - 1);
 	  theEntry->next = newTable[newLocation];
 	  newTable[newLocation] = theEntry;
 
@@ -372,15 +467,16 @@ ResizeFactHashTable (Environment * theEnv)
 	}
     }
 
-    /*=====================================================*/
-  /* Replace the old hash table with the new hash table. */
-    /*=====================================================*/
-
-  CL_rm (theEnv, theTable,
-	 sizeof (struct factHashEntry *) *
-	 FactData (theEnv)->FactHashTableSize);
-  FactData (theEnv)->FactHashTableSize = newSize;
-  FactData (theEnv)->FactHashTable = newTable;
+  if (FactData (theEnv)->FactHashBucketsMoved ==
+      FactData (theEnv)->OldFactHashTableSize)
+    {
+      CL_rm (theEnv, theTable,
+	     sizeof (struct factHashEntry *) *
+	     FactData (theEnv)->OldFactHashTableSize);
+      FactData (theEnv)->OldFactHashTable = NULL;
+      FactData (theEnv)->OldFactHashTableSize = 0;
+      FactData (theEnv)->FactHashBucketsMoved = 0;
+    }
 }
 
 /***********************/
@@ -391,6 +487,20 @@ CL_ResetFactHashTable (Environment * theEnv)
 {
   struct factHashEntry **newTable;
 
+    /*=========================================*/
+  /* The old table being moved is now empty. */
+    /*=========================================*/
+
+  if (FactData (theEnv)->OldFactHashTable != NULL)
+    {
+      CL_rm (theEnv, FactData (theEnv)->OldFactHashTable,
+	     sizeof (struct factHashEntry *) *
+	     FactData (theEnv)->OldFactHashTableSize);
+      FactData (theEnv)->OldFactHashTable = NULL;
+      FactData (theEnv)->OldFactHashTableSize = 0;
+      FactData (theEnv)->FactHashBucketsMoved = 0;
+    }
+
     /*=============================================*/
   /* Don't reset the table unless the hash table */
   /* has been expanded from its original size.   */
@@ -418,23 +528,168 @@ CL_ResetFactHashTable (Environment * theEnv)
   FactData (theEnv)->FactHashTable = newTable;
 }
 
+/*****************************************************************/
+/* CL_AddIndexedFact: Adds a fact to the table which maps fact   */
+/*   indices to the facts of the fact list. Its size is a power  */
+/*   of two: since fact indices are given in sequence, their low */
+/*   bits spread the facts evenly among the table entries.       */
+/*****************************************************************/
+void
+CL_AddIndexedFact (Environment * theEnv, Fact * theFact)
+{
+  unsigned long location;
+
+  if (FactData (theEnv)->FactIndexTableCount >=
+      FactData (theEnv)->FactIndexTableSize)
+    {
+      ResizeFactIndexTable (theEnv,
+			    FactData (theEnv)->FactIndexTableSize * 2);
+    }
+
+  location = ((unsigned long) theFact->factIndex) &
+    (FactData (theEnv)->FactIndexTableSize - 1);
+
+  theFact->nextIndexedFact = FactData (theEnv)->FactIndexTable[location];
+  FactData (theEnv)->FactIndexTable[location] = theFact;
+  FactData (theEnv)->FactIndexTableCount++;
+}
+
+/*********************************************************/
+/* CL_RemoveIndexedFact: Removes a fact from the table   */
+/*   of fact indices. The table shrinks back to its      */
+/*   original size once the fact list is empty.          */
+/*********************************************************/
+void
+CL_RemoveIndexedFact (Environment * theEnv, Fact * theFact)
+{
+  Fact **factPtr;
+  unsigned long location;
+
+  location = ((unsigned long) theFact->factIndex) &
+    (FactData (theEnv)->FactIndexTableSize - 1);
+
+  for (factPtr = &FactData (theEnv)->FactIndexTable[location];
+       *factPtr != NULL; factPtr = &(*factPtr)->nextIndexedFact)
+    {
+      if (*factPtr == theFact)
+	{
+	  *factPtr = theFact->nextIndexedFact;
+	  theFact->nextIndexedFact = NULL;
+	  FactData (theEnv)->FactIndexTableCount--;
+	  break;
+	}
+    }
+
+  if ((FactData (theEnv)->FactIndexTableCount == 0) &&
+      (FactData (theEnv)->FactIndexTableSize != SIZE_FACT_INDEX_HASH))
+    {
+      ResizeFactIndexTable (theEnv, SIZE_FACT_INDEX_HASH);
+    }
+}
+
+/***********************************************************/
+/* CL_LookupIndexedFact: Returns the fact of the fact list */
+/*   with the specified fact index, or NULL.               */
+/***********************************************************/
+Fact *
+CL_LookupIndexedFact (Environment * theEnv, long long factIndex)
+{
+  Fact *theFact;
+  unsigned long location;
+
+  location = ((unsigned long) factIndex) &
+    (FactData (theEnv)->FactIndexTableSize - 1);
+
+  for (theFact = FactData (theEnv)->FactIndexTable[location];
+       theFact != NULL; theFact = theFact->nextIndexedFact)
+    {
+      if (theFact->factIndex == factIndex)
+	{
+	  return theFact;
+	}
+    }
+
+  return NULL;
+}
+
+/*************************************************************/
+/* ResizeFactIndexTable: Moves the facts of the table of     */
+/*   fact indices into a new table of the specified size.    */
+/*************************************************************/
+static void
+ResizeFactIndexTable (Environment * theEnv, unsigned long newSize)
+{
+  unsigned long i, newLocation;
+  Fact **newTable;
+  Fact *theFact, *nextFact;
+
+  newTable = (Fact **) CL_gm2 (theEnv, sizeof (Fact *) * newSize);
+
+  if (newTable == NULL)
+    CL_ExitRouter (theEnv, EXIT_FAILURE);
+
+  for (i = 0; i < newSize; i++)
+    newTable[i] = NULL;
+
+  for (i = 0; i < FactData (theEnv)->FactIndexTableSize; i++)
+    {
+      for (theFact = FactData (theEnv)->FactIndexTable[i];
+	   theFact != NULL; theFact = nextFact)
+	{
+	  nextFact = theFact->nextIndexedFact;
+	  newLocation = ((unsigned long) theFact->factIndex) & (newSize - 1);
+	  theFact->nextIndexedFact = newTable[newLocation];
+	  newTable[newLocation] = theFact;
+	}
+    }
+
+  if (FactData (theEnv)->FactIndexTable != NULL)
+    {
+      CL_rm (theEnv, FactData (theEnv)->FactIndexTable,
+	     sizeof (Fact *) * FactData (theEnv)->FactIndexTableSize);
+    }
+
+  FactData (theEnv)->FactIndexTableSize = newSize;
+  FactData (theEnv)->FactIndexTable = newTable;
+}
+
 #if DEVELOPER
 
 /****************************************************/
 /* ShowFactHashTableCommand: Displays the number of */
-/*   entries in each slot of the fact hash table.   */
+/*   entries in each slot of the fact hash table,   */
+/*   then of the old table while the table grows.   */
 /****************************************************/
 void
 ShowFactHashTableCommand (Environment * theEnv,
 			  UDFContext * context, UDFValue * returnValue)
+{
+  ShowFactHashBuckets (theEnv, FactData (theEnv)->FactHashTable,
+		       FactData (theEnv)->FactHashTableSize);
+
+  if (FactData (theEnv)->OldFactHashTable != NULL)
+    {
+      CL_WriteString (theEnv, STDOUT, "old:\n");
+      ShowFactHashBuckets (theEnv, FactData (theEnv)->OldFactHashTable,
+			   FactData (theEnv)->OldFactHashTableSize);
+    }
+}
+
+/*******************************************************/
+/* ShowFactHashBuckets: Displays the number of entries */
+/*   in each slot of a fact hash table.                */
+/*******************************************************/
+static void
+ShowFactHashBuckets (Environment * theEnv,
+		     struct factHashEntry **theTable, unsigned long tableSize)
 {
   unsigned long i, count;
   struct factHashEntry *theEntry;
-  char buffer[20];
+  char buffer[50];
 
-  for (i = 0; i < FactData (theEnv)->FactHashTableSize; i++)
+  for (i = 0; i < tableSize; i++)
     {
-      for (theEntry = FactData (theEnv)->FactHashTable[i], count = 0;
+      for (theEntry = theTable[i], count = 0;
 	   theEntry != NULL; theEntry = theEntry->next)
 	{
 	  count++;
@@ -442,7 +697,7 @@ ShowFactHashTableCommand (Environment * theEnv,
 
       if (count != 0)
 	{
-	  CL_gensprintf (buffer, "%4lu: %4d\n", i, count);
+	  CL_gensprintf (buffer, "%4lu: %4lu\n", i, count);
 	  CL_WriteString (theEnv, STDOUT, buffer);
 	}
     }
@@ -49,9 +49,15 @@
 /*************************************************************/
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "setup.h"
 
+#if ALPHA_MATCH_THREADS
+#include <pthread.h>
+#endif
+
 #if DEFTEMPLATE_CONSTRUCT && DEFRULE_CONSTRUCT
 
 #include "drive.h"
@@ -61,8 +67,10 @@
 #include "factgen.h"
 #include "factrete.h"
 #include "incrrset.h"
+#include "lgcldpnd.h"
 #include "memalloc.h"
 #include "prntutil.h"
+#include "retract.h"
 #include "reteutil.h"
 #include "router.h"
 #include "sysdep.h"
@@ -70,6 +78,41 @@
 
 #include "factmch.h"
 
+#if ALPHA_MATCH_THREADS
+
+/***************************************************************/
+/* alphaWorkerMatch: A pattern node reached by a fact of a     */
+/*   batch of assertions in a worker thread. The fact is given */
+/*   by its position in the array of deferred facts.           */
+/***************************************************************/
+struct alphaWorkerMatch
+{
+  size_t whichFact;
+  struct factPatternNode *thePattern;
+};
+
+/*****************************************************************/
+/* alphaMatchWorker: The range of deferred facts pattern matched */
+/*   by a worker thread, and the pattern nodes they reached. A   */
+/*   fact needing more than the constant tests of the pattern    */
+/*   network is flagged to be matched again by the main thread.  */
+/*   Since the memory functions of CLIPS are not thread safe,    */
+/*   the matches are allocated with malloc.                      */
+/*****************************************************************/
+struct alphaMatchWorker
+{
+  Environment *theEnv;
+  Fact **theFacts;
+  bool *mainThreadFacts;
+  size_t firstFact;
+  size_t lastFact;
+  struct alphaWorkerMatch *matches;
+  size_t matchCount;
+  size_t matchMax;
+};
+
+#endif
+
 /***************************************/
 /* LOCAL INTERNAL FUNCTION DEFINITIONS */
 /***************************************/
@@ -85,11 +128,42 @@ static struct factPatternNode *CL_GetNextFactPatternNode (Environment *, bool,
 							  struct
 							  factPatternNode *);
 static bool SkipFactPatternNode (Environment *, struct factPatternNode *);
+static void MatchBelowMultifield (Environment *,
+				  struct factPatternNode *, size_t,
+				  size_t, size_t, size_t,
+				  struct multifieldMarker *);
+static struct factPatternMemo *FindFactPatternMemo (Environment *,
+						    struct factPatternNode
+						    *, size_t);
 static void ProcessMultifieldNode (Environment *,
 				   struct factPatternNode *,
 				   struct multifieldMarker *,
 				   struct multifieldMarker *, size_t, size_t);
 static void PatternNetErrorMessage (Environment *, struct factPatternNode *);
+static void DriveFactAlphaMatch (Environment *, Fact *,
+				 struct multifieldMarker *,
+				 struct factPatternNode *, unsigned long);
+static void QueueBatchAlphaMatch (Environment *, Fact *,
+				  struct multifieldMarker *,
+				  struct factPatternNode *, unsigned long);
+static void ReturnBatchMarkers (Environment *, struct multifieldMarker *);
+static int BatchPatternCompare (const void *, const void *);
+static int BatchGroupCompare (const void *, const void *);
+#if ALPHA_MATCH_THREADS
+static void MatchDeferredFacts (Environment *);
+static void *AlphaMatchThread (void *);
+static void AlphaMatchFacts (struct alphaMatchWorker *);
+static bool AlphaMatchFact (struct alphaMatchWorker *, size_t, Fact *);
+static bool AddAlphaWorkerMatch (struct alphaMatchWorker *, size_t,
+				 struct factPatternNode *);
+static bool AlphaWorkerTest (Environment *, Fact *, struct expr *,
+			     bool *);
+static bool AlphaWorkerSlotValue (Fact *, struct expr *, unsigned short *,
+				  void **);
+static struct factPatternNode *NextAlphaWorkerNode (bool,
+						    struct factPatternNode
+						    *);
+#endif
 
 /*************************************************************************/
 /* CL_FactPatternMatch: Implements the core loop for fact pattern matching. */
@@ -117,6 +191,17 @@ CL_FactPatternMatch (Environment * theEnv,
   if (patternPtr == NULL)
     return;
 
+   /*=====================================================*/
+  /* A new traversal of the pattern network for a fact   */
+  /* invalidates the failures remembered for the markers */
+  /* of the previous fact.                               */
+   /*=====================================================*/
+
+  if ((markers == NULL) && (endMark == NULL))
+    {
+      FactData (theEnv)->PatternMemoGeneration++;
+    }
+
    /*=======================================================*/
   /* The offsetSlot variable indicates the current offset  */
   /* within the multifield slot being pattern matched.     */
@@ -188,8 +273,8 @@ CL_FactPatternMatch (Environment * theEnv,
 	       false :
 	       (FactData (theEnv)->CurrentPatternMarks->where.
 		whichSlotNumber == patternPtr->whichSlot))
-	      && (FactData (theEnv)->CurrentPatternFact->theProposition.
-		  contents[patternPtr->whichSlot].header->type ==
+	      && (FactSlotContents (theEnv, FactData (theEnv)->CurrentPatternFact,
+				    patternPtr->whichSlot)->header->type ==
 		  MULTIFIELD_TYPE))
 	    {
 	      if ((patternPtr->leaveFields + theSlotField) !=
@@ -343,9 +428,9 @@ ProcessMultifieldNode (Environment * theEnv,
 		       struct multifieldMarker *endMark,
 		       size_t offset, size_t multifieldsProcessed)
 {
-  struct multifieldMarker *newMark, *oldMark;
+  struct multifieldMarker theMark, *newMark, *oldMark, *tempMark;
   size_t fieldsRe_maining;
-  size_t i;
+  size_t i, markIndex;
   size_t repeatCount;
   Multifield *theSlotValue;
   UDFValue theResult;
@@ -358,8 +443,8 @@ ProcessMultifieldNode (Environment * theEnv,
    /*========================================*/
 
   theSlotValue =
-    FactData (theEnv)->CurrentPatternFact->theProposition.
-    contents[thePattern->whichSlot].multifieldValue;
+    FactSlotContents (theEnv, FactData (theEnv)->CurrentPatternFact,
+		      thePattern->whichSlot)->multifieldValue;
 
    /*===============================================*/
   /* CL_Save the value of the markers already stored. */
@@ -367,12 +452,15 @@ ProcessMultifieldNode (Environment * theEnv,
 
   oldMark = markers;
 
-   /*===========================================*/
-  /* Create a new multifield marker and append */
-  /* it to the end of the current list.        */
-   /*===========================================*/
+   /*=========================================================*/
+  /* Create a new multifield marker and append it to the end */
+  /* of the current list. The marker only lasts for the      */
+  /* matching beneath this node (alpha matches copy the list */
+  /* of markers), so it is kept on the stack rather than     */
+  /* allocated for each binding of each fact.                */
+   /*=========================================================*/
 
-  newMark = get_struct (theEnv, multifieldMarker);
+  newMark = &theMark;
 
   newMark->whichField = thePattern->whichField - 1;
   newMark->where.whichSlotNumber = thePattern->whichSlot;
@@ -390,6 +478,12 @@ ProcessMultifieldNode (Environment * theEnv,
       endMark->next = newMark;
     }
 
+  markIndex = 1;
+  for (tempMark = markers; tempMark != newMark; tempMark = tempMark->next)
+    {
+      markIndex++;
+    }
+
    /*============================================*/
   /* Handle a multifield constraint as the last */
   /* constraint of a slot as a special case.    */
@@ -476,19 +570,16 @@ ProcessMultifieldNode (Environment * theEnv,
 	  /* on the multifield binding just generated.   */
 	 /*=============================================*/
 
-	  CL_FactPatternMatch (theEnv, FactData (theEnv)->CurrentPatternFact,
-			       thePattern->nextLevel, 0, 0,
-			       FactData (theEnv)->CurrentPatternMarks,
-			       newMark);
+	  MatchBelowMultifield (theEnv, thePattern, theSlotValue->length,
+				markIndex, 0, 0, newMark);
 	}
 
       /*================================================*/
-      /* Discard the multifield marker since we've done */
+      /* Unlink the multifield marker since we've done  */
       /* all the pattern matching for this binding of   */
       /* the multifield slot constraint.                */
       /*================================================*/
 
-      rtn_struct (theEnv, multifieldMarker, newMark);
       if (endMark != NULL)
 	endMark->next = NULL;
       FactData (theEnv)->CurrentPatternMarks = oldMark;
@@ -502,7 +593,6 @@ ProcessMultifieldNode (Environment * theEnv,
   if (theSlotValue->length <
       (newMark->startPosition + thePattern->leaveFields))
     {
-      rtn_struct (theEnv, multifieldMarker, newMark);
       if (endMark != NULL)
 	endMark->next = NULL;
       FactData (theEnv)->CurrentPatternMarks = oldMark;
@@ -540,13 +630,10 @@ ProcessMultifieldNode (Environment * theEnv,
 								     value);
 	      if (tempPtr != NULL)
 		{
-		  CL_FactPatternMatch (theEnv,
-				       FactData (theEnv)->CurrentPatternFact,
-				       tempPtr->nextLevel,
-				       offset + repeatCount,
-				       multifieldsProcessed + 1,
-				       FactData (theEnv)->CurrentPatternMarks,
-				       newMark);
+		  MatchBelowMultifield (theEnv, tempPtr,
+					newMark->startPosition + repeatCount,
+					markIndex, offset + repeatCount,
+					multifieldsProcessed + 1, newMark);
 		}
 	    }
 	}
@@ -555,24 +642,111 @@ ProcessMultifieldNode (Environment * theEnv,
 	       (CL_EvaluatePatternExpression
 		(theEnv, thePattern, thePattern->networkTest)))
 	{
-	  CL_FactPatternMatch (theEnv, FactData (theEnv)->CurrentPatternFact,
-			       thePattern->nextLevel, offset + repeatCount,
-			       multifieldsProcessed + 1,
-			       FactData (theEnv)->CurrentPatternMarks,
-			       newMark);
+	  MatchBelowMultifield (theEnv, thePattern,
+				newMark->startPosition + repeatCount,
+				markIndex, offset + repeatCount,
+				multifieldsProcessed + 1, newMark);
 	}
     }
 
-    /*======================================================*/
-  /* Get rid of the marker created for a multifield node. */
-    /*======================================================*/
+    /*==================================================*/
+  /* Unlink the marker created for a multifield node. */
+    /*==================================================*/
 
-  rtn_struct (theEnv, multifieldMarker, newMark);
   if (endMark != NULL)
     endMark->next = NULL;
   FactData (theEnv)->CurrentPatternMarks = oldMark;
 }
 
+/*****************************************************************/
+/* MatchBelowMultifield: Pattern matches the nodes beneath a     */
+/*   multifield node once it is bound up to a position of its    */
+/*   slot. The nodes beneath are not matched again if they       */
+/*   produced no alpha match from that position before. That     */
+/*   is only remembered when their tests did not read a field    */
+/*   whose position depends on the bindings of the multifield    */
+/*   markers up to this one (markIndex is the index of this      */
+/*   marker in the list of markers, starting at one).            */
+/*****************************************************************/
+static void
+MatchBelowMultifield (Environment * theEnv,
+		      struct factPatternNode *thePattern,
+		      size_t position,
+		      size_t markIndex,
+		      size_t offset,
+		      size_t multifieldsProcessed,
+		      struct multifieldMarker *endMark)
+{
+  struct factPatternMemo *theMemo;
+  unsigned long matchCount;
+  size_t savedMark;
+
+  if (thePattern->nextLevel == NULL)
+    return;
+
+  theMemo = FindFactPatternMemo (theEnv, thePattern, position);
+  if ((theMemo->generation == FactData (theEnv)->PatternMemoGeneration) &&
+      (theMemo->thePattern == thePattern) && (theMemo->position == position))
+    {
+      return;
+    }
+
+  matchCount = FactData (theEnv)->PatternMatchCount;
+  savedMark = FactData (theEnv)->PatternMemoMark;
+  FactData (theEnv)->PatternMemoMark = SIZE_MAX;
+
+  CL_FactPatternMatch (theEnv, FactData (theEnv)->CurrentPatternFact,
+		       thePattern->nextLevel, offset, multifieldsProcessed,
+		       FactData (theEnv)->CurrentPatternMarks, endMark);
+
+   /*===========================================================*/
+  /* The entry is looked up again, since the nodes beneath may */
+  /* have replaced it with one of their own.                   */
+   /*===========================================================*/
+
+  if ((matchCount == FactData (theEnv)->PatternMatchCount) &&
+      (FactData (theEnv)->PatternMemoMark >= markIndex) &&
+      (!CL_EvaluationData (theEnv)->CL_HaltExecution))
+    {
+      theMemo = FindFactPatternMemo (theEnv, thePattern, position);
+      theMemo->thePattern = thePattern;
+      theMemo->position = position;
+      theMemo->generation = FactData (theEnv)->PatternMemoGeneration;
+    }
+
+  if (savedMark < FactData (theEnv)->PatternMemoMark)
+    {
+      FactData (theEnv)->PatternMemoMark = savedMark;
+    }
+}
+
+/**********************************************************/
+/* FindFactPatternMemo: Returns the entry of the table of */
+/*   pattern matching failures for a node and a position. */
+/*   The table is a cache: colliding entries replace each */
+/*   other.                                               */
+/**********************************************************/
+static struct factPatternMemo *
+FindFactPatternMemo (Environment * theEnv,
+		     struct factPatternNode *thePattern, size_t position)
+{
+  size_t theHash;
+
+  if (FactData (theEnv)->PatternMemo == NULL)
+    {
+      FactData (theEnv)->PatternMemo = (struct factPatternMemo *)
+	CL_genalloc (theEnv,
+		     sizeof (struct factPatternMemo) * FACT_PATTERN_MEMO_SIZE);
+      memset (FactData (theEnv)->PatternMemo, 0,
+	      sizeof (struct factPatternMemo) * FACT_PATTERN_MEMO_SIZE);
+    }
+
+  theHash = (((size_t) thePattern) >> 4) + (position * 7919);
+  theHash ^= theHash >> 11;
+
+  return &FactData (theEnv)->PatternMemo[theHash % FACT_PATTERN_MEMO_SIZE];
+}
+
 /******************************************************/
 /* CL_GetNextFactPatternNode: Returns the next node in a */
 /*   pattern network tree to be traversed. The next   */
@@ -662,9 +836,6 @@ ProcessFactAlphaMatch (Environment * theEnv,
 		       struct multifieldMarker *theMarks,
 		       struct factPatternNode *thePattern)
 {
-  struct partialMatch *theMatch;
-  struct patternMatch *listOf_Matches;
-  struct joinNode *listOfJoins;
   unsigned long hashValue;
 
   /*============================================*/
@@ -672,6 +843,41 @@ ProcessFactAlphaMatch (Environment * theEnv,
   /*============================================*/
 
   hashValue = CL_ComputeRightHashValue (theEnv, &thePattern->header);
+  FactData (theEnv)->PatternMatchCount++;
+
+  /*=================================================*/
+  /* The alpha matches of a batch of assertions are  */
+  /* sent to the joins when the batch ends. They are */
+  /* not yet stored in the alpha memory, since a     */
+  /* join must not find an alpha match there before  */
+  /* the match has been sent to it.                  */
+  /*=================================================*/
+
+  if (FactData (theEnv)->BatchingAlphaMatches)
+    {
+      QueueBatchAlphaMatch (theEnv, theFact, theMarks, thePattern,
+			    hashValue);
+      return;
+    }
+
+  DriveFactAlphaMatch (theEnv, theFact, theMarks, thePattern, hashValue);
+}
+
+/*****************************************************************/
+/* DriveFactAlphaMatch: Stores an alpha match of a fact into the */
+/*   alpha memory of its pattern and sends it to the joins       */
+/*   connected to the pattern.                                   */
+/*****************************************************************/
+static void
+DriveFactAlphaMatch (Environment * theEnv,
+		     Fact * theFact,
+		     struct multifieldMarker *theMarks,
+		     struct factPatternNode *thePattern,
+		     unsigned long hashValue)
+{
+  struct partialMatch *theMatch;
+  struct patternMatch *listOf_Matches;
+  struct joinNode *listOfJoins;
 
   /*===========================================*/
   /* Create the partial match for the pattern. */
@@ -698,13 +904,836 @@ ProcessFactAlphaMatch (Environment * theEnv,
   /* CL_Send the partial match to the joins connected to this pattern. */
   /*================================================================*/
 
-  for (listOfJoins = thePattern->header.entryJoin;
-       listOfJoins != NULL; listOfJoins = listOfJoins->rightMatchNode)
+  for (listOfJoins = CL_FirstActiveJoin (&thePattern->header);
+       listOfJoins != NULL; listOfJoins = CL_NextActiveJoin (listOfJoins))
     {
       Network_Assert (theEnv, theMatch, listOfJoins);
     }
 }
 
+/******************************************************************/
+/* QueueBatchAlphaMatch: Keeps an alpha match of a fact asserted  */
+/*   while a batch of assertions is open. The multifield markers  */
+/*   are copied, since they only last for the pattern matching of */
+/*   the fact.                                                    */
+/******************************************************************/
+static void
+QueueBatchAlphaMatch (Environment * theEnv,
+		      Fact * theFact,
+		      struct multifieldMarker *theMarks,
+		      struct factPatternNode *thePattern,
+		      unsigned long hashValue)
+{
+  struct batchAlphaMatch *theBatchMatch;
+
+  theBatchMatch = get_struct (theEnv, batchAlphaMatch);
+  theBatchMatch->theFact = theFact;
+  theBatchMatch->markers = (theMarks == NULL) ? NULL :
+    CL_CopyMultifieldMarkers (theEnv, theMarks);
+  theBatchMatch->thePattern = thePattern;
+  theBatchMatch->hashValue = hashValue;
+  theBatchMatch->position = FactData (theEnv)->BatchAlphaMatchCount++;
+  theBatchMatch->groupPosition = 0;
+  theBatchMatch->next = NULL;
+
+  if (FactData (theEnv)->LastBatchAlphaMatch == NULL)
+    {
+      FactData (theEnv)->BatchAlphaMatches = theBatchMatch;
+    }
+  else
+    {
+      FactData (theEnv)->LastBatchAlphaMatch->next = theBatchMatch;
+    }
+  FactData (theEnv)->LastBatchAlphaMatch = theBatchMatch;
+}
+
+/*********************************************************/
+/* ReturnBatchMarkers: Returns the multifield markers of */
+/*   an alpha match kept for a batch of assertions.      */
+/*********************************************************/
+static void
+ReturnBatchMarkers (Environment * theEnv, struct multifieldMarker *theMarks)
+{
+  struct multifieldMarker *nextMark;
+
+  while (theMarks != NULL)
+    {
+      nextMark = theMarks->next;
+      rtn_struct (theEnv, multifieldMarker, theMarks);
+      theMarks = nextMark;
+    }
+}
+
+/***************************************************/
+/* BatchPatternCompare: Orders the alpha matches of */
+/*   a batch by pattern, then by position.         */
+/***************************************************/
+static int
+BatchPatternCompare (const void *p1, const void *p2)
+{
+  const struct batchAlphaMatch *m1 = *(struct batchAlphaMatch *const *) p1;
+  const struct batchAlphaMatch *m2 = *(struct batchAlphaMatch *const *) p2;
+
+  if (m1->thePattern != m2->thePattern)
+    {
+      return (m1->thePattern < m2->thePattern) ? -1 : 1;
+    }
+
+  return (m1->position < m2->position) ? -1 :
+    ((m1->position > m2->position) ? 1 : 0);
+}
+
+/*****************************************************************/
+/* BatchGroupCompare: Orders the alpha matches of a batch by the */
+/*   position of the first match of their pattern, so patterns   */
+/*   are handled in the order they were first matched, then by   */
+/*   position, so the matches of a pattern reach its joins, and  */
+/*   make activations, in the order their facts were asserted.   */
+/*****************************************************************/
+static int
+BatchGroupCompare (const void *p1, const void *p2)
+{
+  const struct batchAlphaMatch *m1 = *(struct batchAlphaMatch *const *) p1;
+  const struct batchAlphaMatch *m2 = *(struct batchAlphaMatch *const *) p2;
+
+  if (m1->groupPosition != m2->groupPosition)
+    {
+      return (m1->groupPosition < m2->groupPosition) ? -1 : 1;
+    }
+
+  return (m1->position < m2->position) ? -1 :
+    ((m1->position > m2->position) ? 1 : 0);
+}
+
+/******************************************************************/
+/* CL_FlushBatchAlphaMatches: Sends the alpha matches kept for a     */
+/*   batch of assertions to the join network. The matches of each */
+/*   pattern are sent one after the other, so the same joins and  */
+/*   beta memories are used while they are in the cache. Each     */
+/*   match is still sent to all the joins of its pattern before   */
+/*   the next one is stored, since a partial match derived from   */
+/*   it may reach a join whose alpha memory is the same.          */
+/******************************************************************/
+void
+CL_FlushBatchAlphaMatches (Environment * theEnv)
+{
+  struct batchAlphaMatch *theBatchMatch, **theArray;
+  unsigned long i, count, groupPosition = 0;
+
+  if (EngineData (theEnv)->JoinOperationInProgress)
+    {
+      return;
+    }
+
+#if ALPHA_MATCH_THREADS
+  if (FactData (theEnv)->DeferredFactCount > 0)
+    {
+      MatchDeferredFacts (theEnv);
+    }
+#endif
+
+  if (FactData (theEnv)->BatchAlphaMatches == NULL)
+    {
+      return;
+    }
+
+   /*=====================================================*/
+  /* Detach the matches, then order them in an array. A  */
+  /* pattern node has no index, so the matches are first */
+  /* grouped by sorting them on the pattern address, and */
+  /* each group is then given the position of its first  */
+  /* match so the order does not depend on addresses.    */
+   /*=====================================================*/
+
+  count = FactData (theEnv)->BatchAlphaMatchCount;
+  theArray = (struct batchAlphaMatch **)
+    CL_genalloc (theEnv, sizeof (struct batchAlphaMatch *) * count);
+
+  for (i = 0, theBatchMatch = FactData (theEnv)->BatchAlphaMatches;
+       theBatchMatch != NULL; i++, theBatchMatch = theBatchMatch->next)
+    {
+      theArray[i] = theBatchMatch;
+    }
+
+  FactData (theEnv)->BatchAlphaMatches = NULL;
+  FactData (theEnv)->LastBatchAlphaMatch = NULL;
+  FactData (theEnv)->BatchAlphaMatchCount = 0;
+
+  qsort (theArray, count, sizeof (struct batchAlphaMatch *),
+	 BatchPatternCompare);
+
+  for (i = 0; i < count; i++)
+    {
+      if ((i == 0) || (theArray[i]->thePattern != theArray[i - 1]->thePattern))
+	{
+	  groupPosition = theArray[i]->position;
+	}
+      theArray[i]->groupPosition = groupPosition;
+    }
+
+  qsort (theArray, count, sizeof (struct batchAlphaMatch *),
+	 BatchGroupCompare);
+
+   /*===============================*/
+  /* Send the matches to the joins. */
+   /*===============================*/
+
+  Set_EvaluationError (theEnv, false);
+
+  EngineData (theEnv)->JoinOperationInProgress = true;
+  for (i = 0; i < count; i++)
+    {
+      theBatchMatch = theArray[i];
+      FactData (theEnv)->CurrentPatternFact = theBatchMatch->theFact;
+      FactData (theEnv)->CurrentPatternMarks = theBatchMatch->markers;
+      DriveFactAlphaMatch (theEnv, theBatchMatch->theFact,
+			   theBatchMatch->markers, theBatchMatch->thePattern,
+			   theBatchMatch->hashValue);
+      ReturnBatchMarkers (theEnv, theBatchMatch->markers);
+      rtn_struct (theEnv, batchAlphaMatch, theBatchMatch);
+    }
+  EngineData (theEnv)->JoinOperationInProgress = false;
+
+  CL_genfree (theEnv, theArray, sizeof (struct batchAlphaMatch *) * count);
+
+   /*===================================================*/
+  /* CL_Retract other facts that were logically dependent */
+  /* on the non-existence of the facts just matched,   */
+  /* then free the partial matches that were released. */
+   /*===================================================*/
+
+  CL_ForceLogical_Retractions (theEnv);
+
+  if (EngineData (theEnv)->ExecutingRule == NULL)
+    CL_FlushGarbagePartial_Matches (theEnv);
+
+  if (CL_EvaluationData (theEnv)->CL_EvaluationError)
+    {
+      FactData (theEnv)->assertError = AE_RULE_NETWORK_ERROR;
+    }
+}
+
+/**************************************************************/
+/* CL_ReturnBatchAlphaMatches: Returns the alpha matches still   */
+/*   kept for a batch of assertions when the environment is   */
+/*   deallocated.                                             */
+/**************************************************************/
+void
+CL_ReturnBatchAlphaMatches (Environment * theEnv)
+{
+  struct batchAlphaMatch *theBatchMatch, *nextBatchMatch;
+
+  for (theBatchMatch = FactData (theEnv)->BatchAlphaMatches;
+       theBatchMatch != NULL; theBatchMatch = nextBatchMatch)
+    {
+      nextBatchMatch = theBatchMatch->next;
+      ReturnBatchMarkers (theEnv, theBatchMatch->markers);
+      rtn_struct (theEnv, batchAlphaMatch, theBatchMatch);
+    }
+
+  FactData (theEnv)->BatchAlphaMatches = NULL;
+  FactData (theEnv)->LastBatchAlphaMatch = NULL;
+  FactData (theEnv)->BatchAlphaMatchCount = 0;
+
+  if (FactData (theEnv)->DeferredFacts != NULL)
+    {
+      CL_genfree (theEnv, FactData (theEnv)->DeferredFacts,
+		  sizeof (Fact *) * FactData (theEnv)->DeferredFactMax);
+    }
+
+  FactData (theEnv)->DeferredFacts = NULL;
+  FactData (theEnv)->DeferredFactCount = 0;
+  FactData (theEnv)->DeferredFactMax = 0;
+}
+
+/*************************************************************/
+/* CL_ReturnFactPatternMemo: Frees the table of the failures */
+/*   remembered while pattern matching multifield slots.     */
+/*************************************************************/
+void
+CL_ReturnFactPatternMemo (Environment * theEnv)
+{
+  if (FactData (theEnv)->PatternMemo != NULL)
+    {
+      CL_genfree (theEnv, FactData (theEnv)->PatternMemo,
+		  sizeof (struct factPatternMemo) * FACT_PATTERN_MEMO_SIZE);
+      FactData (theEnv)->PatternMemo = NULL;
+    }
+}
+
+/******************************************************************/
+/* CL_DeferFactPatternMatch: Called when a fact is asserted while */
+/*   a batch of assertions is open. When worker threads are used  */
+/*   for pattern matching, the fact is kept until the batch is    */
+/*   flushed and true is returned. Otherwise false is returned,   */
+/*   and the fact must be pattern matched right away.             */
+/******************************************************************/
+bool
+CL_DeferFactPatternMatch (Environment * theEnv, Fact * theFact)
+{
+#if ALPHA_MATCH_THREADS
+  Fact **newArray;
+  size_t newMax;
+
+  if ((FactData (theEnv)->AssertBatchDepth == 0) ||
+      (FactData (theEnv)->AlphaMatchThreads < 2) ||
+      EngineData (theEnv)->CL_Incremental_ResetInProgress)
+    {
+      return false;
+    }
+
+  if (FactData (theEnv)->DeferredFactCount ==
+      FactData (theEnv)->DeferredFactMax)
+    {
+      newMax = (FactData (theEnv)->DeferredFactMax == 0) ?
+	ALPHA_MATCH_THREAD_FACTS : FactData (theEnv)->DeferredFactMax * 2;
+      newArray = (Fact **) CL_genalloc (theEnv, sizeof (Fact *) * newMax);
+
+      if (FactData (theEnv)->DeferredFacts != NULL)
+	{
+	  memcpy (newArray, FactData (theEnv)->DeferredFacts,
+		  sizeof (Fact *) * FactData (theEnv)->DeferredFactCount);
+	  CL_genfree (theEnv, FactData (theEnv)->DeferredFacts,
+		      sizeof (Fact *) * FactData (theEnv)->DeferredFactMax);
+	}
+
+      FactData (theEnv)->DeferredFacts = newArray;
+      FactData (theEnv)->DeferredFactMax = newMax;
+    }
+
+  FactData (theEnv)->DeferredFacts[FactData (theEnv)->DeferredFactCount++] =
+    theFact;
+
+  return true;
+#else
+#if MAC_XCD
+#pragma unused(theEnv,theFact)
+#endif
+  return false;
+#endif
+}
+
+#if ALPHA_MATCH_THREADS
+
+/*******************************************************************/
+/* MatchDeferredFacts: Pattern matches the facts asserted while a  */
+/*   batch of assertions was open. The facts are split in ranges   */
+/*   matched by worker threads, which only evaluate the constant   */
+/*   tests of the pattern network and record the pattern nodes     */
+/*   reached. Then, in the order of assertion, the alpha matches   */
+/*   found are queued for the batch, and the facts the workers     */
+/*   could not match are pattern matched as usual.                 */
+/*******************************************************************/
+static void
+MatchDeferredFacts (Environment * theEnv)
+{
+  Fact **theFacts;
+  size_t count, maxCount, i, w, m;
+  unsigned int threadCount;
+  struct alphaMatchWorker *theWorkers;
+  pthread_t *theThreads;
+  bool *mainThreadFacts, *started;
+
+  theFacts = FactData (theEnv)->DeferredFacts;
+  count = FactData (theEnv)->DeferredFactCount;
+  maxCount = FactData (theEnv)->DeferredFactMax;
+
+  FactData (theEnv)->DeferredFacts = NULL;
+  FactData (theEnv)->DeferredFactCount = 0;
+  FactData (theEnv)->DeferredFactMax = 0;
+
+   /*=====================================================*/
+  /* Use no more threads than there are ranges of facts. */
+   /*=====================================================*/
+
+  threadCount = FactData (theEnv)->AlphaMatchThreads;
+  if (threadCount > (count / ALPHA_MATCH_THREAD_FACTS))
+    {
+      threadCount = (unsigned int) (count / ALPHA_MATCH_THREAD_FACTS);
+    }
+  if (threadCount == 0)
+    {
+      threadCount = 1;
+    }
+
+  theWorkers = (struct alphaMatchWorker *)
+    CL_genalloc (theEnv, sizeof (struct alphaMatchWorker) * threadCount);
+  theThreads = (pthread_t *)
+    CL_genalloc (theEnv, sizeof (pthread_t) * threadCount);
+  started = (bool *) CL_genalloc (theEnv, sizeof (bool) * threadCount);
+  mainThreadFacts = (bool *) CL_genalloc (theEnv, sizeof (bool) * count);
+
+  for (i = 0; i < count; i++)
+    {
+      mainThreadFacts[i] = (threadCount < 2);
+    }
+
+  for (w = 0; w < threadCount; w++)
+    {
+      theWorkers[w].theEnv = theEnv;
+      theWorkers[w].theFacts = theFacts;
+      theWorkers[w].mainThreadFacts = mainThreadFacts;
+      theWorkers[w].firstFact = (count * w) / threadCount;
+      theWorkers[w].lastFact = (count * (w + 1)) / threadCount;
+      theWorkers[w].matches = NULL;
+      theWorkers[w].matchCount = 0;
+      theWorkers[w].matchMax = 0;
+      started[w] = false;
+    }
+
+   /*=====================================================*/
+  /* The main thread matches the first range itself. The */
+  /* range of a thread which cannot be started is left   */
+  /* to the main thread too.                             */
+   /*=====================================================*/
+
+  if (threadCount > 1)
+    {
+      for (w = 1; w < threadCount; w++)
+	{
+	  started[w] = (pthread_create (&theThreads[w], NULL,
+					AlphaMatchThread,
+					&theWorkers[w]) == 0);
+	}
+
+      AlphaMatchFacts (&theWorkers[0]);
+
+      for (w = 1; w < threadCount; w++)
+	{
+	  if (started[w])
+	    {
+	      pthread_join (theThreads[w], NULL);
+	    }
+	  else
+	    {
+	      AlphaMatchFacts (&theWorkers[w]);
+	    }
+	}
+    }
+
+   /*=================================================*/
+  /* Queue the alpha matches in the order the facts  */
+  /* were asserted. The hash value of a match may    */
+  /* evaluate expressions, so it is computed here.   */
+   /*=================================================*/
+
+  FactData (theEnv)->BatchingAlphaMatches = true;
+  EngineData (theEnv)->JoinOperationInProgress = true;
+
+  for (w = 0; w < threadCount; w++)
+    {
+      m = 0;
+      for (i = theWorkers[w].firstFact; i < theWorkers[w].lastFact; i++)
+	{
+	  if (theFacts[i]->garbage)
+	    {
+	      continue;
+	    }
+
+	  if (mainThreadFacts[i])
+	    {
+	      CL_FactPatternMatch (theEnv, theFacts[i],
+				   theFacts[i]->whichDeftemplate->
+				   patternNetwork, 0, 0, NULL, NULL);
+	      continue;
+	    }
+
+	  for (; (m < theWorkers[w].matchCount) &&
+	       (theWorkers[w].matches[m].whichFact == i); m++)
+	    {
+	      FactData (theEnv)->CurrentPatternFact = theFacts[i];
+	      FactData (theEnv)->CurrentPatternMarks = NULL;
+	      ProcessFactAlphaMatch (theEnv, theFacts[i], NULL,
+				     theWorkers[w].matches[m].thePattern);
+	    }
+	}
+
+      free (theWorkers[w].matches);
+    }
+
+  EngineData (theEnv)->JoinOperationInProgress = false;
+  FactData (theEnv)->BatchingAlphaMatches = false;
+
+  CL_genfree (theEnv, mainThreadFacts, sizeof (bool) * count);
+  CL_genfree (theEnv, started, sizeof (bool) * threadCount);
+  CL_genfree (theEnv, theThreads, sizeof (pthread_t) * threadCount);
+  CL_genfree (theEnv, theWorkers,
+	      sizeof (struct alphaMatchWorker) * threadCount);
+  CL_genfree (theEnv, theFacts, sizeof (Fact *) * maxCount);
+
+  if (CL_EvaluationData (theEnv)->CL_EvaluationError)
+    {
+      FactData (theEnv)->assertError = AE_RULE_NETWORK_ERROR;
+    }
+}
+
+/***********************************************/
+/* AlphaMatchThread: Start routine of a worker */
+/*   thread pattern matching deferred facts.   */
+/***********************************************/
+static void *
+AlphaMatchThread (void *theWorker)
+{
+  AlphaMatchFacts ((struct alphaMatchWorker *) theWorker);
+  return NULL;
+}
+
+/****************************************************************/
+/* AlphaMatchFacts: Pattern matches the range of deferred facts */
+/*   of a worker. When a fact cannot be matched by the worker,  */
+/*   the pattern nodes it already reached are forgotten.        */
+/****************************************************************/
+static void
+AlphaMatchFacts (struct alphaMatchWorker *theWorker)
+{
+  size_t i, firstMatch;
+  Fact *theFact;
+
+  for (i = theWorker->firstFact; i < theWorker->lastFact; i++)
+    {
+      theFact = theWorker->theFacts[i];
+      firstMatch = theWorker->matchCount;
+
+      if (theFact->garbage || (!AlphaMatchFact (theWorker, i, theFact)))
+	{
+	  theWorker->matchCount = firstMatch;
+	  theWorker->mainThreadFacts[i] = true;
+	}
+    }
+}
+
+/********************************************************************/
+/* AlphaMatchFact: Traverses the pattern network of a fact like     */
+/*   CL_FactPatternMatch, but without multifield nodes, incremental */
+/*   reset, or evaluation of anything else than the constant tests  */
+/*   of the pattern network. Returns false when the fact needs one  */
+/*   of these, and must be matched by the main thread.              */
+/********************************************************************/
+static bool
+AlphaMatchFact (struct alphaMatchWorker *theWorker,
+		size_t whichFact, Fact * theFact)
+{
+  Environment *theEnv = theWorker->theEnv;
+  struct factPatternNode *patternPtr, *tempPtr;
+  unsigned short keyType;
+  void *keyValue;
+  bool passed;
+
+  patternPtr = theFact->whichDeftemplate->patternNetwork;
+
+  while (patternPtr != NULL)
+    {
+      if (!patternPtr->header.singlefieldNode)
+	{
+	  return false;
+	}
+
+      if (patternPtr->header.selector)
+	{
+	  if (!AlphaWorkerTest (theEnv, theFact,
+				patternPtr->networkTest->nextArg, &passed))
+	    {
+	      return false;
+	    }
+
+	  tempPtr = NULL;
+	  if (passed)
+	    {
+	      if (!AlphaWorkerSlotValue (theFact, patternPtr->networkTest,
+					 &keyType, &keyValue))
+		{
+		  return false;
+		}
+
+	      tempPtr = (struct factPatternNode *)
+		CL_FindHashedPatternNode (theEnv, patternPtr, keyType,
+					  keyValue);
+	    }
+
+	  if (tempPtr == NULL)
+	    {
+	      patternPtr = NextAlphaWorkerNode (true, patternPtr);
+	      continue;
+	    }
+
+	  if (tempPtr->header.stopNode &&
+	      (!AddAlphaWorkerMatch (theWorker, whichFact, tempPtr)))
+	    {
+	      return false;
+	    }
+
+	  patternPtr = NextAlphaWorkerNode (false, tempPtr);
+	}
+      else
+	{
+	  if (!AlphaWorkerTest (theEnv, theFact, patternPtr->networkTest,
+				&passed))
+	    {
+	      return false;
+	    }
+
+	  if (!passed)
+	    {
+	      patternPtr = NextAlphaWorkerNode (true, patternPtr);
+	      continue;
+	    }
+
+	  if (patternPtr->header.stopNode &&
+	      (!AddAlphaWorkerMatch (theWorker, whichFact, patternPtr)))
+	    {
+	      return false;
+	    }
+
+	  patternPtr = NextAlphaWorkerNode (false, patternPtr);
+	}
+    }
+
+  return true;
+}
+
+/**************************************************************/
+/* AddAlphaWorkerMatch: Records a pattern node reached by a   */
+/*   fact in a worker thread. Returns false if out of memory. */
+/**************************************************************/
+static bool
+AddAlphaWorkerMatch (struct alphaMatchWorker *theWorker,
+		     size_t whichFact, struct factPatternNode *thePattern)
+{
+  struct alphaWorkerMatch *newMatches;
+  size_t newMax;
+
+  if (theWorker->matchCount == theWorker->matchMax)
+    {
+      newMax = (theWorker->matchMax == 0) ?
+	ALPHA_MATCH_THREAD_FACTS : theWorker->matchMax * 2;
+      newMatches = (struct alphaWorkerMatch *)
+	realloc (theWorker->matches, sizeof (struct alphaWorkerMatch) * newMax);
+      if (newMatches == NULL)
+	{
+	  return false;
+	}
+
+      theWorker->matches = newMatches;
+      theWorker->matchMax = newMax;
+    }
+
+  theWorker->matches[theWorker->matchCount].whichFact = whichFact;
+  theWorker->matches[theWorker->matchCount].thePattern = thePattern;
+  theWorker->matchCount++;
+
+  return true;
+}
+
+/**********************************************************************/
+/* AlphaWorkerTest: Evaluates in a worker thread the constraint of a  */
+/*   pattern node, storing its result in passed. Only the primitives  */
+/*   comparing a slot to a constant or checking the length of a slot, */
+/*   and their conjunctions or disjunctions, are handled; they read   */
+/*   the fact but nothing else of the environment. Returns false for  */
+/*   any other constraint, or if a slot of the fact is not computed.  */
+/**********************************************************************/
+static bool
+AlphaWorkerTest (Environment * theEnv,
+		 Fact * theFact, struct expr *theTest, bool *passed)
+{
+  struct factConstantPN1Call *hack1;
+  struct factConstantPN2Call *hack2;
+  struct factCheckLengthPNCall *hack3;
+  CLIPSValue *fieldPtr;
+  Multifield *segmentPtr;
+  bool orTest;
+
+  if (theTest == NULL)
+    {
+      *passed = true;
+      return true;
+    }
+
+  switch (theTest->type)
+    {
+    case FACT_PN_CONSTANT1:
+      hack1 =
+	(struct factConstantPN1Call *) ((CLIPSBitMap *) theTest->value)->
+	contents;
+      fieldPtr = &theFact->theProposition.contents[hack1->whichSlot];
+      if (fieldPtr->header->type == CL_VOID_TYPE)
+	{
+	  return false;
+	}
+      *passed = ((theTest->argList->value == fieldPtr->value) ==
+		 (bool) hack1->testForEquality);
+      return true;
+
+    case FACT_PN_CONSTANT2:
+      hack2 =
+	(struct factConstantPN2Call *) ((CLIPSBitMap *) theTest->value)->
+	contents;
+      fieldPtr = &theFact->theProposition.contents[hack2->whichSlot];
+      if (fieldPtr->header->type == CL_VOID_TYPE)
+	{
+	  return false;
+	}
+      if (fieldPtr->header->type == MULTIFIELD_TYPE)
+	{
+	  segmentPtr = fieldPtr->multifieldValue;
+	  if (hack2->fromBeginning)
+	    {
+	      fieldPtr = &segmentPtr->contents[hack2->offset];
+	    }
+	  else
+	    {
+	      fieldPtr = &segmentPtr->contents[segmentPtr->length -
+					       (hack2->offset + 1)];
+	    }
+	}
+      *passed = ((theTest->argList->value == fieldPtr->value) ==
+		 (bool) hack2->testForEquality);
+      return true;
+
+    case FACT_SLOT_LENGTH:
+      hack3 =
+	(struct factCheckLengthPNCall *) ((CLIPSBitMap *) theTest->value)->
+	contents;
+      fieldPtr = &theFact->theProposition.contents[hack3->whichSlot];
+      if (fieldPtr->header->type == CL_VOID_TYPE)
+	{
+	  return false;
+	}
+      segmentPtr = fieldPtr->multifieldValue;
+      *passed = (segmentPtr->length >= hack3->minLength) &&
+	((!hack3->exactly) || (segmentPtr->length == hack3->minLength));
+      return true;
+    }
+
+  if ((theTest->value != ExpressionData (theEnv)->PTR_OR) &&
+      (theTest->value != ExpressionData (theEnv)->PTR_AND))
+    {
+      return false;
+    }
+
+  orTest = (theTest->value == ExpressionData (theEnv)->PTR_OR);
+
+  for (theTest = theTest->argList; theTest != NULL; theTest = theTest->nextArg)
+    {
+      if (!AlphaWorkerTest (theEnv, theFact, theTest, passed))
+	{
+	  return false;
+	}
+
+      if (*passed == orTest)
+	{
+	  return true;
+	}
+    }
+
+  *passed = !orTest;
+  return true;
+}
+
+/*************************************************************/
+/* AlphaWorkerSlotValue: Retrieves in a worker thread the    */
+/*   value hashed by a selector node of the pattern network. */
+/*   Returns false if it cannot be retrieved without the     */
+/*   environment.                                            */
+/*************************************************************/
+static bool
+AlphaWorkerSlotValue (Fact * theFact,
+		      struct expr *theGetField,
+		      unsigned short *keyType, void **keyValue)
+{
+  struct factGetVarPN2Call *hack2;
+  struct factGetVarPN3Call *hack3;
+  CLIPSValue *fieldPtr;
+  Multifield *segmentPtr;
+
+  switch (theGetField->type)
+    {
+    case FACT_PN_VAR2:
+      hack2 =
+	(struct factGetVarPN2Call *) ((CLIPSBitMap *) theGetField->value)->
+	contents;
+      fieldPtr = &theFact->theProposition.contents[hack2->whichSlot];
+      break;
+
+    case FACT_PN_VAR3:
+      hack3 =
+	(struct factGetVarPN3Call *) ((CLIPSBitMap *) theGetField->value)->
+	contents;
+      if (hack3->fromBeginning && hack3->fromEnd)
+	{
+	  return false;
+	}
+      fieldPtr = &theFact->theProposition.contents[hack3->whichSlot];
+      if (fieldPtr->header->type != MULTIFIELD_TYPE)
+	{
+	  return false;
+	}
+      segmentPtr = fieldPtr->multifieldValue;
+      if (hack3->fromBeginning)
+	{
+	  fieldPtr = &segmentPtr->contents[hack3->beginOffset];
+	}
+      else
+	{
+	  fieldPtr =
+	    &segmentPtr->contents[segmentPtr->length -
+				  (hack3->endOffset + 1)];
+	}
+      break;
+
+    default:
+      return false;
+    }
+
+  if ((fieldPtr->header->type == CL_VOID_TYPE) ||
+      (fieldPtr->header->type == MULTIFIELD_TYPE))
+    {
+      return false;
+    }
+
+  *keyType = fieldPtr->header->type;
+  *keyValue = fieldPtr->value;
+  return true;
+}
+
+/****************************************************************/
+/* NextAlphaWorkerNode: Same traversal as the one done by       */
+/*   CL_GetNextFactPatternNode, without resetting the evaluation */
+/*   error flag of the environment.                             */
+/****************************************************************/
+static struct factPatternNode *
+NextAlphaWorkerNode (bool finishedMatching,
+		     struct factPatternNode *thePattern)
+{
+  if ((finishedMatching == false) && (thePattern->nextLevel != NULL))
+    {
+      return thePattern->nextLevel;
+    }
+
+  while ((thePattern->rightNode == NULL) ||
+	 ((thePattern->lastLevel != NULL) &&
+	  (thePattern->lastLevel->header.selector)))
+    {
+      thePattern = thePattern->lastLevel;
+
+      if (thePattern == NULL)
+	return NULL;
+
+      if ((thePattern->lastLevel != NULL) &&
+	  (thePattern->lastLevel->header.selector))
+	{
+	  thePattern = thePattern->lastLevel;
+	}
+
+      if (thePattern->header.multifieldNode)
+	return NULL;
+    }
+
+  return thePattern->rightNode;
+}
+
+#endif /* ALPHA_MATCH_THREADS */
+
 /*****************************************************************/
 /* CL_EvaluatePatternExpression: Perfo_rms a faster evaluation for   */
 /*   fact pattern network expressions than if CL_EvaluateExpression */
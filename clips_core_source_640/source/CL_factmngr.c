@@ -135,6 +135,7 @@
 #include "lgcldpnd.h"
 #include "memalloc.h"
 #include "multifld.h"
+#include "reteutil.h"
 #include "retract.h"
 #include "prntutil.h"
 #include "router.h"
@@ -158,6 +159,18 @@ static bool CL_Clear_FactsReady (Environment *, void *);
 static void RemoveGarbage_Facts (Environment *, void *);
 static void DeallocateFactData (Environment *);
 static bool CL_RetractCallback (Fact *, Environment *);
+static void UnlinkRetractedFact (Environment *, Fact *, bool, char *);
+static PutSlotError FBPutSlotValue (Fact_Builder *, struct templateSlot *,
+				    unsigned short, CLIPSValue *);
+static bool FactWillBeDeleted (Environment *, Fact *);
+#if DEFRULE_CONSTRUCT
+static void MarkFactRetraction (Fact *, bool);
+static void MarkPatternFlushing (struct factPatternNode *, bool);
+static CL_RetractError RetractFactSet (Environment *, Fact **, size_t,
+				       Deftemplate *);
+static void FlushPatternAlphaMemories (Environment *,
+				       struct factPatternNode *);
+#endif
 
 /**************************************************************/
 /* Initialize_Facts: Initializes the fact data representation. */
@@ -181,12 +194,12 @@ Initialize_Facts (Environment * theEnv)
   (void (*)(Environment *, void *)) CL_IncrementFactBasisCount,
   (void (*)(Environment *, void *)) CL_MatchFactFunction,
   NULL,
-  (bool (*)(Environment *, void *)) CL_FactIsDeleted
+  (bool (*)(Environment *, void *)) FactWillBeDeleted
   };
 
   Fact dummyFact = { {{{FACT_ADDRESS_TYPE}, NULL, NULL, 0, 0L}},
   NULL, NULL, -1L, 0, 1,
-  NULL, NULL, NULL, NULL, NULL,
+  NULL, NULL, NULL, NULL, NULL, NULL, NULL,
   {{MULTIFIELD_TYPE}, 1, 0UL, NULL, {{{NULL}}}}
   };
 
@@ -300,6 +313,33 @@ DeallocateFactData (Environment * theEnv)
 	 sizeof (struct factHashEntry *) *
 	 FactData (theEnv)->FactHashTableSize);
 
+   /*=================================================*/
+  /* The old fact hash table may still have entries, */
+  /* if the table was growing.                       */
+   /*=================================================*/
+
+  if (FactData (theEnv)->OldFactHashTable != NULL)
+    {
+      for (i = 0; i < FactData (theEnv)->OldFactHashTableSize; i++)
+	{
+	  tmpFHEPtr = FactData (theEnv)->OldFactHashTable[i];
+
+	  while (tmpFHEPtr != NULL)
+	    {
+	      nextFHEPtr = tmpFHEPtr->next;
+	      rtn_struct (theEnv, factHashEntry, tmpFHEPtr);
+	      tmpFHEPtr = nextFHEPtr;
+	    }
+	}
+
+      CL_rm (theEnv, FactData (theEnv)->OldFactHashTable,
+	     sizeof (struct factHashEntry *) *
+	     FactData (theEnv)->OldFactHashTableSize);
+    }
+
+  CL_rm (theEnv, FactData (theEnv)->FactIndexTable,
+	 sizeof (Fact *) * FactData (theEnv)->FactIndexTableSize);
+
   tmpFactPtr = FactData (theEnv)->FactList;
   while (tmpFactPtr != NULL)
     {
@@ -327,6 +367,11 @@ DeallocateFactData (Environment * theEnv)
       tmpFactPtr = nextFactPtr;
     }
 
+#if DEFRULE_CONSTRUCT
+  CL_ReturnBatchAlphaMatches (theEnv);
+  CL_ReturnFactPatternMemo (theEnv);
+#endif
+
   CL_DeallocateCallListWithArg (theEnv,
 				FactData (theEnv)->ListOf_AssertFunctions);
   CL_DeallocateCallListWithArg (theEnv,
@@ -436,6 +481,16 @@ CL_IncrementFactBasisCount (Environment * theEnv, Fact * factPtr)
 
   CL_RetainFact (factPtr);
 
+   /*================================================*/
+  /* The basis copy needs every slot value, and the */
+  /* slots must not change once atoms are counted.  */
+   /*================================================*/
+
+  if (factPtr->whichDeftemplate->lazySlotFunction != NULL)
+    {
+      CL_MaterializeFact (theEnv, factPtr);
+    }
+
   theSegment = &factPtr->theProposition;
 
   if (theSegment->length != 0)
@@ -472,6 +527,34 @@ CL_FactIsDeleted (Environment * theEnv, Fact * theFact)
   return theFact->garbage;
 }
 
+/****************************************************************/
+/* FactWillBeDeleted: Tells the join network whether a fact is  */
+/*   retracted or about to be retracted by the retraction of    */
+/*   all the facts of its deftemplate.                          */
+/****************************************************************/
+static bool
+FactWillBeDeleted (Environment * theEnv, Fact * theFact)
+{
+#if MAC_XCD
+#pragma unused(theEnv)
+#endif
+
+  if (theFact->garbage)
+    {
+      return true;
+    }
+
+#if DEFRULE_CONSTRUCT
+  if ((theFact->whichDeftemplate->patternNetwork != NULL) &&
+      theFact->whichDeftemplate->patternNetwork->header.flushing)
+    {
+      return true;
+    }
+#endif
+
+  return false;
+}
+
 /**************************************************/
 /* CL_PrintFact: Displays the printed representation */
 /*   of a fact containing the relation name and   */
@@ -536,7 +619,6 @@ CL_RetractError
 CL_RetractDriver (Environment * theEnv,
 		  Fact * theFact, bool modifyOperation, char *changeMap)
 {
-  Deftemplate *theTemplate = theFact->whichDeftemplate;
   struct callFunctionItemWithArg *the_RetractFunction;
 
   FactData (theEnv)->retractError = RE_NO_ERROR;
@@ -575,6 +657,16 @@ CL_RetractDriver (Environment * theEnv,
       return CL_RetractAll_Facts (theEnv);
     }
 
+   /*=================================================*/
+  /* The facts of an open batch of assertions are    */
+  /* sent to the join network before any retraction, */
+  /* since they may have to be removed from it.      */
+   /*=================================================*/
+
+#if DEFRULE_CONSTRUCT
+  CL_FlushBatchAlphaMatches (theEnv);
+#endif
+
    /*=================================================*/
   /* Check to see if the fact has not been asserted. */
    /*=================================================*/
@@ -598,6 +690,78 @@ CL_RetractDriver (Environment * theEnv,
 				    the_RetractFunction->context);
     }
 
+  UnlinkRetractedFact (theEnv, theFact, modifyOperation, changeMap);
+
+   /*===================================================*/
+  /* CL_Reset the evaluation error flag since expressions */
+  /* will be evaluated as part of the retract.         */
+   /*===================================================*/
+
+  Set_EvaluationError (theEnv, false);
+
+   /*===========================================*/
+  /* Loop through the list of all the patterns */
+  /* that matched the fact and process the     */
+  /* retract operation for each one.           */
+   /*===========================================*/
+
+  EngineData (theEnv)->JoinOperationInProgress = true;
+  CL_Network_Retract (theEnv, (struct patternMatch *) theFact->list);
+  theFact->list = NULL;
+  EngineData (theEnv)->JoinOperationInProgress = false;
+
+   /*=========================================*/
+  /* Free partial matches that were released */
+  /* by the retraction of the fact.          */
+   /*=========================================*/
+
+  if ((EngineData (theEnv)->ExecutingRule == NULL) &&
+      (!FactData (theEnv)->BulkRetractInProgress))
+    {
+      CL_FlushGarbagePartial_Matches (theEnv);
+    }
+
+   /*=========================================*/
+  /* CL_Retract other facts that were logically */
+  /* dependent on the fact just retracted.   */
+   /*=========================================*/
+
+  CL_ForceLogical_Retractions (theEnv);
+
+   /*==================================*/
+  /* Update busy counts and ephemeral */
+  /* garbage info_rmation.             */
+   /*==================================*/
+
+  CL_FactDeinstall (theEnv, theFact);
+
+   /*====================================*/
+  /* Return the appropriate error code. */
+   /*====================================*/
+
+  if (Get_EvaluationError (theEnv))
+    {
+      FactData (theEnv)->retractError = RE_RULE_NETWORK_ERROR;
+      return RE_RULE_NETWORK_ERROR;
+    }
+
+  FactData (theEnv)->retractError = RE_NO_ERROR;
+  return RE_NO_ERROR;
+}
+
+/******************************************************************/
+/* UnlinkRetractedFact: Prints the retraction of a fact if facts  */
+/*   are watched, removes the fact from the fact hash table, from */
+/*   its deftemplate's fact list, from the fact-list and from the */
+/*   table of fact indices, then marks it as garbage. The join    */
+/*   network is left to the caller.                               */
+/******************************************************************/
+static void
+UnlinkRetractedFact (Environment * theEnv,
+		     Fact * theFact, bool modifyOperation, char *changeMap)
+{
+  Deftemplate *theTemplate = theFact->whichDeftemplate;
+
    /*============================*/
   /* Print retraction output if */
   /* facts are being watched.   */
@@ -631,9 +795,16 @@ CL_RetractDriver (Environment * theEnv,
 
    /*===========================================*/
   /* Remove the fact from the fact hash table. */
+  /* Facts of lazy deftemplates are not there, */
+  /* nor those of deftemplates whose facts are */
+  /* not checked for duplicates.               */
    /*===========================================*/
 
-  CL_RemoveHashedFact (theEnv, theFact);
+  if ((theTemplate->lazySlotFunction == NULL) &&
+      (!theTemplate->noDuplicateCheck))
+    {
+      CL_RemoveHashedFact (theEnv, theFact);
+    }
 
    /*=========================================*/
   /* Remove the fact from its template list. */
@@ -689,6 +860,12 @@ CL_RetractDriver (Environment * theEnv,
 	}
     }
 
+   /*=================================================*/
+  /* Remove the fact from the table of fact indices. */
+   /*=================================================*/
+
+  CL_RemoveIndexedFact (theEnv, theFact);
+
    /*===================================================*/
   /* Add the fact to the fact garbage list unless this */
   /* fact is being retract as part of a modify action. */
@@ -705,61 +882,6 @@ CL_RetractDriver (Environment * theEnv,
       theFact->nextFact = NULL;
     }
   theFact->garbage = true;
-
-   /*===================================================*/
-  /* CL_Reset the evaluation error flag since expressions */
-  /* will be evaluated as part of the retract.         */
-   /*===================================================*/
-
-  Set_EvaluationError (theEnv, false);
-
-   /*===========================================*/
-  /* Loop through the list of all the patterns */
-  /* that matched the fact and process the     */
-  /* retract operation for each one.           */
-   /*===========================================*/
-
-  EngineData (theEnv)->JoinOperationInProgress = true;
-  CL_Network_Retract (theEnv, (struct patternMatch *) theFact->list);
-  theFact->list = NULL;
-  EngineData (theEnv)->JoinOperationInProgress = false;
-
-   /*=========================================*/
-  /* Free partial matches that were released */
-  /* by the retraction of the fact.          */
-   /*=========================================*/
-
-  if (EngineData (theEnv)->ExecutingRule == NULL)
-    {
-      CL_FlushGarbagePartial_Matches (theEnv);
-    }
-
-   /*=========================================*/
-  /* CL_Retract other facts that were logically */
-  /* dependent on the fact just retracted.   */
-   /*=========================================*/
-
-  CL_ForceLogical_Retractions (theEnv);
-
-   /*==================================*/
-  /* Update busy counts and ephemeral */
-  /* garbage info_rmation.             */
-   /*==================================*/
-
-  CL_FactDeinstall (theEnv, theFact);
-
-   /*====================================*/
-  /* Return the appropriate error code. */
-   /*====================================*/
-
-  if (Get_EvaluationError (theEnv))
-    {
-      FactData (theEnv)->retractError = RE_RULE_NETWORK_ERROR;
-      return RE_RULE_NETWORK_ERROR;
-    }
-
-  FactData (theEnv)->retractError = RE_NO_ERROR;
-  return RE_NO_ERROR;
 }
 
 /*******************/
@@ -869,6 +991,7 @@ CL_AssertDriver (Fact * theFact,
   Fact *duplicate;
   struct callFunctionItemWithArg *the_AssertFunction;
   Environment *theEnv = theFact->whichDeftemplate->header.env;
+  bool lazy;
 
   FactData (theEnv)->assertError = AE_NO_ERROR;
 
@@ -905,12 +1028,17 @@ CL_AssertDriver (Fact * theFact,
 
    /*=============================================================*/
   /* Replace invalid data types in the fact with the symbol nil. */
+  /* The void slots of a fact of a lazy deftemplate are instead  */
+  /* computed when first read, and such facts are never checked  */
+  /* for duplicates, since that would need every slot value.     */
    /*=============================================================*/
 
+  lazy = (theFact->whichDeftemplate->lazySlotFunction != NULL);
+
   length = theFact->theProposition.length;
   theField = theFact->theProposition.contents;
 
-  for (i = 0; i < length; i++)
+  for (i = 0; (i < length) && (!lazy); i++)
     {
       if (theField[i].value == VoidConstant (theEnv))
 	{
@@ -923,10 +1051,21 @@ CL_AssertDriver (Fact * theFact,
   /* then search the fact list for a duplicate fact.        */
    /*========================================================*/
 
-  hashValue =
-    CL_HandleFactDuplication (theEnv, theFact, &duplicate, reuseIndex);
-  if (duplicate != NULL)
-    return duplicate;
+  if (lazy)
+    {
+      hashValue = 0;
+    }
+  else if (theFact->whichDeftemplate->noDuplicateCheck)
+    {
+      hashValue = CL_HashFact (theFact);
+    }
+  else
+    {
+      hashValue =
+	CL_HandleFactDuplication (theEnv, theFact, &duplicate, reuseIndex);
+      if (duplicate != NULL)
+	return duplicate;
+    }
 
    /*==========================================================*/
   /* If necessary, add logical dependency links between the   */
@@ -956,7 +1095,10 @@ CL_AssertDriver (Fact * theFact,
   /* Add the fact to the fact hash table. */
    /*======================================*/
 
-  CL_AddHashedFact (theEnv, theFact, hashValue);
+  if ((!lazy) && (!theFact->whichDeftemplate->noDuplicateCheck))
+    {
+      CL_AddHashedFact (theEnv, theFact, hashValue);
+    }
 
    /*================================*/
   /* Add the fact to the fact list. */
@@ -1023,167 +1165,851 @@ CL_AssertDriver (Fact * theFact,
 	}
     }
 
-  if ((theFact->whichDeftemplate->lastFact == NULL)
-      || (theFact->nextTemplateFact == NULL))
+  if ((theFact->whichDeftemplate->lastFact == NULL)
+      || (theFact->nextTemplateFact == NULL))
+    {
+      theFact->whichDeftemplate->lastFact = theFact;
+    }
+
+   /*==================================*/
+  /* Set the fact index and time tag. */
+   /*==================================*/
+
+  if (reuseIndex > 0)
+    {
+      theFact->factIndex = reuseIndex;
+    }
+  else
+    {
+      theFact->factIndex = FactData (theEnv)->Next_FactIndex++;
+    }
+
+   /*============================================*/
+  /* Add the fact to the table of fact indices. */
+   /*============================================*/
+
+  CL_AddIndexedFact (theEnv, theFact);
+
+  theFact->patternHeader.timeTag =
+    DefruleData (theEnv)->CurrentEntityTimeTag++;
+
+   /*=====================*/
+  /* Update busy counts. */
+   /*=====================*/
+
+  CL_FactInstall (theEnv, theFact);
+
+  if (reuseIndex == 0)
+    {
+      Multifield *theSegment = &theFact->theProposition;
+      for (i = 0; i < theSegment->length; i++)
+	{
+	  CL_AtomInstall (theEnv, theSegment->contents[i].header->type,
+			  theSegment->contents[i].value);
+	}
+    }
+
+   /*==========================================*/
+  /* Execute the list of functions that are   */
+  /* to be called before each fact assertion. */
+   /*==========================================*/
+
+  for (the_AssertFunction = FactData (theEnv)->ListOf_AssertFunctions;
+       the_AssertFunction != NULL;
+       the_AssertFunction = the_AssertFunction->next)
+    {
+      (*the_AssertFunction->func) (theEnv, theFact,
+				   the_AssertFunction->context);
+    }
+
+   /*==========================*/
+  /* Print assert output if   */
+  /* facts are being watched. */
+   /*==========================*/
+
+#if DEBUGGING_FUNCTIONS
+  if (theFact->whichDeftemplate->watch &&
+      (!ConstructData (theEnv)->CL_ClearReadyInProgress) &&
+      (!ConstructData (theEnv)->CL_ClearInProgress))
+    {
+      CL_WriteString (theEnv, STDOUT, "==> ");
+      CL_PrintFactWithIdentifier (theEnv, STDOUT, theFact, changeMap);
+      CL_WriteString (theEnv, STDOUT, "\n");
+    }
+#endif
+
+   /*==================================*/
+  /* Set the change flag to indicate  */
+  /* the fact-list has been modified. */
+   /*==================================*/
+
+  FactData (theEnv)->ChangeToFactList = true;
+
+   /*==========================================*/
+  /* Check for constraint errors in the fact. */
+   /*==========================================*/
+
+  if (!lazy)
+    {
+      CL_CheckTemplateFact (theEnv, theFact);
+    }
+
+   /*===================================================*/
+  /* CL_Reset the evaluation error flag since expressions */
+  /* will be evaluated as part of the assert .         */
+   /*===================================================*/
+
+  Set_EvaluationError (theEnv, false);
+
+   /*=============================================*/
+  /* Pattern match the fact using the associated */
+  /* deftemplate's pattern network.              */
+   /*=============================================*/
+
+   /*=================================================*/
+  /* While a batch of assertions is open, the alpha  */
+  /* matches of the fact are kept until it is ended. */
+  /* With worker threads, even the pattern matching  */
+  /* of the fact waits for the end of the batch.     */
+   /*=================================================*/
+
+#if DEFRULE_CONSTRUCT
+  if (!CL_DeferFactPatternMatch (theEnv, theFact))
+    {
+      FactData (theEnv)->BatchingAlphaMatches =
+	(FactData (theEnv)->AssertBatchDepth > 0);
+      EngineData (theEnv)->JoinOperationInProgress = true;
+      CL_FactPatternMatch (theEnv, theFact,
+			   theFact->whichDeftemplate->patternNetwork, 0, 0,
+			   NULL, NULL);
+      EngineData (theEnv)->JoinOperationInProgress = false;
+      FactData (theEnv)->BatchingAlphaMatches = false;
+    }
+#else
+  EngineData (theEnv)->JoinOperationInProgress = true;
+  CL_FactPatternMatch (theEnv, theFact,
+		       theFact->whichDeftemplate->patternNetwork, 0, 0, NULL,
+		       NULL);
+  EngineData (theEnv)->JoinOperationInProgress = false;
+#endif
+
+   /*===================================================*/
+  /* CL_Retract other facts that were logically dependent */
+  /* on the non-existence of the fact just asserted.   */
+   /*===================================================*/
+
+  CL_ForceLogical_Retractions (theEnv);
+
+   /*=========================================*/
+  /* Free partial matches that were released */
+  /* by the assertion of the fact.           */
+   /*=========================================*/
+
+  if (EngineData (theEnv)->ExecutingRule == NULL)
+    CL_FlushGarbagePartial_Matches (theEnv);
+
+   /*===============================*/
+  /* Return a pointer to the fact. */
+   /*===============================*/
+
+  if (CL_EvaluationData (theEnv)->CL_EvaluationError)
+    {
+      FactData (theEnv)->assertError = AE_RULE_NETWORK_ERROR;
+    }
+
+  return theFact;
+}
+
+/*****************************************************/
+/* CL_Assert: C access routine for the assert function. */
+/*****************************************************/
+Fact *
+CL_Assert (Fact * theFact)
+{
+  return CL_AssertDriver (theFact, 0, NULL, NULL, NULL);
+}
+
+/*******************************************************************/
+/* CL_BeginAssertBatch: Opens a batch of assertions. The facts     */
+/*   asserted until the matching CL_EndAssertBatch are installed   */
+/*   and go thru the pattern network at once, but their alpha      */
+/*   matches are only sent to the join network when the outermost  */
+/*   batch ends, grouped by pattern. A retraction or a CL_Run also */
+/*   sends the matches kept so far. The activations of a rule are  */
+/*   made in the order its facts were asserted, unless the facts   */
+/*   of two of its patterns were asserted interleaved: the         */
+/*   matches of the pattern first matched in the batch are then    */
+/*   all sent before those of the other one.                       */
+/*******************************************************************/
+void
+CL_BeginAssertBatch (Environment * theEnv)
+{
+  FactData (theEnv)->AssertBatchDepth++;
+}
+
+/****************************************************/
+/* CL_EndAssertBatch: Ends a batch of assertions, and */
+/*   when it is the outermost one, sends the alpha  */
+/*   matches of its facts to the join network.      */
+/****************************************************/
+void
+CL_EndAssertBatch (Environment * theEnv)
+{
+  if (FactData (theEnv)->AssertBatchDepth == 0)
+    {
+      return;
+    }
+
+  if (--FactData (theEnv)->AssertBatchDepth > 0)
+    {
+      return;
+    }
+
+#if DEFRULE_CONSTRUCT
+  CL_FlushBatchAlphaMatches (theEnv);
+#endif
+}
+
+/**************************************************************/
+/* CL_AssertBatch: Asserts an array of facts as one batch.        */
+/*   Each element of the array is replaced by what CL_Assert     */
+/*   would have returned for it. Returns the number of facts  */
+/*   which are not NULL afterwards.                           */
+/**************************************************************/
+size_t
+CL_AssertBatch (Environment * theEnv, Fact ** theFacts, size_t count)
+{
+  size_t i, asserted = 0;
+
+  CL_BeginAssertBatch (theEnv);
+
+  for (i = 0; i < count; i++)
+    {
+      if (theFacts[i] == NULL)
+	{
+	  continue;
+	}
+
+      theFacts[i] = CL_Assert (theFacts[i]);
+      if (theFacts[i] != NULL)
+	{
+	  asserted++;
+	}
+    }
+
+  CL_EndAssertBatch (theEnv);
+
+  return asserted;
+}
+
+/*************************************************/
+/* CL_GetAlphaMatchThreads: C access routine for */
+/*   the get-alpha-match-threads command.        */
+/*************************************************/
+unsigned int
+CL_GetAlphaMatchThreads (Environment * theEnv)
+{
+  return FactData (theEnv)->AlphaMatchThreads;
+}
+
+/*****************************************************************/
+/* CL_SetAlphaMatchThreads: C access routine for the             */
+/*   set-alpha-match-threads command. Sets the number of threads */
+/*   pattern matching the facts of a batch of assertions, and    */
+/*   returns the previous one. With less than 2 threads, or      */
+/*   without ALPHA_MATCH_THREADS, the facts are matched when     */
+/*   they are asserted.                                          */
+/*****************************************************************/
+unsigned int
+CL_SetAlphaMatchThreads (Environment * theEnv, unsigned int threadCount)
+{
+  unsigned int ov;
+
+  ov = FactData (theEnv)->AlphaMatchThreads;
+#if ALPHA_MATCH_THREADS && DEFRULE_CONSTRUCT
+  if (threadCount > ALPHA_MATCH_MAX_THREADS)
+    {
+      threadCount = ALPHA_MATCH_MAX_THREADS;
+    }
+#else
+  threadCount = 0;
+#endif
+  FactData (theEnv)->AlphaMatchThreads = threadCount;
+  return ov;
+}
+
+/*************************/
+/* Get_AssertStringError: */
+/*************************/
+CL_AssertStringError
+Get_AssertStringError (Environment * theEnv)
+{
+  return FactData (theEnv)->assertStringError;
+}
+
+/**************************************/
+/* CL_RetractAll_Facts: Loops through the */
+/*   fact-list and removes each fact. */
+/**************************************/
+CL_RetractError
+CL_RetractAll_Facts (Environment * theEnv)
+{
+  CL_RetractError rv;
+
+  while (FactData (theEnv)->FactList != NULL)
+    {
+      if ((rv = CL_Retract (FactData (theEnv)->FactList)) != RE_NO_ERROR)
+	{
+	  return rv;
+	}
+    }
+
+  return RE_NO_ERROR;
+}
+
+/*****************************************************/
+/* CL_FactMark: Returns the fact index that the next */
+/*   asserted fact will get. The facts asserted after */
+/*   this call can be retracted together by passing  */
+/*   the mark to CL_RetractFactsSince.               */
+/*****************************************************/
+long long
+CL_FactMark (Environment * theEnv)
+{
+  return FactData (theEnv)->Next_FactIndex;
+}
+
+/************************************************************/
+/* CL_RetractFactsSince: CL_Retracts every fact whose index */
+/*   is at least the given mark. Since the fact-list is     */
+/*   kept in assertion order, these facts are found at      */
+/*   its end. Unless functions are to be called before      */
+/*   each retraction, they are retracted as one set by      */
+/*   RetractFactSet, the last one first. Otherwise they     */
+/*   are retracted one by one, and only the partial         */
+/*   matches released by the whole group are freed in a     */
+/*   single pass once every fact has been removed from the  */
+/*   join network, instead of after each retraction.        */
+/************************************************************/
+CL_RetractError
+CL_RetractFactsSince (Environment * theEnv, long long mark)
+{
+  GCBlock gcb;
+  Fact *theFact, **theFacts;
+  size_t i, count;
+  CL_RetractError rv = RE_NO_ERROR;
+
+  if (EngineData (theEnv)->JoinOperationInProgress)
+    {
+      CL_PrintErrorID (theEnv, "FACTMNGR", 1, true);
+      CL_WriteString (theEnv, STDERR,
+		      "CL_Facts may not be retracted during pattern-matching.\n");
+      Set_EvaluationError (theEnv, true);
+      FactData (theEnv)->retractError = RE_COULD_NOT_RETRACT_ERROR;
+      return RE_COULD_NOT_RETRACT_ERROR;
+    }
+
+   /*=====================================*/
+  /* If embedded, clear the error flags. */
+   /*=====================================*/
+
+  if (CL_EvaluationData (theEnv)->CurrentExpression == NULL)
+    {
+      CL_ResetErrorFlags (theEnv);
+    }
+
+#if DEFRULE_CONSTRUCT
+  CL_FlushBatchAlphaMatches (theEnv);
+#endif
+
+  CL_GCBlockStart (theEnv, &gcb);
+  FactData (theEnv)->BulkRetractInProgress = true;
+
+#if DEFRULE_CONSTRUCT
+  if (FactData (theEnv)->ListOf_RetractFunctions == NULL)
+    {
+      count = 0;
+      for (theFact = FactData (theEnv)->LastFact;
+	   (theFact != NULL) && (theFact->factIndex >= mark);
+	   theFact = theFact->previousFact)
+	{
+	  count++;
+	}
+
+      if (count > 0)
+	{
+	  theFacts = (Fact **) CL_genalloc (theEnv, sizeof (Fact *) * count);
+	  for (i = 0, theFact = FactData (theEnv)->LastFact;
+	       i < count; i++, theFact = theFact->previousFact)
+	    {
+	      theFacts[i] = theFact;
+	    }
+
+	  rv = RetractFactSet (theEnv, theFacts, count, NULL);
+	  CL_genfree (theEnv, theFacts, sizeof (Fact *) * count);
+	}
+    }
+  else
+#endif
+    {
+      /*==============================================*/
+      /* CL_Retracting from the end of the fact-list also */
+      /* picks up facts logically retracted meanwhile. */
+      /*==============================================*/
+
+      while (((theFact = FactData (theEnv)->LastFact) != NULL) &&
+	     (theFact->factIndex >= mark))
+	{
+	  if ((rv =
+	       CL_RetractDriver (theEnv, theFact, false,
+				 NULL)) != RE_NO_ERROR)
+	    {
+	      break;
+	    }
+	}
+    }
+
+  FactData (theEnv)->BulkRetractInProgress = false;
+  if (EngineData (theEnv)->ExecutingRule == NULL)
+    {
+      CL_FlushGarbagePartial_Matches (theEnv);
+    }
+  CL_GCBlockEnd (theEnv, &gcb);
+
+  return rv;
+}
+
+/*****************************************************************/
+/* CL_RetractDeftemplateFacts: CL_Retracts every fact of a          */
+/*   deftemplate. Before the first fact is removed, the alpha    */
+/*   matches of all of them are marked as being deleted and the  */
+/*   pattern nodes of the deftemplate as flushing their alpha    */
+/*   memories. So a negated or exists join losing the match      */
+/*   which blocked a partial match doesn't search for another    */
+/*   one among the facts left to retract, and a partial match    */
+/*   it releases isn't joined with those facts only to be        */
+/*   removed again. Unless functions are to be called before     */
+/*   each retraction, the facts are then retracted as one set by */
+/*   RetractFactSet, which flushes the alpha memories of the     */
+/*   deftemplate as a whole. Otherwise they are retracted one by */
+/*   one and, as for CL_RetractFactsSince, the partial matches   */
+/*   released are freed once every fact is retracted.            */
+/*****************************************************************/
+CL_RetractError
+CL_RetractDeftemplateFacts (Deftemplate * theDeftemplate)
+{
+  GCBlock gcb;
+  Fact *theFact, **theFacts;
+  Environment *theEnv;
+  size_t i, count;
+  CL_RetractError rv = RE_NO_ERROR;
+
+  if (theDeftemplate == NULL)
+    {
+      return RE_NULL_POINTER_ERROR;
+    }
+
+  theEnv = theDeftemplate->header.env;
+
+  if (EngineData (theEnv)->JoinOperationInProgress)
+    {
+      CL_PrintErrorID (theEnv, "FACTMNGR", 1, true);
+      CL_WriteString (theEnv, STDERR,
+		      "CL_Facts may not be retracted during pattern-matching.\n");
+      Set_EvaluationError (theEnv, true);
+      FactData (theEnv)->retractError = RE_COULD_NOT_RETRACT_ERROR;
+      return RE_COULD_NOT_RETRACT_ERROR;
+    }
+
+   /*=====================================*/
+  /* If embedded, clear the error flags. */
+   /*=====================================*/
+
+  if (CL_EvaluationData (theEnv)->CurrentExpression == NULL)
+    {
+      CL_ResetErrorFlags (theEnv);
+    }
+
+#if DEFRULE_CONSTRUCT
+  CL_FlushBatchAlphaMatches (theEnv);
+#endif
+
+  CL_GCBlockStart (theEnv, &gcb);
+  FactData (theEnv)->BulkRetractInProgress = true;
+
+#if DEFRULE_CONSTRUCT
+  MarkPatternFlushing (theDeftemplate->patternNetwork, true);
+
+  if (FactData (theEnv)->ListOf_RetractFunctions == NULL)
+    {
+      count = 0;
+      for (theFact = theDeftemplate->factList;
+	   theFact != NULL; theFact = theFact->nextTemplateFact)
+	{
+	  count++;
+	}
+
+      if (count > 0)
+	{
+	  theFacts = (Fact **) CL_genalloc (theEnv, sizeof (Fact *) * count);
+	  for (i = 0, theFact = theDeftemplate->factList;
+	       i < count; i++, theFact = theFact->nextTemplateFact)
+	    {
+	      theFacts[i] = theFact;
+	    }
+
+	  rv = RetractFactSet (theEnv, theFacts, count, theDeftemplate);
+	  CL_genfree (theEnv, theFacts, sizeof (Fact *) * count);
+	}
+    }
+  else
+#endif
+    {
+#if DEFRULE_CONSTRUCT
+      for (theFact = theDeftemplate->factList;
+	   theFact != NULL; theFact = theFact->nextTemplateFact)
+	{
+	  MarkFactRetraction (theFact, true);
+	}
+#endif
+
+      while ((theFact = theDeftemplate->factList) != NULL)
+	{
+	  if ((rv =
+	       CL_RetractDriver (theEnv, theFact, false,
+				 NULL)) != RE_NO_ERROR)
+	    {
+	      break;
+	    }
+	}
+    }
+
+   /*===========================================*/
+  /* After an error, the facts not retracted   */
+  /* are matched by the join network as usual. */
+   /*===========================================*/
+
+#if DEFRULE_CONSTRUCT
+  MarkPatternFlushing (theDeftemplate->patternNetwork, false);
+  for (theFact = theDeftemplate->factList;
+       theFact != NULL; theFact = theFact->nextTemplateFact)
+    {
+      MarkFactRetraction (theFact, false);
+    }
+#endif
+
+  FactData (theEnv)->BulkRetractInProgress = false;
+  if (EngineData (theEnv)->ExecutingRule == NULL)
+    {
+      CL_FlushGarbagePartial_Matches (theEnv);
+    }
+  CL_GCBlockEnd (theEnv, &gcb);
+
+  return rv;
+}
+
+#if DEFRULE_CONSTRUCT
+
+/***************************************************************/
+/* MarkFactRetraction: Marks the alpha matches of a fact about */
+/*   to be retracted by a bulk retraction as being deleted, so */
+/*   that the join network ignores them, or unmarks them.      */
+/***************************************************************/
+static void
+MarkFactRetraction (Fact * theFact, bool deleting)
+{
+  struct patternMatch *theMatch;
+
+  for (theMatch = (struct patternMatch *) theFact->list;
+       theMatch != NULL; theMatch = theMatch->next)
+    {
+      theMatch->theMatch->deleting = deleting;
+    }
+}
+
+/*************************************************************/
+/* MarkPatternFlushing: Marks or unmarks the pattern nodes   */
+/*   of a deftemplate's pattern network as flushing, that is */
+/*   as having every match of their alpha memory retracted.  */
+/*************************************************************/
+static void
+MarkPatternFlushing (struct factPatternNode *thePattern, bool flushing)
+{
+  for (; thePattern != NULL; thePattern = thePattern->rightNode)
+    {
+      thePattern->header.flushing = flushing;
+      MarkPatternFlushing (thePattern->nextLevel, flushing);
+    }
+}
+
+/*****************************************************************/
+/* RetractFactSet: CL_Retracts a set of facts together, when no  */
+/*   function is to be called before each retraction. Every fact */
+/*   is first removed from the fact-list, then the join network  */
+/*   is updated for the whole set at once: the partial matches   */
+/*   and activations derived from the alpha matches of the facts */
+/*   are removed in one sweep, then the partial matches of       */
+/*   negated and exists joins blocked by the facts are checked   */
+/*   once, and finally the alpha matches are removed. When the   */
+/*   set is every fact of a deftemplate, the alpha memories of   */
+/*   its pattern network are flushed instead of being searched   */
+/*   for each match. Facts logically dependent on the set are    */
+/*   retracted afterwards.                                       */
+/*****************************************************************/
+static CL_RetractError
+RetractFactSet (Environment * theEnv,
+		Fact ** theFacts, size_t count, Deftemplate * flushedTemplate)
+{
+  size_t i;
+
+   /*================================================*/
+  /* Remove every fact from the fact-list before    */
+  /* any of them leaves the join network: a fact    */
+  /* marked as garbage has its alpha matches        */
+  /* ignored by the join network while it retracts. */
+   /*================================================*/
+
+  for (i = 0; i < count; i++)
+    {
+      UnlinkRetractedFact (theEnv, theFacts[i], false, NULL);
+    }
+
+   /*===================================================*/
+  /* CL_Reset the evaluation error flag since expressions */
+  /* will be evaluated as part of the retract.         */
+   /*===================================================*/
+
+  Set_EvaluationError (theEnv, false);
+
+  EngineData (theEnv)->JoinOperationInProgress = true;
+
+  for (i = 0; i < count; i++)
     {
-      theFact->whichDeftemplate->lastFact = theFact;
+      CL_Network_RetractJoins (theEnv,
+			       (struct patternMatch *) theFacts[i]->list);
     }
 
-   /*==================================*/
-  /* Set the fact index and time tag. */
-   /*==================================*/
-
-  if (reuseIndex > 0)
+  for (i = 0; i < count; i++)
     {
-      theFact->factIndex = reuseIndex;
+      CL_Network_RetractAlphaMatches (theEnv,
+				      (struct patternMatch *) theFacts[i]->
+				      list, (flushedTemplate != NULL));
+      theFacts[i]->list = NULL;
     }
-  else
+
+  if (flushedTemplate != NULL)
     {
-      theFact->factIndex = FactData (theEnv)->Next_FactIndex++;
+      FlushPatternAlphaMemories (theEnv, flushedTemplate->patternNetwork);
     }
 
-  theFact->patternHeader.timeTag =
-    DefruleData (theEnv)->CurrentEntityTimeTag++;
+  EngineData (theEnv)->JoinOperationInProgress = false;
 
-   /*=====================*/
-  /* Update busy counts. */
-   /*=====================*/
+   /*============================================*/
+  /* CL_Retract other facts that were logically */
+  /* dependent on the facts just retracted.     */
+   /*============================================*/
 
-  CL_FactInstall (theEnv, theFact);
+  CL_ForceLogical_Retractions (theEnv);
 
-  if (reuseIndex == 0)
+  for (i = 0; i < count; i++)
     {
-      Multifield *theSegment = &theFact->theProposition;
-      for (i = 0; i < theSegment->length; i++)
+      CL_FactDeinstall (theEnv, theFacts[i]);
+    }
+
+  if (Get_EvaluationError (theEnv))
+    {
+      FactData (theEnv)->retractError = RE_RULE_NETWORK_ERROR;
+      return RE_RULE_NETWORK_ERROR;
+    }
+
+  FactData (theEnv)->retractError = RE_NO_ERROR;
+  return RE_NO_ERROR;
+}
+
+/*************************************************************/
+/* FlushPatternAlphaMemories: Flushes the alpha memories of  */
+/*   the pattern nodes of a deftemplate's pattern network,   */
+/*   once none of their matches is used by the join network. */
+/*************************************************************/
+static void
+FlushPatternAlphaMemories (Environment * theEnv,
+			   struct factPatternNode *thePattern)
+{
+  for (; thePattern != NULL; thePattern = thePattern->rightNode)
+    {
+      if (thePattern->header.firstHash != NULL)
 	{
-	  CL_AtomInstall (theEnv, theSegment->contents[i].header->type,
-			  theSegment->contents[i].value);
+	  CL_FlushAlphaMemory (theEnv, &thePattern->header);
 	}
+      FlushPatternAlphaMemories (theEnv, thePattern->nextLevel);
     }
+}
 
-   /*==========================================*/
-  /* Execute the list of functions that are   */
-  /* to be called before each fact assertion. */
-   /*==========================================*/
+#endif /* DEFRULE_CONSTRUCT */
 
-  for (the_AssertFunction = FactData (theEnv)->ListOf_AssertFunctions;
-       the_AssertFunction != NULL;
-       the_AssertFunction = the_AssertFunction->next)
+/*******************************************************/
+/* CL_SetDeftemplateLazy: Makes a deftemplate lazy, so  */
+/*   that the slots of its facts which were not given  */
+/*   when asserting are computed by theFunction only   */
+/*   when the rule network or a command first reads    */
+/*   them. A NULL function makes it eager again. Only  */
+/*   possible for a non-implied deftemplate without    */
+/*   facts. Facts of lazy deftemplates are not checked */
+/*   for duplicates nor for dynamic constraints.       */
+/*******************************************************/
+bool
+CL_SetDeftemplateLazy (Deftemplate * theDeftemplate,
+		       CL_LazySlotFunction * theFunction, void *context)
+{
+  if ((theDeftemplate == NULL) || theDeftemplate->implied ||
+      (theDeftemplate->factList != NULL))
     {
-      (*the_AssertFunction->func) (theEnv, theFact,
-				   the_AssertFunction->context);
+      return false;
     }
 
-   /*==========================*/
-  /* Print assert output if   */
-  /* facts are being watched. */
-   /*==========================*/
+  theDeftemplate->lazySlotFunction = theFunction;
+  theDeftemplate->lazySlotContext = context;
 
-#if DEBUGGING_FUNCTIONS
-  if (theFact->whichDeftemplate->watch &&
-      (!ConstructData (theEnv)->CL_ClearReadyInProgress) &&
-      (!ConstructData (theEnv)->CL_ClearInProgress))
+  return true;
+}
+
+/***************************************************************/
+/* CL_SetDeftemplateDuplicateCheck: Tells whether the facts of */
+/*   a deftemplate are checked for duplicates when asserted,   */
+/*   which they are by default. The facts of a deftemplate     */
+/*   which are known to always differ, e.g. by a unique        */
+/*   identifier slot, need neither the search of the fact hash */
+/*   table nor an entry there. Only possible for a deftemplate */
+/*   without facts, which a CL_Bload makes checked again.      */
+/***************************************************************/
+bool
+CL_SetDeftemplateDuplicateCheck (Deftemplate * theDeftemplate, bool value)
+{
+  if ((theDeftemplate == NULL) || (theDeftemplate->factList != NULL))
     {
-      CL_WriteString (theEnv, STDOUT, "==> ");
-      CL_PrintFactWithIdentifier (theEnv, STDOUT, theFact, changeMap);
-      CL_WriteString (theEnv, STDOUT, "\n");
+      return false;
     }
-#endif
 
-   /*==================================*/
-  /* Set the change flag to indicate  */
-  /* the fact-list has been modified. */
-   /*==================================*/
+  theDeftemplate->noDuplicateCheck = !value;
 
-  FactData (theEnv)->ChangeToFactList = true;
+  return true;
+}
 
-   /*==========================================*/
-  /* Check for constraint errors in the fact. */
-   /*==========================================*/
+/*************************************************/
+/* CL_FactLazySource: Returns the source given by */
+/*   CL_FBSetLazySource when the fact was built.  */
+/*************************************************/
+void *
+CL_FactLazySource (Fact * theFact)
+{
+  if (theFact == NULL)
+    return NULL;
 
-  CL_CheckTemplateFact (theEnv, theFact);
+  return theFact->lazySource;
+}
 
-   /*===================================================*/
-  /* CL_Reset the evaluation error flag since expressions */
-  /* will be evaluated as part of the assert .         */
-   /*===================================================*/
+/**********************************************************/
+/* CL_FillLazyFactSlot: Computes the value of a void slot  */
+/*   of a fact of a lazy deftemplate, thru its lazy slot  */
+/*   function or else the slot default, then stores it in */
+/*   the fact. Use the FactSlotContents macro instead.    */
+/**********************************************************/
+CLIPSValue *
+CL_FillLazyFactSlot (Environment * theEnv,
+		     Fact * theFact, unsigned short whichSlot)
+{
+  Deftemplate *theDeftemplate = theFact->whichDeftemplate;
+  CLIPSValue *theField = &theFact->theProposition.contents[whichSlot];
+  CLIPSValue theValue;
+  UDFValue theDefault;
+  struct templateSlot *slotPtr;
+  unsigned short i;
 
-  Set_EvaluationError (theEnv, false);
+  if (theField->header->type != CL_VOID_TYPE)
+    {
+      return theField;
+    }
 
-   /*=============================================*/
-  /* Pattern match the fact using the associated */
-  /* deftemplate's pattern network.              */
-   /*=============================================*/
+  theValue.voidValue = VoidConstant (theEnv);
 
-  EngineData (theEnv)->JoinOperationInProgress = true;
-  CL_FactPatternMatch (theEnv, theFact,
-		       theFact->whichDeftemplate->patternNetwork, 0, 0, NULL,
-		       NULL);
-  EngineData (theEnv)->JoinOperationInProgress = false;
+  if ((theDeftemplate->lazySlotFunction == NULL) ||
+      (!(*theDeftemplate->lazySlotFunction) (theEnv, theFact, whichSlot,
+					      &theValue,
+					      theDeftemplate->
+					      lazySlotContext)))
+    {
+      theValue.voidValue = VoidConstant (theEnv);
+    }
 
-   /*===================================================*/
-  /* CL_Retract other facts that were logically dependent */
-  /* on the non-existence of the fact just asserted.   */
-   /*===================================================*/
+   /*==========================================*/
+  /* The fact owns its multifield values, and */
+  /* asserted facts count their atoms.        */
+   /*==========================================*/
 
-  CL_ForceLogical_Retractions (theEnv);
+  else if (theValue.header->type == MULTIFIELD_TYPE)
+    {
+      theValue.multifieldValue =
+	CL_CopyMultifield (theEnv, theValue.multifieldValue);
+    }
 
    /*=========================================*/
-  /* Free partial matches that were released */
-  /* by the assertion of the fact.           */
+  /* Otherwise use the slot default, or nil. */
    /*=========================================*/
 
-  if (EngineData (theEnv)->ExecutingRule == NULL)
-    CL_FlushGarbagePartial_Matches (theEnv);
+  if (theValue.header->type == CL_VOID_TYPE)
+    {
+      for (i = 0, slotPtr = theDeftemplate->slotList;
+	   (i < whichSlot) && (slotPtr != NULL);
+	   i++, slotPtr = slotPtr->next)
+	{			/* Do Nothing */
+	}
 
-   /*===============================*/
-  /* Return a pointer to the fact. */
-   /*===============================*/
+      if ((slotPtr != NULL) &&
+	  CL_DeftemplateSlotDefault (theEnv, theDeftemplate, slotPtr,
+				     &theDefault, false))
+	{
+	  theValue.value = theDefault.value;
+	}
+      else if ((slotPtr != NULL) && slotPtr->multislot)
+	{
+	  theValue.multifieldValue = CL_CreateUnmanagedMultifield (theEnv, 0);
+	}
+      else
+	{
+	  theValue.lexemeValue = CL_CreateSymbol (theEnv, "nil");
+	}
+    }
 
-  if (CL_EvaluationData (theEnv)->CL_EvaluationError)
+  theField->value = theValue.value;
+
+  if (theFact->factIndex != 0LL)
     {
-      FactData (theEnv)->assertError = AE_RULE_NETWORK_ERROR;
+      CL_AtomInstall (theEnv, theField->header->type, theField->value);
     }
 
-  return theFact;
+  return theField;
 }
 
 /*****************************************************/
-/* CL_Assert: C access routine for the assert function. */
+/* CL_MaterializeFact: Fills every void slot of a fact */
+/*   of a lazy deftemplate, for the routines reading  */
+/*   or copying all the slots of a fact at once.      */
 /*****************************************************/
-Fact *
-CL_Assert (Fact * theFact)
-{
-  return CL_AssertDriver (theFact, 0, NULL, NULL, NULL);
-}
-
-/*************************/
-/* Get_AssertStringError: */
-/*************************/
-CL_AssertStringError
-Get_AssertStringError (Environment * theEnv)
-{
-  return FactData (theEnv)->assertStringError;
-}
-
-/**************************************/
-/* CL_RetractAll_Facts: Loops through the */
-/*   fact-list and removes each fact. */
-/**************************************/
-CL_RetractError
-CL_RetractAll_Facts (Environment * theEnv)
+void
+CL_MaterializeFact (Environment * theEnv, Fact * theFact)
 {
-  CL_RetractError rv;
+  unsigned short i;
 
-  while (FactData (theEnv)->FactList != NULL)
+  if ((theFact == NULL) ||
+      (theFact->whichDeftemplate->lazySlotFunction == NULL))
     {
-      if ((rv = CL_Retract (FactData (theEnv)->FactList)) != RE_NO_ERROR)
-	{
-	  return rv;
-	}
+      return;
     }
 
-  return RE_NO_ERROR;
+  for (i = 0; i < theFact->theProposition.length; i++)
+    {
+      (void) FactSlotContents (theEnv, theFact, i);
+    }
 }
 
 /*********************************************/
@@ -1305,7 +2131,7 @@ CL_GetFactSlot (Fact * theFact, const char *slotName, CLIPSValue * theValue)
   /* Return the slot value. */
    /*========================*/
 
-  theValue->value = theFact->theProposition.contents[whichSlot].value;
+  theValue->value = FactSlotContents (theEnv, theFact, whichSlot)->value;
 
   return GSE_NO_ERROR;
 }
@@ -1606,6 +2432,8 @@ CL_Copy_FactSlotValues (Environment * theEnv,
       return false;
     }
 
+  CL_MaterializeFact (theEnv, theSourceFact);
+
    /*===================================================*/
   /* Loop through each slot of the deftemplate copying */
   /* the source fact value to the destination fact.    */
@@ -1668,6 +2496,8 @@ CL_CreateFactBySize (Environment * theEnv, size_t size)
   theFact->nextTemplateFact = NULL;
   theFact->list = NULL;
   theFact->basisSlots = NULL;
+  theFact->lazySource = NULL;
+  theFact->nextIndexedFact = NULL;
 
   theFact->theProposition.length = size;
   theFact->theProposition.busyCount = 0;
@@ -2079,19 +2909,29 @@ CL_Clear_FactsReady (Environment * theEnv, void *context)
 /***************************************************/
 Fact *
 CL_FindIndexedFact (Environment * theEnv, long long factIndexSought)
+{
+  return CL_LookupIndexedFact (theEnv, factIndexSought);
+}
+
+/***************************************************/
+/* CL_RetractIndexedFact: C access routine for     */
+/*   retracting the fact with a specified index.   */
+/*   Returns RE_NOT_FOUND_ERROR if no fact of the  */
+/*   fact list has this index.                     */
+/***************************************************/
+CL_RetractError
+CL_RetractIndexedFact (Environment * theEnv, long long factIndex)
 {
   Fact *theFact;
 
-  for (theFact = CL_GetNextFact (theEnv, NULL);
-       theFact != NULL; theFact = CL_GetNextFact (theEnv, theFact))
+  theFact = CL_LookupIndexedFact (theEnv, factIndex);
+  if (theFact == NULL)
     {
-      if (theFact->factIndex == factIndexSought)
-	{
-	  return (theFact);
-	}
+      FactData (theEnv)->retractError = RE_NOT_FOUND_ERROR;
+      return RE_NOT_FOUND_ERROR;
     }
 
-  return NULL;
+  return CL_Retract (theFact);
 }
 
 /**************************************/
@@ -2367,6 +3207,7 @@ CL_CreateFact_Builder (Environment * theEnv, const char *deftemplateName)
   theFB = get_struct (theEnv, fact_Builder);
   theFB->fbEnv = theEnv;
   theFB->fbDeftemplate = theDeftemplate;
+  theFB->fbLazySource = NULL;
 
   if ((theDeftemplate == NULL) || (theDeftemplate->numberOfSlots == 0))
     {
@@ -2578,12 +3419,8 @@ PutSlotError
 CL_FBPutSlot (Fact_Builder * theFB,
 	      const char *slotName, CLIPSValue * slotValue)
 {
-  Environment *theEnv;
   struct templateSlot *theSlot;
   unsigned short whichSlot;
-  CLIPSValue oldValue;
-  int i;
-  ConstraintViolationType cvType;
 
    /*==========================*/
   /* Check for NULL pointers. */
@@ -2599,8 +3436,6 @@ CL_FBPutSlot (Fact_Builder * theFB,
       return PSE_NULL_POINTER_ERROR;
     }
 
-  theEnv = theFB->fbEnv;
-
    /*===================================*/
   /* Make sure the slot name requested */
   /* corresponds to a valid slot name. */
@@ -2614,6 +3449,66 @@ CL_FBPutSlot (Fact_Builder * theFB,
       return PSE_SLOT_NOT_FOUND_ERROR;
     }
 
+  return FBPutSlotValue (theFB, theSlot, whichSlot, slotValue);
+}
+
+/**********************************************************/
+/* CL_FBPutSlotByIndex: Same as CL_FBPutSlot, but the slot   */
+/*   is given by its zero-based position in the deftemplate */
+/*   (as computed once by CL_FindSlot), so no symbol has to */
+/*   be created nor looked up for each fact being built.    */
+/**********************************************************/
+PutSlotError
+CL_FBPutSlotByIndex (Fact_Builder * theFB,
+		     unsigned short whichSlot, CLIPSValue * slotValue)
+{
+  struct templateSlot *theSlot;
+  unsigned short i;
+
+   /*==========================*/
+  /* Check for NULL pointers. */
+   /*==========================*/
+
+  if ((theFB == NULL) || (slotValue == NULL))
+    {
+      return PSE_NULL_POINTER_ERROR;
+    }
+
+  if ((theFB->fbDeftemplate == NULL) || (slotValue->value == NULL))
+    {
+      return PSE_NULL_POINTER_ERROR;
+    }
+
+  if (whichSlot >= theFB->fbDeftemplate->numberOfSlots)
+    {
+      return PSE_SLOT_NOT_FOUND_ERROR;
+    }
+
+  for (theSlot = theFB->fbDeftemplate->slotList, i = 0;
+       i < whichSlot; theSlot = theSlot->next, i++)
+    {				/* Do Nothing */
+    }
+
+  return FBPutSlotValue (theFB, theSlot, whichSlot, slotValue);
+}
+
+/*******************************************************/
+/* FBPutSlotValue: Stores a checked value in the given */
+/*   slot of a fact builder. Shared by CL_FBPutSlot and   */
+/*   CL_FBPutSlotByIndex.                                 */
+/*******************************************************/
+static PutSlotError
+FBPutSlotValue (Fact_Builder * theFB,
+		struct templateSlot *theSlot,
+		unsigned short whichSlot, CLIPSValue * slotValue)
+{
+  Environment *theEnv;
+  CLIPSValue oldValue;
+  int i;
+  ConstraintViolationType cvType;
+
+  theEnv = theFB->fbEnv;
+
    /*=============================================*/
   /* Make sure a single field value is not being */
   /* stored in a multifield slot or vice versa.  */
@@ -2757,7 +3652,15 @@ FB_Assert (Fact_Builder * theFB)
 	}
     }
 
-  CL_AssignFactSlotDefaults (theFact);
+  if (theFB->fbDeftemplate->lazySlotFunction == NULL)
+    {
+      CL_AssignFactSlotDefaults (theFact);
+    }
+  else
+    {
+      theFact->lazySource = theFB->fbLazySource;
+      theFB->fbLazySource = NULL;
+    }
 
   theFact = CL_Assert (theFact);
 
@@ -2785,6 +3688,20 @@ FB_Assert (Fact_Builder * theFB)
   return theFact;
 }
 
+/***************************************************/
+/* CL_FBSetLazySource: Gives the source from which */
+/*   the lazy slot function of the deftemplate of  */
+/*   the next asserted fact computes its slots.    */
+/***************************************************/
+void
+CL_FBSetLazySource (Fact_Builder * theFB, void *theSource)
+{
+  if (theFB == NULL)
+    return;
+
+  theFB->fbLazySource = theSource;
+}
+
 /**************/
 /* CL_FBDispose: */
 /**************/
@@ -2842,6 +3759,8 @@ CL_FBAbort (Fact_Builder * theFB)
       theFB->fbValueArray[i].voidValue = VoidConstant (theEnv);
     }
 
+  theFB->fbLazySource = NULL;
+
   CL_GCBlockEnd (theEnv, &gcb);
 }
 
@@ -2952,6 +3871,7 @@ CL_CreateFactModifier (Environment * theEnv, Fact * oldFact)
 	}
 
       CL_RetainFact (oldFact);
+      CL_MaterializeFact (theEnv, oldFact);
     }
 
   theFM = get_struct (theEnv, factModifier);
@@ -3583,6 +4503,8 @@ CL_FMSetFact (FactModifier * theFM, Fact * oldFact)
 	    FME_IMPLIED_DEFTEMPLATE_ERROR;
 	  return FME_IMPLIED_DEFTEMPLATE_ERROR;
 	}
+
+      CL_MaterializeFact (theEnv, oldFact);
     }
 
    /*========================*/
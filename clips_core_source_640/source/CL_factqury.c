@@ -262,7 +262,7 @@ CL_GetQueryFactSlot (Environment * theEnv,
       return;
     }
 
-  returnValue->value = theFact->theProposition.contents[position].value;
+  returnValue->value = FactSlotContents (theEnv, theFact, position)->value;
   if (returnValue->header->type == MULTIFIELD_TYPE)
     {
       returnValue->begin = 0;
@@ -59,6 +59,14 @@
 
 #include "factrete.h"
 
+/***************************************/
+/* LOCAL INTERNAL FUNCTION DEFINITIONS */
+/***************************************/
+
+static void NoteMarkerDependency (Environment *,
+				  struct multifieldMarker *,
+				  unsigned short, unsigned short);
+
 /***************************************************************/
 /* CL_FactPNGetVar1: Fact pattern network function for extracting */
 /*   a variable's value. This is the most generalized routine. */
@@ -107,7 +115,7 @@ CL_FactPNGetVar1 (Environment * theEnv,
   if (hack->allFields)
     {
       theSlot = hack->whichSlot;
-      fieldPtr = &factPtr->theProposition.contents[theSlot];
+      fieldPtr = FactSlotContents (theEnv, factPtr, theSlot);
       returnValue->value = fieldPtr->value;
       if (returnValue->header->type == MULTIFIELD_TYPE)
 	{
@@ -129,7 +137,7 @@ CL_FactPNGetVar1 (Environment * theEnv,
 
   theField = hack->whichField;
   theSlot = hack->whichSlot;
-  fieldPtr = &factPtr->theProposition.contents[theSlot];
+  fieldPtr = FactSlotContents (theEnv, factPtr, theSlot);
 
    /*==========================================================*/
   /* Retrieve a value from a multifield slot. First dete_rmine */
@@ -139,6 +147,7 @@ CL_FactPNGetVar1 (Environment * theEnv,
   extent = SIZE_MAX;
   adjustedField =
     CL_AdjustFieldPosition (theEnv, marks, theField, theSlot, &extent);
+  NoteMarkerDependency (theEnv, marks, theField, theSlot);
 
    /*=============================================================*/
   /* If a range of values are being retrieved (i.e. a multifield */
@@ -166,6 +175,40 @@ CL_FactPNGetVar1 (Environment * theEnv,
   return true;
 }
 
+/*****************************************************************/
+/* NoteMarkerDependency: Notes for the failures remembered while */
+/*   pattern matching multifield slots (see MatchBelowMultifield */
+/*   in factmch.c) the earliest multifield marker whose binding  */
+/*   gives the position of the field read from a multifield      */
+/*   slot. The position of a single field only depends on the    */
+/*   end of the last marker preceding it, while a multifield     */
+/*   variable also depends on the start of its own marker.       */
+/*****************************************************************/
+static void
+NoteMarkerDependency (Environment * theEnv,
+		      struct multifieldMarker *marks,
+		      unsigned short theField, unsigned short theSlot)
+{
+  size_t markIndex, dependency = SIZE_MAX;
+
+  for (markIndex = 1; marks != NULL; marks = marks->next, markIndex++)
+    {
+      if (marks->where.whichSlotNumber != theSlot)
+	continue;
+
+      if (marks->whichField > theField)
+	break;
+
+      dependency = (marks->whichField == theField) ?
+	markIndex - 1 : markIndex;
+    }
+
+  if (dependency < FactData (theEnv)->PatternMemoMark)
+    {
+      FactData (theEnv)->PatternMemoMark = dependency;
+    }
+}
+
 /**************************************************/
 /* CL_FactPNGetVar2: Fact pattern network function   */
 /*   for extracting a variable's value. The value */
@@ -195,7 +238,7 @@ CL_FactPNGetVar2 (Environment * theEnv,
   /* Extract the value from the specified slot. */
    /*============================================*/
 
-  fieldPtr = &factPtr->theProposition.contents[hack->whichSlot];
+  fieldPtr = FactSlotContents (theEnv, factPtr, hack->whichSlot);
 
   returnValue->value = fieldPtr->value;
 
@@ -233,7 +276,7 @@ CL_FactPNGetVar3 (Environment * theEnv,
    /*============================================================*/
 
   segmentPtr =
-    factPtr->theProposition.contents[hack->whichSlot].multifieldValue;
+    FactSlotContents (theEnv, factPtr, hack->whichSlot)->multifieldValue;
 
    /*=========================================*/
   /* If the beginning and end flags are set, */
@@ -295,8 +338,8 @@ CL_FactPNConstant1 (Environment * theEnv,
    /*============================================*/
 
   fieldPtr =
-    &FactData (theEnv)->CurrentPatternFact->theProposition.contents[hack->
-								    whichSlot];
+    FactSlotContents (theEnv, FactData (theEnv)->CurrentPatternFact,
+		      hack->whichSlot);
 
    /*====================================*/
   /* Compare the value to the constant. */
@@ -358,8 +401,8 @@ CL_FactPNConstant2 (Environment * theEnv,
    /*==========================================================*/
 
   fieldPtr =
-    &FactData (theEnv)->CurrentPatternFact->theProposition.contents[hack->
-								    whichSlot];
+    FactSlotContents (theEnv, FactData (theEnv)->CurrentPatternFact,
+		      hack->whichSlot);
 
   if (fieldPtr->header->type == MULTIFIELD_TYPE)
     {
@@ -494,6 +537,7 @@ CL_FactJNGetVar1 (Environment * theEnv,
     }
   else
     {
+      (void) FactSlotContents (theEnv, factPtr, hack->whichSlot);
       theSlots = &factPtr->theProposition;
     }
 
@@ -634,7 +678,7 @@ CL_FactJNGetVar2 (Environment * theEnv,
     }
   else
     {
-      fieldPtr = &factPtr->theProposition.contents[hack->whichSlot];
+      fieldPtr = FactSlotContents (theEnv, factPtr, hack->whichSlot);
     }
 
   returnValue->value = fieldPtr->value;
@@ -710,7 +754,7 @@ CL_FactJNGetVar3 (Environment * theEnv,
   else
     {
       segmentPtr =
-	factPtr->theProposition.contents[hack->whichSlot].multifieldValue;
+	FactSlotContents (theEnv, factPtr, hack->whichSlot)->multifieldValue;
     }
 
    /*=========================================*/
@@ -773,9 +817,8 @@ CL_FactSlotLength (Environment * theEnv,
     }
 
   segmentPtr =
-    FactData (theEnv)->CurrentPatternFact->theProposition.contents[hack->
-								   whichSlot].
-    multifieldValue;
+    FactSlotContents (theEnv, FactData (theEnv)->CurrentPatternFact,
+		      hack->whichSlot)->multifieldValue;
 
   if (segmentPtr->length < (hack->minLength + extraOffset))
     {
@@ -843,8 +886,8 @@ CL_FactJNCompVars1 (Environment * theEnv,
   e1 = hack->slot1;
   e2 = hack->slot2;
 
-  if (fact1->theProposition.contents[e1].value !=
-      fact2->theProposition.contents[e2].value)
+  if (FactSlotContents (theEnv, fact1, e1)->value !=
+      FactSlotContents (theEnv, fact2, e2)->value)
     {
       return hack->fail;
     }
@@ -908,7 +951,7 @@ CL_FactJNCompVars2 (Environment * theEnv,
   /* Retrieve the values. */
    /*======================*/
 
-  if (fact1->theProposition.contents[s1].header->type != MULTIFIELD_TYPE)
+  if (FactSlotContents (theEnv, fact1, s1)->header->type != MULTIFIELD_TYPE)
     {
       fieldPtr1 = &fact1->theProposition.contents[s1];
     }
@@ -927,7 +970,7 @@ CL_FactJNCompVars2 (Environment * theEnv,
 	}
     }
 
-  if (fact2->theProposition.contents[s2].header->type != MULTIFIELD_TYPE)
+  if (FactSlotContents (theEnv, fact2, s2)->header->type != MULTIFIELD_TYPE)
     {
       fieldPtr2 = &fact2->theProposition.contents[s2];
     }
@@ -976,11 +1019,11 @@ CL_FactPNCompVars1 (Environment * theEnv,
 
   hack = (struct factCompVarsPN1Call *) ((CLIPSBitMap *) theValue)->contents;
   fieldPtr1 =
-    &FactData (theEnv)->CurrentPatternFact->theProposition.contents[hack->
-								    field1];
+    FactSlotContents (theEnv, FactData (theEnv)->CurrentPatternFact,
+		      hack->field1);
   fieldPtr2 =
-    &FactData (theEnv)->CurrentPatternFact->theProposition.contents[hack->
-								    field2];
+    FactSlotContents (theEnv, FactData (theEnv)->CurrentPatternFact,
+		      hack->field2);
 
    /*=====================*/
   /* Compare the values. */
@@ -439,6 +439,7 @@ UpdateDefglobal (Environment * theEnv, void *buf, unsigned long obji)
     HashedExpressionPointer (bdp->initial);
   DefglobalBinaryData (theEnv)->DefglobalArray[obji].current.voidValue =
     VoidConstant (theEnv);
+  DefglobalBinaryData (theEnv)->DefglobalArray[obji].changeStamp = 0;
 }
 
 /***************************************/
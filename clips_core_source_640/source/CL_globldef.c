@@ -541,10 +541,14 @@ CL_QSetDefglobalValue (Environment * theEnv,
 
    /*===========================================*/
   /* Set the variable indicating that a change */
-  /* has been made to a global variable.       */
+  /* has been made to a global variable, and   */
+  /* stamp the global with the change so that  */
+  /* dynamic saliences reading it are known to */
+  /* be out of date.                           */
    /*===========================================*/
 
   DefglobalData (theEnv)->ChangeToGlobals = true;
+  theGlobal->changeStamp = ++DefglobalData (theEnv)->ChangeStamp;
 
   if (CL_EvaluationData (theEnv)->CurrentExpression == NULL)
     {
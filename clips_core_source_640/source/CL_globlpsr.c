@@ -424,6 +424,7 @@ AddDefglobal (Environment * theEnv,
   defglobalPtr->initial = CL_AddHashedExpression (theEnv, ePtr);
   CL_ReturnExpression (theEnv, ePtr);
   DefglobalData (theEnv)->ChangeToGlobals = true;
+  defglobalPtr->changeStamp = ++DefglobalData (theEnv)->ChangeStamp;
 
    /*=================================*/
   /* Restore the old watch value to  */
@@ -68,6 +68,9 @@
 #include "engine.h"
 #include "envrnmnt.h"
 #include "evaluatn.h"
+#if DEFTEMPLATE_CONSTRUCT
+#include "factmch.h"
+#endif
 #include "pattern.h"
 #include "router.h"
 #include "reteutil.h"
@@ -102,6 +105,15 @@ CL_Incremental_Reset (Environment * theEnv, Defrule * tempRule)
   Defrule *tempPtr;
   struct patternParser *theParser;
 
+   /*==================================================*/
+  /* The facts of an open batch of assertions are sent */
+  /* to the join network before it is changed.         */
+   /*==================================================*/
+
+#if DEFTEMPLATE_CONSTRUCT
+  CL_FlushBatchAlphaMatches (theEnv);
+#endif
+
    /*=====================================================*/
   /* Mark the pattern and join network data structures   */
   /* associated with the rule being incrementally reset. */
@@ -338,7 +350,8 @@ PrimeJoinFromLeftMemory (Environment * theEnv, struct joinNode *joinPtr)
 	    {
 	      if (listOfHashNodes->alphaMemory != NULL)
 		{
-		  CL_AddBlockedLink (notParent, listOfHashNodes->alphaMemory);
+		  CL_AddBlockedLink (theEnv, notParent,
+				     listOfHashNodes->alphaMemory);
 		  return;
 		}
 	    }
@@ -131,8 +131,8 @@ CL_AddLogical_Dependencies (Environment * theEnv,
 
   newDependency = get_struct (theEnv, dependency);
   newDependency->dPtr = theEntity;
-  newDependency->next = (struct dependency *) theBinds->dependents;
-  theBinds->dependents = newDependency;
+  newDependency->next = (struct dependency *) PMDependents (theBinds);
+  CL_GetPartialMatchExtra (theEnv, theBinds)->dependents = newDependency;
 
    /*================================================================*/
   /* Add a dependency link between the entity and the partialMatch. */
@@ -217,9 +217,10 @@ RemoveEntity_Dependencies (Environment * theEnv,
       /*================================================================*/
 
       theBinds = (struct partialMatch *) fdPtr->dPtr;
-      theList = (struct dependency *) theBinds->dependents;
+      theList = (struct dependency *) PMDependents (theBinds);
       theList = DetachAssociated_Dependencies (theEnv, theList, theEntity);
-      theBinds->dependents = theList;
+      theBinds->extra->dependents = theList;
+      CL_ReleasePartialMatchExtra (theEnv, theBinds);
 
       /*========================*/
       /* Return the dependency. */
@@ -312,7 +313,7 @@ RemovePM_Dependencies (Environment * theEnv, struct partialMatch *theBinds)
   struct dependency *fdPtr, *nextPtr, *theList;
   struct patternEntity *theEntity;
 
-  fdPtr = (struct dependency *) theBinds->dependents;
+  fdPtr = (struct dependency *) PMDependents (theBinds);
 
   while (fdPtr != NULL)
     {
@@ -328,7 +329,11 @@ RemovePM_Dependencies (Environment * theEnv, struct partialMatch *theBinds)
       fdPtr = nextPtr;
     }
 
-  theBinds->dependents = NULL;
+  if (theBinds->extra != NULL)
+    {
+      theBinds->extra->dependents = NULL;
+      CL_ReleasePartialMatchExtra (theEnv, theBinds);
+    }
 }
 
 /************************************************************/
@@ -340,7 +345,7 @@ DestroyPM_Dependencies (Environment * theEnv, struct partialMatch *theBinds)
 {
   struct dependency *fdPtr, *nextPtr;
 
-  fdPtr = (struct dependency *) theBinds->dependents;
+  fdPtr = (struct dependency *) PMDependents (theBinds);
 
   while (fdPtr != NULL)
     {
@@ -350,7 +355,11 @@ DestroyPM_Dependencies (Environment * theEnv, struct partialMatch *theBinds)
       fdPtr = nextPtr;
     }
 
-  theBinds->dependents = NULL;
+  if (theBinds->extra != NULL)
+    {
+      theBinds->extra->dependents = NULL;
+      CL_ReleasePartialMatchExtra (theEnv, theBinds);
+    }
 }
 
 /************************************************************************/
@@ -374,7 +383,7 @@ CL_RemoveLogicalSupport (Environment * theEnv, struct partialMatch *theBinds)
   /* dependencies, then return.             */
    /*========================================*/
 
-  if (theBinds->dependents == NULL)
+  if (PMDependents (theBinds) == NULL)
     return;
 
    /*=======================================*/
@@ -382,7 +391,7 @@ CL_RemoveLogicalSupport (Environment * theEnv, struct partialMatch *theBinds)
   /* attached to the partial match.        */
    /*=======================================*/
 
-  dlPtr = (struct dependency *) theBinds->dependents;
+  dlPtr = (struct dependency *) PMDependents (theBinds);
 
   while (dlPtr != NULL)
     {
@@ -434,7 +443,11 @@ CL_RemoveLogicalSupport (Environment * theEnv, struct partialMatch *theBinds)
   /* dependencies associated with it.    */
    /*=====================================*/
 
-  theBinds->dependents = NULL;
+  if (theBinds->extra != NULL)
+    {
+      theBinds->extra->dependents = NULL;
+      CL_ReleasePartialMatchExtra (theEnv, theBinds);
+    }
 }
 
 /********************************************************************/
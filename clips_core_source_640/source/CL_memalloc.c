@@ -136,6 +136,8 @@ CL_genalloc (Environment * theEnv, size_t size)
 
   MemoryData (theEnv)->MemoryAmount += size;
   MemoryData (theEnv)->MemoryCalls++;
+  if (MemoryData (theEnv)->MemoryAmount > MemoryData (theEnv)->MemoryPeak)
+    MemoryData (theEnv)->MemoryPeak = MemoryData (theEnv)->MemoryAmount;
 
   return memPtr;
 }
@@ -234,6 +236,16 @@ CL_MemRequests (Environment * theEnv)
   return MemoryData (theEnv)->MemoryCalls;
 }
 
+/**********************************/
+/* CL_MemPeak: Returns the largest */
+/*   amount of memory ever used.  */
+/**********************************/
+long long
+CL_MemPeak (Environment * theEnv)
+{
+  return MemoryData (theEnv)->MemoryPeak;
+}
+
 /***************************************/
 /* CL_UpdateMemoryUsed: Allows the amount */
 /*   of memory used to be updated.     */
@@ -242,6 +254,8 @@ long long
 CL_UpdateMemoryUsed (Environment * theEnv, long long value)
 {
   MemoryData (theEnv)->MemoryAmount += value;
+  if (MemoryData (theEnv)->MemoryAmount > MemoryData (theEnv)->MemoryPeak)
+    MemoryData (theEnv)->MemoryPeak = MemoryData (theEnv)->MemoryAmount;
   return MemoryData (theEnv)->MemoryAmount;
 }
 
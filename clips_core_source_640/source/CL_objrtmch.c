@@ -1272,11 +1272,11 @@ CreateObjectAlphaMatch (Environment * theEnv, OBJECT_ALPHA_NODE * alphaPtr)
 	  /* ================================================
 	     Drive the partial match through the join network
 	     ================================================ */
-	  listOfJoins = alphaPtr->header.entryJoin;
+	  listOfJoins = CL_FirstActiveJoin (&alphaPtr->header);
 	  while (listOfJoins != NULL)
 	    {
 	      Network_Assert (theEnv, theMatch, listOfJoins);
-	      listOfJoins = listOfJoins->rightMatchNode;
+	      listOfJoins = CL_NextActiveJoin (listOfJoins);
 	    }
 	}
       alphaPtr = alphaPtr->nxtInGroup;
@@ -93,6 +93,27 @@ struct groupReference
   struct groupReference *next;
 };
 
+#define JOIN_ORDER_MAX_VARIABLES 32
+
+struct joinOrderNode
+{
+  struct lhsParseNode *theCE;
+  struct joinOrderCE *statistics;
+  bool placed;
+  bool connectedBefore;
+  unsigned short boundCount;
+  unsigned short usedCount;
+  CLIPSLexeme *bound[JOIN_ORDER_MAX_VARIABLES];
+  CLIPSLexeme *used[JOIN_ORDER_MAX_VARIABLES];
+};
+
+struct joinOrderVariables
+{
+  unsigned short count;
+  unsigned short size;
+  CLIPSLexeme **names;
+};
+
 /***************************************/
 /* LOCAL INTERNAL FUNCTION DEFINITIONS */
 /***************************************/
@@ -126,6 +147,26 @@ static void PropagateNandDepth (struct lhsParseNode *, int, int);
 static void MarkExistsNands (struct lhsParseNode *);
 static unsigned short PropagateWhichCE (struct lhsParseNode *,
 					unsigned short);
+static void ApplyJoinOrderRequest (Environment *, struct lhsParseNode *);
+static bool ReorderJoinCEs (Environment *, struct lhsParseNode *,
+			    struct joinOrderCE *);
+static bool ReorderJoinCERun (Environment *, struct lhsParseNode **,
+			      unsigned short, struct joinOrderCE *,
+			      struct joinOrderVariables *);
+static bool JoinOrderCandidate (struct lhsParseNode *, struct joinOrderCE *);
+static bool CollectJoinOrderVariables (struct lhsParseNode *,
+				       struct joinOrderNode *);
+static bool CollectJoinOrderField (struct lhsParseNode *,
+				   struct joinOrderNode *);
+static bool CollectJoinOrderExpression (struct lhsParseNode *,
+					struct joinOrderNode *);
+static bool JoinOrderVariableFound (CLIPSLexeme *, CLIPSLexeme **,
+				    unsigned short);
+static bool JoinOrderConnected (struct joinOrderNode *,
+				struct joinOrderVariables *);
+static void AddJoinOrderVariables (struct joinOrderNode *,
+				   struct joinOrderVariables *);
+static double JoinOrderEstimate (struct joinOrderNode *, bool);
    /*
       static void                    PrintNodes(void *,const char *,struct lhsParseNode *);
     */
@@ -223,6 +264,16 @@ CL_ReorderPatterns (Environment * theEnv,
       MarkExistsNands (newLHS->right);
     }
 
+   /*===================================================*/
+  /* If a rule is being rebuilt by optimize-rule-joins, */
+  /* reorder its pattern CEs using the join statistics. */
+   /*===================================================*/
+
+  if (DefruleData (theEnv)->JoinOrderRequest != NULL)
+    {
+      ApplyJoinOrderRequest (theEnv, newLHS);
+    }
+
    /*=====================================================*/
   /* Add initial patterns where needed (such as before a */
   /* "test" CE or "not" CE which is the first CE within  */
@@ -2211,4 +2262,592 @@ static void PrintNodes(
   }
 */
 
+/*************************************************************/
+/* ApplyJoinOrderRequest: Reorders the pattern CEs of each   */
+/*   disjunct of a rule being rebuilt by optimize-rule-joins */
+/*   and notes in the request whether any order changed.     */
+/*************************************************************/
+static void
+ApplyJoinOrderRequest (Environment * theEnv, struct lhsParseNode *theLHS)
+{
+  struct joinOrderRequest *theRequest;
+  struct lhsParseNode *theDisjunct;
+  unsigned short disjunctIndex = 0;
+
+  theRequest = DefruleData (theEnv)->JoinOrderRequest;
+
+  if (theLHS->pnType == OR_CE_NODE)
+    {
+      theDisjunct = theLHS->right;
+    }
+  else
+    {
+      theDisjunct = theLHS;
+    }
+
+  while ((theDisjunct != NULL) &&
+	 (disjunctIndex < theRequest->disjunctCount))
+    {
+      if (ReorderJoinCEs (theEnv, theDisjunct,
+			  &theRequest->statistics[disjunctIndex *
+						  JOIN_ORDER_MAX_CE]))
+	{
+	  theRequest->changed = true;
+	}
+
+      if (theLHS->pnType != OR_CE_NODE)
+	{
+	  break;
+	}
+
+      theDisjunct = theDisjunct->bottom;
+      disjunctIndex++;
+    }
+}
+
+/*************************************************************/
+/* ReorderJoinCEs: Reorders each run of consecutive positive */
+/*   pattern CEs at the top level of a disjunct for which    */
+/*   statistics are known. Test CEs, not/exists CEs, nested  */
+/*   not/and groups and changes of the logical CE are left   */
+/*   in place, so that only the order of joins whose result  */
+/*   does not depend on it is changed. The first CE of the   */
+/*   disjunct is also left in place, since the mea strategy  */
+/*   depends on it. Returns true if the order differs from   */
+/*   the order of the rule's joins.                          */
+/*************************************************************/
+static bool
+ReorderJoinCEs (Environment * theEnv,
+		struct lhsParseNode *theAND, struct joinOrderCE *statistics)
+{
+  struct lhsParseNode *theCE, **link;
+  struct joinOrderVariables bound;
+  struct joinOrderNode prefixNode;
+  unsigned short nodeCount = 0, runLength, i;
+  bool changed = false;
+
+  for (theCE = theAND->right; theCE != NULL; theCE = theCE->bottom)
+    {
+      nodeCount++;
+    }
+
+   /*======================================================*/
+  /* Collect the variables bound by the preceding CEs. A  */
+  /* CE adds at most the variables collected for a single */
+  /* pattern, which are limited in number.                */
+   /*======================================================*/
+
+  bound.count = 0;
+  if (nodeCount < USHRT_MAX / (2 * JOIN_ORDER_MAX_VARIABLES))
+    {
+      bound.size = (unsigned short) (nodeCount * 2 * JOIN_ORDER_MAX_VARIABLES);
+    }
+  else
+    {
+      bound.size = USHRT_MAX;
+    }
+  bound.names = (CLIPSLexeme **)
+    CL_genalloc (theEnv, sizeof (CLIPSLexeme *) * bound.size);
+
+  link = &theAND->right;
+  while (*link != NULL)
+    {
+      /*=============================================*/
+      /* Find the run of candidate CEs beginning     */
+      /* with this CE, which share its logical flag. */
+      /*=============================================*/
+
+      runLength = 0;
+      for (theCE = *link;
+	   (theCE != NULL) && JoinOrderCandidate (theCE, statistics) &&
+	   (theCE->logical == (*link)->logical); theCE = theCE->bottom)
+	{
+	  runLength++;
+	}
+
+      /*================================================*/
+      /* The first CE of the disjunct is kept in place, */
+      /* since the mea strategy orders the activations  */
+      /* of the rule by the time tag of its match.      */
+      /*================================================*/
+
+      if ((runLength > 1) && (link != &theAND->right))
+	{
+	  if (ReorderJoinCERun (theEnv, link, runLength, statistics, &bound))
+	    {
+	      changed = true;
+	    }
+
+	  for (i = 0; i < runLength; i++)
+	    {
+	      link = &(*link)->bottom;
+	    }
+	  continue;
+	}
+
+      /*================================================*/
+      /* Only the variables of a positive pattern CE at */
+      /* the top level are visible to the CEs after it. */
+      /*================================================*/
+
+      theCE = *link;
+      if ((theCE->pnType == PATTERN_CE_NODE) &&
+	  (!theCE->negated) && (!theCE->exists) &&
+	  (theCE->beginNandDepth == 1) && (theCE->endNandDepth == 1) &&
+	  CollectJoinOrderVariables (theCE, &prefixNode))
+	{
+	  AddJoinOrderVariables (&prefixNode, &bound);
+	}
+
+      link = &theCE->bottom;
+    }
+
+  CL_genfree (theEnv, bound.names, sizeof (CLIPSLexeme *) * bound.size);
+
+  return changed;
+}
+
+/**************************************************************/
+/* ReorderJoinCERun: Orders a run of pattern CEs greedily, by */
+/*   choosing each time the CE expected to produce the fewest */
+/*   partial matches among those whose variable references    */
+/*   are satisfied. A CE sharing variables with the preceding */
+/*   ones is expected to produce its observed fanout, or one  */
+/*   partial match per partial match when it was not observed */
+/*   sharing variables with the CEs preceding it, and any     */
+/*   other CE a cross product with its alpha memory. The new  */
+/*   order is used if its cost, the sum of the expected sizes */
+/*   of the beta memories, is lower than the one of the order */
+/*   of the rule's joins, which is kept otherwise.            */
+/**************************************************************/
+static bool
+ReorderJoinCERun (Environment * theEnv,
+		  struct lhsParseNode **link,
+		  unsigned short runLength,
+		  struct joinOrderCE *statistics,
+		  struct joinOrderVariables *bound)
+{
+  struct joinOrderNode *nodes, *best, **oldOrder, **newOrder, **theOrder;
+  struct lhsParseNode *theCE;
+  unsigned short i, j, k, startCount = bound->count;
+  double oldCost = 0.0, newCost = 0.0, size, estimate, bestEstimate = 0.0;
+  bool eligible, valid = true, changed = false;
+
+  nodes = (struct joinOrderNode *)
+    CL_genalloc (theEnv, sizeof (struct joinOrderNode) * runLength);
+  oldOrder = (struct joinOrderNode **)
+    CL_genalloc (theEnv, sizeof (struct joinOrderNode *) * runLength);
+  newOrder = (struct joinOrderNode **)
+    CL_genalloc (theEnv, sizeof (struct joinOrderNode *) * runLength);
+
+  for (i = 0, theCE = *link; i < runLength; i++, theCE = theCE->bottom)
+    {
+      nodes[i].theCE = theCE;
+      nodes[i].statistics = &statistics[theCE->whichCE];
+      nodes[i].placed = false;
+      if (!CollectJoinOrderVariables (theCE, &nodes[i]))
+	{
+	  valid = false;
+	}
+
+      for (j = 0; j < i; j++)
+	{
+	  if (nodes[j].statistics == nodes[i].statistics)
+	    {
+	      valid = false;
+	    }
+	}
+
+      /*===================================*/
+      /* Sort the CEs by their position in */
+      /* the current order of the joins.   */
+      /*===================================*/
+
+      for (j = i; (j > 0) &&
+	   (oldOrder[j - 1]->statistics->position >
+	    nodes[i].statistics->position); j--)
+	{
+	  oldOrder[j] = oldOrder[j - 1];
+	}
+      oldOrder[j] = &nodes[i];
+    }
+
+  if (!valid)
+    {
+      for (i = 0; i < runLength; i++)
+	{
+	  AddJoinOrderVariables (&nodes[i], bound);
+	}
+      CL_genfree (theEnv, nodes, sizeof (struct joinOrderNode) * runLength);
+      CL_genfree (theEnv, oldOrder,
+		  sizeof (struct joinOrderNode *) * runLength);
+      CL_genfree (theEnv, newOrder,
+		  sizeof (struct joinOrderNode *) * runLength);
+      return false;
+    }
+
+   /*=========================================================*/
+  /* Compute the cost of the current order, noting which CEs */
+  /* shared variables with the preceding CEs when their      */
+  /* fanout was observed.                                    */
+   /*=========================================================*/
+
+  size = 1.0;
+  for (i = 0; i < runLength; i++)
+    {
+      oldOrder[i]->connectedBefore = JoinOrderConnected (oldOrder[i], bound);
+      size *= JoinOrderEstimate (oldOrder[i], oldOrder[i]->connectedBefore);
+      oldCost += size;
+      AddJoinOrderVariables (oldOrder[i], bound);
+    }
+  bound->count = startCount;
+
+   /*=========================================*/
+  /* Choose the CEs of the new order one at  */
+  /* a time, ties keeping the current order. */
+   /*=========================================*/
+
+  size = 1.0;
+  for (i = 0; valid && (i < runLength); i++)
+    {
+      best = NULL;
+      for (j = 0; j < runLength; j++)
+	{
+	  if (oldOrder[j]->placed)
+	    {
+	      continue;
+	    }
+
+	  eligible = true;
+	  for (k = 0; eligible && (k < oldOrder[j]->usedCount); k++)
+	    {
+	      if ((!JoinOrderVariableFound (oldOrder[j]->used[k],
+					    bound->names, bound->count)) &&
+		  (!JoinOrderVariableFound (oldOrder[j]->used[k],
+					    oldOrder[j]->bound,
+					    oldOrder[j]->boundCount)))
+		{
+		  eligible = false;
+		}
+	    }
+
+	 /*================================================*/
+	  /* A pattern address can't be referred to before */
+	  /* the pattern CE to which it is bound.          */
+	 /*================================================*/
+
+	  for (k = 0; eligible && (k < runLength); k++)
+	    {
+	      theCE = nodes[k].theCE;
+	      if ((&nodes[k] != oldOrder[j]) && (!nodes[k].placed) &&
+		  (theCE->value != NULL) &&
+		  (JoinOrderVariableFound (theCE->lexemeValue,
+					   oldOrder[j]->bound,
+					   oldOrder[j]->boundCount) ||
+		   JoinOrderVariableFound (theCE->lexemeValue,
+					   oldOrder[j]->used,
+					   oldOrder[j]->usedCount)))
+		{
+		  eligible = false;
+		}
+	    }
+
+	  if (!eligible)
+	    {
+	      continue;
+	    }
+
+	  estimate =
+	    JoinOrderEstimate (oldOrder[j],
+			       JoinOrderConnected (oldOrder[j], bound));
+	  if ((best == NULL) || (estimate < bestEstimate))
+	    {
+	      best = oldOrder[j];
+	      bestEstimate = estimate;
+	    }
+	}
+
+      if (best == NULL)
+	{
+	  valid = false;
+	  break;
+	}
+
+      best->placed = true;
+      newOrder[i] = best;
+      size *= bestEstimate;
+      newCost += size;
+      AddJoinOrderVariables (best, bound);
+    }
+  bound->count = startCount;
+
+   /*=========================================*/
+  /* Relink the CEs in the chosen order, and */
+  /* leave the variables of the run bound.   */
+   /*=========================================*/
+
+  theOrder = oldOrder;
+  if (valid && (newCost < oldCost))
+    {
+      for (i = 0; i < runLength; i++)
+	{
+	  if (newOrder[i] != oldOrder[i])
+	    {
+	      changed = true;
+	    }
+	}
+      theOrder = newOrder;
+    }
+
+  theCE = nodes[runLength - 1].theCE->bottom;
+  for (i = 0; i < runLength; i++)
+    {
+      *link = theOrder[i]->theCE;
+      link = &theOrder[i]->theCE->bottom;
+      AddJoinOrderVariables (theOrder[i], bound);
+    }
+  *link = theCE;
+
+  CL_genfree (theEnv, nodes, sizeof (struct joinOrderNode) * runLength);
+  CL_genfree (theEnv, oldOrder, sizeof (struct joinOrderNode *) * runLength);
+  CL_genfree (theEnv, newOrder, sizeof (struct joinOrderNode *) * runLength);
+
+  return changed;
+}
+
+/*************************************************************/
+/* JoinOrderCandidate: Returns true if a CE at the top level */
+/*   of a disjunct is a positive pattern CE specified by the */
+/*   user for which join statistics are known.               */
+/*************************************************************/
+static bool
+JoinOrderCandidate (struct lhsParseNode *theCE,
+		    struct joinOrderCE *statistics)
+{
+  return (theCE->pnType == PATTERN_CE_NODE) && theCE->userCE &&
+    (!theCE->negated) && (!theCE->exists) &&
+    (theCE->beginNandDepth == 1) && (theCE->endNandDepth == 1) &&
+    (theCE->whichCE != 0) && statistics[theCE->whichCE].known;
+}
+
+/**************************************************************/
+/* CollectJoinOrderVariables: Collects the variables of a     */
+/*   pattern CE. A variable is bound by the CE when it is its */
+/*   pattern address or the first constraint of a field with  */
+/*   no '|' constraint, and any other reference to a variable */
+/*   requires it to be bound before or by the CE. Returns     */
+/*   false if the CE has too many variables to be reordered.  */
+/**************************************************************/
+static bool
+CollectJoinOrderVariables (struct lhsParseNode *theCE,
+			   struct joinOrderNode *theNode)
+{
+  struct lhsParseNode *theSlot, *theField;
+
+  theNode->boundCount = 0;
+  theNode->usedCount = 0;
+
+  if (theCE->value != NULL)
+    {
+      theNode->bound[theNode->boundCount++] = theCE->lexemeValue;
+    }
+
+  for (theSlot = theCE->right; theSlot != NULL; theSlot = theSlot->right)
+    {
+      if (!theSlot->multifieldSlot)
+	{
+	  if (!CollectJoinOrderField (theSlot, theNode))
+	    {
+	      return false;
+	    }
+	  continue;
+	}
+
+      for (theField = theSlot->bottom; theField != NULL;
+	   theField = theField->right)
+	{
+	  if (!CollectJoinOrderField (theField, theNode))
+	    {
+	      return false;
+	    }
+	}
+    }
+
+  return true;
+}
+
+/******************************************************/
+/* CollectJoinOrderField: Collects the variables of a */
+/*   single field or slot of a pattern CE.            */
+/******************************************************/
+static bool
+CollectJoinOrderField (struct lhsParseNode *theField,
+		       struct joinOrderNode *theNode)
+{
+  struct lhsParseNode *orField, *andField;
+
+  if (((theField->pnType == SF_VARIABLE_NODE) ||
+       (theField->pnType == MF_VARIABLE_NODE)) && (!theField->negated) &&
+      ((theField->bottom == NULL) || (theField->bottom->bottom == NULL)))
+    {
+      if (theNode->boundCount == JOIN_ORDER_MAX_VARIABLES)
+	{
+	  return false;
+	}
+      theNode->bound[theNode->boundCount++] = theField->lexemeValue;
+    }
+
+  for (orField = theField->bottom; orField != NULL; orField = orField->bottom)
+    {
+      for (andField = orField; andField != NULL; andField = andField->right)
+	{
+	  if ((andField->pnType == SF_VARIABLE_NODE) ||
+	      (andField->pnType == MF_VARIABLE_NODE))
+	    {
+	      if (theNode->usedCount == JOIN_ORDER_MAX_VARIABLES)
+		{
+		  return false;
+		}
+	      theNode->used[theNode->usedCount++] = andField->lexemeValue;
+	    }
+	  else if ((andField->pnType == PREDICATE_CONSTRAINT_NODE) ||
+		   (andField->pnType == RETURN_VALUE_CONSTRAINT_NODE))
+	    {
+	      if (!CollectJoinOrderExpression (andField->expression, theNode))
+		{
+		  return false;
+		}
+	    }
+	}
+    }
+
+  return true;
+}
+
+/***********************************************************/
+/* CollectJoinOrderExpression: Collects the variables used */
+/*   in the expression of a predicate or return value      */
+/*   constraint.                                           */
+/***********************************************************/
+static bool
+CollectJoinOrderExpression (struct lhsParseNode *theExpression,
+			    struct joinOrderNode *theNode)
+{
+  for (; theExpression != NULL; theExpression = theExpression->right)
+    {
+      if ((theExpression->pnType == SF_VARIABLE_NODE) ||
+	  (theExpression->pnType == MF_VARIABLE_NODE))
+	{
+	  if (theNode->usedCount == JOIN_ORDER_MAX_VARIABLES)
+	    {
+	      return false;
+	    }
+	  theNode->used[theNode->usedCount++] = theExpression->lexemeValue;
+	}
+
+      if (!CollectJoinOrderExpression (theExpression->bottom, theNode))
+	{
+	  return false;
+	}
+    }
+
+  return true;
+}
+
+/*******************************************************/
+/* JoinOrderVariableFound: Returns true if a variable  */
+/*   is found in an array of variables.                */
+/*******************************************************/
+static bool
+JoinOrderVariableFound (CLIPSLexeme * theVariable,
+			CLIPSLexeme ** theVariables, unsigned short count)
+{
+  unsigned short i;
+
+  for (i = 0; i < count; i++)
+    {
+      if (theVariables[i] == theVariable)
+	{
+	  return true;
+	}
+    }
+
+  return false;
+}
+
+/**********************************************************/
+/* JoinOrderConnected: Returns true if a CE refers to any */
+/*   variable bound by the CEs preceding it.              */
+/**********************************************************/
+static bool
+JoinOrderConnected (struct joinOrderNode *theNode,
+		    struct joinOrderVariables *bound)
+{
+  unsigned short i;
+
+  for (i = 0; i < theNode->boundCount; i++)
+    {
+      if (JoinOrderVariableFound (theNode->bound[i], bound->names,
+				  bound->count))
+	{
+	  return true;
+	}
+    }
+
+  for (i = 0; i < theNode->usedCount; i++)
+    {
+      if (JoinOrderVariableFound (theNode->used[i], bound->names,
+				  bound->count))
+	{
+	  return true;
+	}
+    }
+
+  return false;
+}
+
+/*******************************************************/
+/* AddJoinOrderVariables: Adds the variables of a CE   */
+/*   to the variables bound by the preceding CEs.      */
+/*******************************************************/
+static void
+AddJoinOrderVariables (struct joinOrderNode *theNode,
+		       struct joinOrderVariables *bound)
+{
+  unsigned short i;
+
+  for (i = 0; (i < theNode->boundCount) && (bound->count < bound->size); i++)
+    {
+      bound->names[bound->count++] = theNode->bound[i];
+    }
+
+  for (i = 0; (i < theNode->usedCount) && (bound->count < bound->size); i++)
+    {
+      bound->names[bound->count++] = theNode->used[i];
+    }
+}
+
+/************************************************************/
+/* JoinOrderEstimate: Returns the number of partial matches */
+/*   expected from a join of a CE per partial match of the  */
+/*   CEs preceding it.                                      */
+/************************************************************/
+static double
+JoinOrderEstimate (struct joinOrderNode *theNode, bool connected)
+{
+  double cardinality = theNode->statistics->cardinality;
+
+  if (!connected)
+    {
+      return cardinality;
+    }
+
+  if (theNode->connectedBefore && (theNode->statistics->fanout >= 0.0))
+    {
+      return theNode->statistics->fanout;
+    }
+
+  return (cardinality < 1.0) ? cardinality : 1.0;
+}
+
 #endif
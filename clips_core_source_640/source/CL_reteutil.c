@@ -62,6 +62,7 @@
 /*************************************************************/
 
 #include <stdio.h>
+#include <limits.h>
 
 #include "setup.h"
 
@@ -98,11 +99,23 @@ static void UnlinkAlphaMemory (Environment *, struct patternNodeHeader *,
 static void UnlinkAlphaMemoryBucketSiblings (Environment *,
 					     struct alphaMemoryHash *);
 static void InitializePMLinks (struct partialMatch *);
-static void UnlinkBetaPartialMatchfromAlphaAndBetaLineage (struct partialMatch
+static void ReleaseBlockedLinks (Environment *, struct partialMatch *);
+static void UnlinkBetaPartialMatchfromAlphaAndBetaLineage (Environment *,
+							   struct partialMatch
 							   *);
 static int CountPriorPatterns (struct joinNode *);
-static void ResizeBetaMemory (Environment *, struct betaMemory *);
+static unsigned long BetaMemoryKey (unsigned long);
+static unsigned long FindBetaMemorySlot (struct betaMemory *, unsigned long);
+static unsigned long ClaimBetaMemorySlot (Environment *, struct betaMemory *,
+					  unsigned long);
+static void RehashBetaMemory (Environment *, struct betaMemory *,
+			      unsigned long);
+static void QueueBetaMemoryShrink (Environment *, struct betaMemory *);
+static void DequeueBetaMemoryShrink (Environment *, struct betaMemory *);
 static void CL_ResetBetaMemory (Environment *, struct betaMemory *);
+static bool JoinWantsRightActivations (struct joinNode *);
+static void RelinkJoinToAlphaMemory (struct joinNode *);
+static void UnlinkJoinFromAlphaMemory (struct joinNode *);
 #if (CONSTRUCT_COMPILER || BLOAD_AND_BSAVE) && (! RUN_TIME)
 static void TagNetworkTraverseJoins (Environment *, unsigned long *,
 				     unsigned long *, struct joinNode *);
@@ -152,6 +165,7 @@ CL_CopyPartialMatch (Environment * theEnv, struct partialMatch *list)
   linker =
     get_var_struct (theEnv, partialMatch,
 		    sizeof (struct genericMatch) * (list->bcount - 1));
+  DefruleData (theEnv)->PartialMatchCount++;
 
   InitializePMLinks (linker);
   linker->betaMemory = true;
@@ -176,6 +190,7 @@ CL_CreateEmptyPartialMatch (Environment * theEnv)
   struct partialMatch *linker;
 
   linker = get_struct (theEnv, partialMatch);
+  DefruleData (theEnv)->PartialMatchCount++;
 
   InitializePMLinks (linker);
   linker->betaMemory = true;
@@ -189,6 +204,16 @@ CL_CreateEmptyPartialMatch (Environment * theEnv)
   return (linker);
 }
 
+/***************************************************/
+/* CL_GetPartialMatchCount: Returns the number of  */
+/*   partial matches, alpha or beta, ever created. */
+/***************************************************/
+unsigned long long
+CL_GetPartialMatchCount (Environment * theEnv)
+{
+  return DefruleData (theEnv)->PartialMatchCount;
+}
+
 /**********************/
 /* InitializePMLinks: */
 /**********************/
@@ -204,11 +229,50 @@ InitializePMLinks (struct partialMatch *theMatch)
   theMatch->children = NULL;
   theMatch->rightParent = NULL;
   theMatch->leftParent = NULL;
-  theMatch->blockList = NULL;
-  theMatch->nextBlocked = NULL;
-  theMatch->prevBlocked = NULL;
   theMatch->marker = NULL;
-  theMatch->dependents = NULL;
+  theMatch->extra = NULL;
+}
+
+/********************************************************************/
+/* CL_GetPartialMatchExtra: Returns the structure holding the links */
+/*   of a partial match used by logical, not and exists CEs,        */
+/*   allocating it the first time one of these links is set.       */
+/********************************************************************/
+struct partialMatchExtra *
+CL_GetPartialMatchExtra (Environment * theEnv, struct partialMatch *thePM)
+{
+  if (thePM->extra == NULL)
+    {
+      thePM->extra = get_struct (theEnv, partialMatchExtra);
+      thePM->extra->dependents = NULL;
+      thePM->extra->blockList = NULL;
+      thePM->extra->nextBlocked = NULL;
+      thePM->extra->prevBlocked = NULL;
+    }
+
+  return thePM->extra;
+}
+
+/********************************************************************/
+/* CL_ReleasePartialMatchExtra: Returns the structure holding the   */
+/*   links of a partial match used by logical, not and exists CEs   */
+/*   to the pool of free memory once none of these links is set.    */
+/********************************************************************/
+void
+CL_ReleasePartialMatchExtra (Environment * theEnv,
+			     struct partialMatch *thePM)
+{
+  struct partialMatchExtra *theExtra = thePM->extra;
+
+  if ((theExtra == NULL) || (theExtra->dependents != NULL) ||
+      (theExtra->blockList != NULL) || (theExtra->nextBlocked != NULL) ||
+      (theExtra->prevBlocked != NULL))
+    {
+      return;
+    }
+
+  rtn_struct (theEnv, partialMatchExtra, theExtra);
+  thePM->extra = NULL;
 }
 
 /**********************/
@@ -242,7 +306,11 @@ CL_UpdateBetaPMLinks (Environment * theEnv,
   /* Update the node's linked list. */
    /*================================*/
 
-  betaLocation = hashValue % theMemory->size;
+  betaLocation = ClaimBetaMemorySlot (theEnv, theMemory, hashValue);
+  if ((theMemory->size > 1) && (theMemory->beta[betaLocation] == NULL))
+    {
+      theMemory->live++;
+    }
 
   if (side == LHS)
     {
@@ -272,6 +340,10 @@ CL_UpdateBetaPMLinks (Environment * theEnv,
   if (side == LHS)
     {
       join->memoryLeftAdds++;
+      if ((theMemory->count == 1) && RIGHT_UNLINKABLE_JOIN (join))
+	{
+	  RelinkJoinToAlphaMemory (join);
+	}
     }
   else
     {
@@ -309,16 +381,6 @@ CL_UpdateBetaPMLinks (Environment * theEnv,
       lhsBinds->children = thePM;
       thePM->leftParent = lhsBinds;
     }
-
-  if (!DefruleData (theEnv)->BetaMemoryResizingFlag)
-    {
-      return;
-    }
-
-  if ((theMemory->size > 1) && (theMemory->count > (theMemory->size * 11)))
-    {
-      ResizeBetaMemory (theEnv, theMemory);
-    }
 }
 
 /**********************************************************/
@@ -329,15 +391,21 @@ CL_UpdateBetaPMLinks (Environment * theEnv,
 /*   the next join in the rule.                           */
 /**********************************************************/
 void
-CL_AddBlockedLink (struct partialMatch *thePM, struct partialMatch *rhsBinds)
+CL_AddBlockedLink (Environment * theEnv,
+		   struct partialMatch *thePM, struct partialMatch *rhsBinds)
 {
+  struct partialMatchExtra *blockedExtra, *blockerExtra;
+
+  blockedExtra = CL_GetPartialMatchExtra (theEnv, thePM);
+  blockerExtra = CL_GetPartialMatchExtra (theEnv, rhsBinds);
+
   thePM->marker = rhsBinds;
-  thePM->nextBlocked = rhsBinds->blockList;
-  if (rhsBinds->blockList != NULL)
+  blockedExtra->nextBlocked = blockerExtra->blockList;
+  if (blockerExtra->blockList != NULL)
     {
-      rhsBinds->blockList->prevBlocked = thePM;
+      blockerExtra->blockList->extra->prevBlocked = thePM;
     }
-  rhsBinds->blockList = thePM;
+  blockerExtra->blockList = thePM;
 }
 
 /*************************************************************/
@@ -348,28 +416,52 @@ CL_AddBlockedLink (struct partialMatch *thePM, struct partialMatch *rhsBinds)
 /*   the next join in the rule.                              */
 /*************************************************************/
 void
-CL_RemoveBlockedLink (struct partialMatch *thePM)
+CL_RemoveBlockedLink (Environment * theEnv, struct partialMatch *thePM)
 {
   struct partialMatch *blocker;
 
-  if (thePM->prevBlocked == NULL)
+  blocker = (struct partialMatch *) thePM->marker;
+
+  if (thePM->extra->prevBlocked == NULL)
     {
-      blocker = (struct partialMatch *) thePM->marker;
-      blocker->blockList = thePM->nextBlocked;
+      blocker->extra->blockList = thePM->extra->nextBlocked;
     }
   else
     {
-      thePM->prevBlocked->nextBlocked = thePM->nextBlocked;
+      thePM->extra->prevBlocked->extra->nextBlocked =
+	thePM->extra->nextBlocked;
     }
 
-  if (thePM->nextBlocked != NULL)
+  if (thePM->extra->nextBlocked != NULL)
     {
-      thePM->nextBlocked->prevBlocked = thePM->prevBlocked;
+      thePM->extra->nextBlocked->extra->prevBlocked =
+	thePM->extra->prevBlocked;
     }
 
-  thePM->nextBlocked = NULL;
-  thePM->prevBlocked = NULL;
+  thePM->extra->nextBlocked = NULL;
+  thePM->extra->prevBlocked = NULL;
   thePM->marker = NULL;
+
+  CL_ReleasePartialMatchExtra (theEnv, thePM);
+  CL_ReleasePartialMatchExtra (theEnv, blocker);
+}
+
+/*******************************************************************/
+/* ReleaseBlockedLinks: Clears the blocked links of a partial match */
+/*   unlinked from its blocker and returns its extra links if they  */
+/*   are no longer used.                                            */
+/*******************************************************************/
+static void
+ReleaseBlockedLinks (Environment * theEnv, struct partialMatch *thePM)
+{
+  if (thePM->extra == NULL)
+    {
+      return;
+    }
+
+  thePM->extra->nextBlocked = NULL;
+  thePM->extra->prevBlocked = NULL;
+  CL_ReleasePartialMatchExtra (theEnv, thePM);
 }
 
 /***********************************/
@@ -401,13 +493,17 @@ CL_UnlinkBetaPMFromNodeAndLineage (Environment * theEnv,
   if (side == LHS)
     {
       join->memoryLeftDeletes++;
+      if ((theMemory->count == 0) && RIGHT_UNLINKABLE_JOIN (join))
+	{
+	  UnlinkJoinFromAlphaMemory (join);
+	}
     }
   else
     {
       join->memoryRightDeletes++;
     }
 
-  betaLocation = thePM->hashValue % theMemory->size;
+  betaLocation = FindBetaMemorySlot (theMemory, thePM->hashValue);
 
   if ((side == RHS) && (theMemory->last[betaLocation] == thePM))
     {
@@ -416,7 +512,6 @@ CL_UnlinkBetaPMFromNodeAndLineage (Environment * theEnv,
 
   if (thePM->prevInMemory == NULL)
     {
-      betaLocation = thePM->hashValue % theMemory->size;
       theMemory->beta[betaLocation] = thePM->nextInMemory;
     }
   else
@@ -429,10 +524,15 @@ CL_UnlinkBetaPMFromNodeAndLineage (Environment * theEnv,
       thePM->nextInMemory->prevInMemory = thePM->prevInMemory;
     }
 
+  if ((theMemory->size > 1) && (theMemory->beta[betaLocation] == NULL))
+    {
+      theMemory->live--;
+    }
+
   thePM->nextInMemory = NULL;
   thePM->prevInMemory = NULL;
 
-  UnlinkBetaPartialMatchfromAlphaAndBetaLineage (thePM);
+  UnlinkBetaPartialMatchfromAlphaAndBetaLineage (theEnv, thePM);
 
   if (!DefruleData (theEnv)->BetaMemoryResizingFlag)
     {
@@ -443,6 +543,10 @@ CL_UnlinkBetaPMFromNodeAndLineage (Environment * theEnv,
     {
       CL_ResetBetaMemory (theEnv, theMemory);
     }
+  else
+    {
+      QueueBetaMemoryShrink (theEnv, theMemory);
+    }
 }
 
 /*************************/
@@ -475,13 +579,17 @@ CL_UnlinkNonLeftLineage (Environment * theEnv,
   if (side == LHS)
     {
       join->memoryLeftDeletes++;
+      if ((theMemory->count == 0) && RIGHT_UNLINKABLE_JOIN (join))
+	{
+	  UnlinkJoinFromAlphaMemory (join);
+	}
     }
   else
     {
       join->memoryRightDeletes++;
     }
 
-  betaLocation = thePM->hashValue % theMemory->size;
+  betaLocation = FindBetaMemorySlot (theMemory, thePM->hashValue);
 
   if ((side == RHS) && (theMemory->last[betaLocation] == thePM))
     {
@@ -490,7 +598,6 @@ CL_UnlinkNonLeftLineage (Environment * theEnv,
 
   if (thePM->prevInMemory == NULL)
     {
-      betaLocation = thePM->hashValue % theMemory->size;
       theMemory->beta[betaLocation] = thePM->nextInMemory;
     }
   else
@@ -503,6 +610,11 @@ CL_UnlinkNonLeftLineage (Environment * theEnv,
       thePM->nextInMemory->prevInMemory = thePM->prevInMemory;
     }
 
+  if ((theMemory->size > 1) && (theMemory->beta[betaLocation] == NULL))
+    {
+      theMemory->live--;
+    }
+
    /*=========================*/
   /* Update the alpha lists. */
    /*=========================*/
@@ -533,23 +645,29 @@ CL_UnlinkNonLeftLineage (Environment * theEnv,
   /* Update the blocked lists. */
    /*===========================*/
 
-  if (thePM->prevBlocked == NULL)
+  if (thePM->extra != NULL)
     {
-      tempPM = (struct partialMatch *) thePM->marker;
+      if (thePM->extra->prevBlocked == NULL)
+	{
+	  tempPM = (struct partialMatch *) thePM->marker;
 
-      if (tempPM != NULL)
+	  if ((tempPM != NULL) && (PMBlockList (tempPM) == thePM))
+	    {
+	      tempPM->extra->blockList = thePM->extra->nextBlocked;
+	      CL_ReleasePartialMatchExtra (theEnv, tempPM);
+	    }
+	}
+      else
 	{
-	  tempPM->blockList = thePM->nextBlocked;
+	  thePM->extra->prevBlocked->extra->nextBlocked =
+	    thePM->extra->nextBlocked;
 	}
-    }
-  else
-    {
-      thePM->prevBlocked->nextBlocked = thePM->nextBlocked;
-    }
 
-  if (thePM->nextBlocked != NULL)
-    {
-      thePM->nextBlocked->prevBlocked = thePM->prevBlocked;
+      if (thePM->extra->nextBlocked != NULL)
+	{
+	  thePM->extra->nextBlocked->extra->prevBlocked =
+	    thePM->extra->prevBlocked;
+	}
     }
 
   if (!DefruleData (theEnv)->BetaMemoryResizingFlag)
@@ -561,6 +679,10 @@ CL_UnlinkNonLeftLineage (Environment * theEnv,
     {
       CL_ResetBetaMemory (theEnv, theMemory);
     }
+  else
+    {
+      QueueBetaMemoryShrink (theEnv, theMemory);
+    }
 }
 
 /*******************************************************************/
@@ -571,7 +693,8 @@ CL_UnlinkNonLeftLineage (Environment * theEnv,
 /*   partial match and any of its children in other beta memories. */
 /*******************************************************************/
 static void
-UnlinkBetaPartialMatchfromAlphaAndBetaLineage (struct partialMatch *thePM)
+UnlinkBetaPartialMatchfromAlphaAndBetaLineage (Environment * theEnv,
+					       struct partialMatch *thePM)
 {
   struct partialMatch *tempPM;
 
@@ -629,28 +752,33 @@ UnlinkBetaPartialMatchfromAlphaAndBetaLineage (struct partialMatch *thePM)
   /* Update the blocked lists. */
    /*===========================*/
 
-  if (thePM->prevBlocked == NULL)
+  if (thePM->extra != NULL)
     {
-      tempPM = (struct partialMatch *) thePM->marker;
+      if (thePM->extra->prevBlocked == NULL)
+	{
+	  tempPM = (struct partialMatch *) thePM->marker;
 
-      if (tempPM != NULL)
+	  if ((tempPM != NULL) && (PMBlockList (tempPM) == thePM))
+	    {
+	      tempPM->extra->blockList = thePM->extra->nextBlocked;
+	      CL_ReleasePartialMatchExtra (theEnv, tempPM);
+	    }
+	}
+      else
 	{
-	  tempPM->blockList = thePM->nextBlocked;
+	  thePM->extra->prevBlocked->extra->nextBlocked =
+	    thePM->extra->nextBlocked;
 	}
-    }
-  else
-    {
-      thePM->prevBlocked->nextBlocked = thePM->nextBlocked;
-    }
 
-  if (thePM->nextBlocked != NULL)
-    {
-      thePM->nextBlocked->prevBlocked = thePM->prevBlocked;
+      if (thePM->extra->nextBlocked != NULL)
+	{
+	  thePM->extra->nextBlocked->extra->prevBlocked =
+	    thePM->extra->prevBlocked;
+	}
     }
 
   thePM->marker = NULL;
-  thePM->nextBlocked = NULL;
-  thePM->prevBlocked = NULL;
+  ReleaseBlockedLinks (theEnv, thePM);
 
    /*===============================================*/
   /* Remove parent reference from the child links. */
@@ -699,6 +827,7 @@ MergePartial_Matches (Environment * theEnv,
   linker =
     get_var_struct (theEnv, partialMatch,
 		    sizeof (struct genericMatch) * lhsBind->bcount);
+  DefruleData (theEnv)->PartialMatchCount++;
 
    /*============================================*/
   /* Set the flags to their appropriate values. */
@@ -761,6 +890,9 @@ CL_InitializePatternHeader (Environment * theEnv,
   theHeader->beginSlot = false;
   theHeader->endSlot = false;
   theHeader->selector = false;
+  theHeader->activeJoinsValid = false;
+  theHeader->flushing = false;
+  theHeader->activeJoin = NULL;
 }
 
 /******************************************************************/
@@ -788,6 +920,7 @@ CL_CreateAlphaMatch (Environment * theEnv,
    /*==================================================*/
 
   theMatch = get_struct (theEnv, partialMatch);
+  DefruleData (theEnv)->PartialMatchCount++;
   InitializePMLinks (theMatch);
   theMatch->betaMemory = false;
   theMatch->busy = false;
@@ -930,7 +1063,7 @@ CL_FlushAlphaBetaMemory (Environment * theEnv, struct partialMatch *pfl)
     {
       pfltemp = pfl->nextInMemory;
 
-      UnlinkBetaPartialMatchfromAlphaAndBetaLineage (pfl);
+      UnlinkBetaPartialMatchfromAlphaAndBetaLineage (theEnv, pfl);
       CL_ReturnPartialMatch (theEnv, pfl);
 
       pfl = pfltemp;
@@ -1210,7 +1343,12 @@ CL_GetLeftBetaMemory (struct joinNode *theJoin, unsigned long hashValue)
 {
   unsigned long betaLocation;
 
-  betaLocation = hashValue % theJoin->leftMemory->size;
+  betaLocation = FindBetaMemorySlot (theJoin->leftMemory, hashValue);
+
+  if (betaLocation == theJoin->leftMemory->size)
+    {
+      return NULL;
+    }
 
   return theJoin->leftMemory->beta[betaLocation];
 }
@@ -1224,7 +1362,12 @@ CL_GetRightBetaMemory (struct joinNode *theJoin, unsigned long hashValue)
 {
   unsigned long betaLocation;
 
-  betaLocation = hashValue % theJoin->rightMemory->size;
+  betaLocation = FindBetaMemorySlot (theJoin->rightMemory, hashValue);
+
+  if (betaLocation == theJoin->rightMemory->size)
+    {
+      return NULL;
+    }
 
   return theJoin->rightMemory->beta[betaLocation];
 }
@@ -1238,8 +1381,15 @@ CL_ReturnLeftMemory (Environment * theEnv, struct joinNode *theJoin)
 {
   if (theJoin->leftMemory == NULL)
     return;
+  if (theJoin->leftMemory->shrinkPending)
+    DequeueBetaMemoryShrink (theEnv, theJoin->leftMemory);
   CL_genfree (theEnv, theJoin->leftMemory->beta,
 	      sizeof (struct partialMatch *) * theJoin->leftMemory->size);
+  if (theJoin->leftMemory->hashes != NULL)
+    {
+      CL_genfree (theEnv, theJoin->leftMemory->hashes,
+		  sizeof (unsigned long) * theJoin->leftMemory->size);
+    }
   rtn_struct (theEnv, betaMemory, theJoin->leftMemory);
   theJoin->leftMemory = NULL;
 }
@@ -1253,10 +1403,17 @@ CL_ReturnRightMemory (Environment * theEnv, struct joinNode *theJoin)
 {
   if (theJoin->rightMemory == NULL)
     return;
+  if (theJoin->rightMemory->shrinkPending)
+    DequeueBetaMemoryShrink (theEnv, theJoin->rightMemory);
   CL_genfree (theEnv, theJoin->rightMemory->beta,
 	      sizeof (struct partialMatch *) * theJoin->rightMemory->size);
   CL_genfree (theEnv, theJoin->rightMemory->last,
 	      sizeof (struct partialMatch *) * theJoin->rightMemory->size);
+  if (theJoin->rightMemory->hashes != NULL)
+    {
+      CL_genfree (theEnv, theJoin->rightMemory->hashes,
+		  sizeof (unsigned long) * theJoin->rightMemory->size);
+    }
   rtn_struct (theEnv, betaMemory, theJoin->rightMemory);
   theJoin->rightMemory = NULL;
 }
@@ -1433,6 +1590,172 @@ CL_DestroyAlphaMemory (Environment * theEnv,
   theHeader->lastHash = NULL;
 }
 
+/*******************************************************************/
+/* JoinWantsRightActivations: A join which is not the first join  */
+/*   of its rule only compares a partial match entering from its  */
+/*   alpha memory with its left memory, so it has nothing to do   */
+/*   with such a match while that memory is empty.                */
+/*******************************************************************/
+static bool
+JoinWantsRightActivations (struct joinNode *join)
+{
+  return (join->firstJoin || (join->leftMemory == NULL) ||
+	  (join->leftMemory->count > 0));
+}
+
+/*******************************************************************/
+/* CL_FirstActiveJoin: Returns the first join of the list of joins */
+/*   entered by a pattern which wants right activations. This     */
+/*   list follows the order of the entryJoin list, since an alpha */
+/*   match must reach the joins of a rule with several patterns   */
+/*   matching it in that order. It is rebuilt here after the      */
+/*   entryJoin list changed, and otherwise kept up to date when   */
+/*   the left memory of a join becomes empty or not empty.        */
+/*******************************************************************/
+struct joinNode *
+CL_FirstActiveJoin (struct patternNodeHeader *theHeader)
+{
+  struct joinNode *theJoin, *lastActive = NULL;
+
+  if (theHeader->activeJoinsValid)
+    {
+      return theHeader->activeJoin;
+    }
+
+  theHeader->activeJoin = NULL;
+  for (theJoin = theHeader->entryJoin;
+       theJoin != NULL; theJoin = theJoin->rightMatchNode)
+    {
+      theJoin->nextActiveJoin = NULL;
+      if (!JoinWantsRightActivations (theJoin))
+	{
+	  theJoin->rightUnlinked = true;
+	  continue;
+	}
+
+      theJoin->rightUnlinked = false;
+      if (lastActive == NULL)
+	{
+	  theHeader->activeJoin = theJoin;
+	}
+      else
+	{
+	  lastActive->nextActiveJoin = theJoin;
+	}
+      lastActive = theJoin;
+    }
+
+  theHeader->activeJoinsValid = true;
+  return theHeader->activeJoin;
+}
+
+/*******************************************************************/
+/* CL_NextActiveJoin: Returns the join following a join in the    */
+/*   list of joins wanting right activations. Driving an alpha    */
+/*   match through a join may unlink that join from the list, in  */
+/*   which case the next one is searched in the entryJoin list.   */
+/*******************************************************************/
+struct joinNode *
+CL_NextActiveJoin (struct joinNode *theJoin)
+{
+  if (!theJoin->rightUnlinked)
+    {
+      return theJoin->nextActiveJoin;
+    }
+
+  for (theJoin = theJoin->rightMatchNode;
+       theJoin != NULL; theJoin = theJoin->rightMatchNode)
+    {
+      if (!theJoin->rightUnlinked)
+	{
+	  return theJoin;
+	}
+    }
+
+  return NULL;
+}
+
+/*******************************************************************/
+/* RelinkJoinToAlphaMemory: Puts back a join whose left memory is */
+/*   no longer empty in the list of joins wanting right           */
+/*   activations, at its place in the entryJoin list.             */
+/*******************************************************************/
+static void
+RelinkJoinToAlphaMemory (struct joinNode *join)
+{
+  struct patternNodeHeader *theHeader;
+  struct joinNode *theJoin, *lastActive = NULL;
+
+  theHeader = (struct patternNodeHeader *) join->rightSideEntryStructure;
+  if ((!theHeader->activeJoinsValid) || (!join->rightUnlinked))
+    {
+      return;
+    }
+
+  for (theJoin = theHeader->entryJoin;
+       theJoin != join; theJoin = theJoin->rightMatchNode)
+    {
+      if (!theJoin->rightUnlinked)
+	{
+	  lastActive = theJoin;
+	}
+    }
+
+  if (lastActive == NULL)
+    {
+      join->nextActiveJoin = theHeader->activeJoin;
+      theHeader->activeJoin = join;
+    }
+  else
+    {
+      join->nextActiveJoin = lastActive->nextActiveJoin;
+      lastActive->nextActiveJoin = join;
+    }
+
+  join->rightUnlinked = false;
+}
+
+/*******************************************************************/
+/* UnlinkJoinFromAlphaMemory: Removes a join whose left memory    */
+/*   became empty from the list of joins wanting right            */
+/*   activations.                                                 */
+/*******************************************************************/
+static void
+UnlinkJoinFromAlphaMemory (struct joinNode *join)
+{
+  struct patternNodeHeader *theHeader;
+  struct joinNode *theJoin, *lastActive = NULL;
+
+  theHeader = (struct patternNodeHeader *) join->rightSideEntryStructure;
+  if ((!theHeader->activeJoinsValid) || join->rightUnlinked)
+    {
+      return;
+    }
+
+  for (theJoin = theHeader->activeJoin;
+       (theJoin != NULL) && (theJoin != join);
+       theJoin = theJoin->nextActiveJoin)
+    {
+      lastActive = theJoin;
+    }
+
+  if (theJoin == NULL)
+    {
+      return;
+    }
+
+  if (lastActive == NULL)
+    {
+      theHeader->activeJoin = join->nextActiveJoin;
+    }
+  else
+    {
+      lastActive->nextActiveJoin = join->nextActiveJoin;
+    }
+
+  join->rightUnlinked = true;
+}
+
 /*********************/
 /* CL_FlushAlphaMemory: */
 /*********************/
@@ -1640,72 +1963,297 @@ CL_ComputeRightHashValue (Environment * theEnv,
   return hashValue;
 }
 
-/*********************/
-/* ResizeBetaMemory: */
-/*********************/
-void
-ResizeBetaMemory (Environment * theEnv, struct betaMemory *theMemory)
+/*******************************************************/
+/* BetaMemoryKey: The value stored in the hashes array */
+/*   of a beta memory for a hash value. The largest    */
+/*   hash value gets the key of its predecessor, so a  */
+/*   chain may then hold both, which the joins check   */
+/*   anyway by comparing the hashValue of each match.  */
+/*******************************************************/
+static unsigned long
+BetaMemoryKey (unsigned long hashValue)
+{
+  if (hashValue == ULONG_MAX)
+    {
+      return ULONG_MAX;
+    }
+
+  return hashValue + 1;
+}
+
+/********************************************************/
+/* FindBetaMemorySlot: Returns the slot holding the     */
+/*   partial matches of a hash value in a beta memory,  */
+/*   or the size of the memory if it has no such slot.  */
+/*   Linear probing only reads the hashes array.        */
+/********************************************************/
+static unsigned long
+FindBetaMemorySlot (struct betaMemory *theMemory, unsigned long hashValue)
+{
+  unsigned long slot, key;
+
+  if (theMemory->size == 1)
+    {
+      return 0;
+    }
+
+  if (theMemory->hashes == NULL)
+    {
+      return theMemory->size;
+    }
+
+  key = BetaMemoryKey (hashValue);
+  slot = (key - 1) % theMemory->size;
+
+  while (theMemory->hashes[slot] != 0)
+    {
+      if (theMemory->hashes[slot] == key)
+	{
+	  return slot;
+	}
+
+      if (++slot == theMemory->size)
+	{
+	  slot = 0;
+	}
+    }
+
+  return theMemory->size;
+}
+
+/**********************************************************/
+/* ClaimBetaMemorySlot: Returns the slot of a hash value  */
+/*   in a beta memory, claiming a free one if needed. At  */
+/*   least a quarter of the slots are kept free, so the   */
+/*   memory is rehashed into a larger table once the grow */
+/*   load of its slots hold partial matches, otherwise    */
+/*   into a table of the same size without empty slots.   */
+/**********************************************************/
+static unsigned long
+ClaimBetaMemorySlot (Environment * theEnv,
+		     struct betaMemory *theMemory, unsigned long hashValue)
+{
+  unsigned long slot, key;
+
+  if (theMemory->size == 1)
+    {
+      return 0;
+    }
+
+  if (theMemory->hashes == NULL)
+    {
+      theMemory->hashes =
+	(unsigned long *) CL_genalloc (theEnv,
+				       sizeof (unsigned long) *
+				       theMemory->size);
+      memset (theMemory->hashes, 0, sizeof (unsigned long) * theMemory->size);
+      theMemory->used = 0;
+    }
+
+  key = BetaMemoryKey (hashValue);
+  slot = (key - 1) % theMemory->size;
+
+  while (theMemory->hashes[slot] != 0)
+    {
+      if (theMemory->hashes[slot] == key)
+	{
+	  return slot;
+	}
+
+      if (++slot == theMemory->size)
+	{
+	  slot = 0;
+	}
+    }
+
+  if (((theMemory->used + 1) * 4) > (theMemory->size * 3))
+    {
+      if (((theMemory->live + 1) * 100) >
+	  (theMemory->size * DefruleData (theEnv)->BetaMemoryGrowLoad))
+	{
+	  RehashBetaMemory (theEnv, theMemory, theMemory->size * 11);
+	}
+      else
+	{
+	  RehashBetaMemory (theEnv, theMemory, theMemory->size);
+	}
+
+      slot = (key - 1) % theMemory->size;
+      while (theMemory->hashes[slot] != 0)
+	{
+	  if (++slot == theMemory->size)
+	    {
+	      slot = 0;
+	    }
+	}
+    }
+
+  theMemory->hashes[slot] = key;
+  theMemory->used++;
+
+  return slot;
+}
+
+/*********************************************************/
+/* RehashBetaMemory: Moves the non empty slots of a beta */
+/*   memory into a table of the given size. Each chain   */
+/*   is moved as a whole, without touching its partial   */
+/*   matches, and the slots left empty are dropped.      */
+/*********************************************************/
+static void
+RehashBetaMemory (Environment * theEnv,
+		  struct betaMemory *theMemory, unsigned long newSize)
 {
-  struct partialMatch **oldArray, **lastAdd, *thePM, *nextPM;
-  unsigned long i, oldSize, betaLocation;
+  struct partialMatch **oldBeta, **oldLast;
+  unsigned long *oldHashes;
+  unsigned long i, slot, oldSize;
 
   oldSize = theMemory->size;
-  oldArray = theMemory->beta;
+  oldBeta = theMemory->beta;
+  oldLast = theMemory->last;
+  oldHashes = theMemory->hashes;
 
-  theMemory->size = oldSize * 11;
+  theMemory->size = newSize;
   theMemory->beta =
     (struct partialMatch **) CL_genalloc (theEnv,
 					  sizeof (struct partialMatch *) *
-					  theMemory->size);
+					  newSize);
+  memset (theMemory->beta, 0, sizeof (struct partialMatch *) * newSize);
 
-  lastAdd =
-    (struct partialMatch **) CL_genalloc (theEnv,
-					  sizeof (struct partialMatch *) *
-					  theMemory->size);
-  memset (theMemory->beta, 0,
-	  sizeof (struct partialMatch *) * theMemory->size);
-  memset (lastAdd, 0, sizeof (struct partialMatch *) * theMemory->size);
+  if (oldLast != NULL)
+    {
+      theMemory->last =
+	(struct partialMatch **) CL_genalloc (theEnv,
+					      sizeof (struct partialMatch *) *
+					      newSize);
+      memset (theMemory->last, 0, sizeof (struct partialMatch *) * newSize);
+    }
+
+  theMemory->hashes =
+    (unsigned long *) CL_genalloc (theEnv, sizeof (unsigned long) * newSize);
+  memset (theMemory->hashes, 0, sizeof (unsigned long) * newSize);
+  theMemory->used = 0;
 
   for (i = 0; i < oldSize; i++)
     {
-      thePM = oldArray[i];
-      while (thePM != NULL)
+      if (oldBeta[i] == NULL)
 	{
-	  nextPM = thePM->nextInMemory;
-
-	  thePM->nextInMemory = NULL;
-
-	  betaLocation = thePM->hashValue % theMemory->size;
-	  thePM->prevInMemory = lastAdd[betaLocation];
+	  continue;
+	}
 
-	  if (lastAdd[betaLocation] != NULL)
-	    {
-	      lastAdd[betaLocation]->nextInMemory = thePM;
-	    }
-	  else
+      slot = (oldHashes[i] - 1) % newSize;
+      while (theMemory->hashes[slot] != 0)
+	{
+	  if (++slot == newSize)
 	    {
-	      theMemory->beta[betaLocation] = thePM;
+	      slot = 0;
 	    }
+	}
 
-	  lastAdd[betaLocation] = thePM;
-
-	  thePM = nextPM;
+      theMemory->hashes[slot] = oldHashes[i];
+      theMemory->beta[slot] = oldBeta[i];
+      if (oldLast != NULL)
+	{
+	  theMemory->last[slot] = oldLast[i];
 	}
+      theMemory->used++;
     }
 
-  if (theMemory->last != NULL)
+  theMemory->live = theMemory->used;
+
+  CL_genfree (theEnv, oldBeta, sizeof (struct partialMatch *) * oldSize);
+  if (oldLast != NULL)
     {
-      CL_genfree (theEnv, theMemory->last,
-		  sizeof (struct partialMatch *) * oldSize);
-      theMemory->last = lastAdd;
+      CL_genfree (theEnv, oldLast, sizeof (struct partialMatch *) * oldSize);
     }
-  else
+  CL_genfree (theEnv, oldHashes, sizeof (unsigned long) * oldSize);
+}
+
+/********************************************************/
+/* QueueBetaMemoryShrink: Called when partial matches   */
+/*   are removed from a beta memory. A memory grown for */
+/*   a burst of partial matches and now sparse is       */
+/*   queued, to be shrunk by CL_ShrinkBetaMemories.     */
+/*   It cannot be rehashed right away, since its slots  */
+/*   may be traversed while matches are removed.        */
+/********************************************************/
+static void
+QueueBetaMemoryShrink (Environment * theEnv, struct betaMemory *theMemory)
+{
+  if (theMemory->shrinkPending
+      || (theMemory->size <= INITIAL_BETA_HASH_SIZE)
+      || ((theMemory->live * 100) >=
+	  (theMemory->size * DefruleData (theEnv)->BetaMemoryShrinkLoad)))
     {
-      CL_genfree (theEnv, lastAdd,
-		  sizeof (struct partialMatch *) * theMemory->size);
+      return;
     }
 
-  CL_genfree (theEnv, oldArray, sizeof (struct partialMatch *) * oldSize);
+  theMemory->shrinkPending = true;
+  theMemory->nextShrinking = DefruleData (theEnv)->ShrinkingMemories;
+  DefruleData (theEnv)->ShrinkingMemories = theMemory;
+}
+
+/*******************************************************/
+/* DequeueBetaMemoryShrink: Removes a beta memory from */
+/*   the queue of memories to shrink, before it is     */
+/*   deallocated.                                      */
+/*******************************************************/
+static void
+DequeueBetaMemoryShrink (Environment * theEnv, struct betaMemory *theMemory)
+{
+  struct betaMemory **link;
+
+  for (link = &DefruleData (theEnv)->ShrinkingMemories;
+       *link != NULL; link = &(*link)->nextShrinking)
+    {
+      if (*link == theMemory)
+	{
+	  *link = theMemory->nextShrinking;
+	  break;
+	}
+    }
+
+  theMemory->shrinkPending = false;
+  theMemory->nextShrinking = NULL;
+}
+
+/**********************************************************/
+/* CL_ShrinkBetaMemories: Rehashes the queued beta        */
+/*   memories which are still sparse into smaller tables, */
+/*   loaded at half the grow load. Called at safe points, */
+/*   when the garbage partial matches are flushed.        */
+/**********************************************************/
+void
+CL_ShrinkBetaMemories (Environment * theEnv)
+{
+  struct betaMemory *theMemory;
+  unsigned long newSize;
+
+  while ((theMemory = DefruleData (theEnv)->ShrinkingMemories) != NULL)
+    {
+      DefruleData (theEnv)->ShrinkingMemories = theMemory->nextShrinking;
+      theMemory->shrinkPending = false;
+      theMemory->nextShrinking = NULL;
+
+      if ((theMemory->size <= INITIAL_BETA_HASH_SIZE)
+	  || ((theMemory->live * 100) >=
+	      (theMemory->size * DefruleData (theEnv)->BetaMemoryShrinkLoad)))
+	{
+	  continue;
+	}
+
+      newSize = (theMemory->live * 200) /
+	DefruleData (theEnv)->BetaMemoryGrowLoad + 1;
+      if (newSize < INITIAL_BETA_HASH_SIZE)
+	{
+	  newSize = INITIAL_BETA_HASH_SIZE;
+	}
+
+      if (newSize < theMemory->size)
+	{
+	  RehashBetaMemory (theEnv, theMemory, newSize);
+	}
+    }
 }
 
 /********************/
@@ -1717,7 +2265,21 @@ CL_ResetBetaMemory (Environment * theEnv, struct betaMemory *theMemory)
   struct partialMatch **oldArray, **lastAdd;
   unsigned long oldSize;
 
-  if ((theMemory->size == 1) || (theMemory->size == INITIAL_BETA_HASH_SIZE))
+  if (theMemory->size == 1)
+    {
+      return;
+    }
+
+  if (theMemory->hashes != NULL)
+    {
+      CL_genfree (theEnv, theMemory->hashes,
+		  sizeof (unsigned long) * theMemory->size);
+      theMemory->hashes = NULL;
+    }
+  theMemory->used = 0;
+  theMemory->live = 0;
+
+  if (theMemory->size == INITIAL_BETA_HASH_SIZE)
     {
       return;
     }
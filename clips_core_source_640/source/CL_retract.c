@@ -108,7 +108,7 @@ CL_Network_Retract (Environment * theEnv,
 				    NETWORK_RETRACT);
 	}
 
-      if (tempMatch->theMatch->blockList != NULL)
+      if (PMBlockList (tempMatch->theMatch) != NULL)
 	{
 	  NegEntry_RetractAlpha (theEnv, tempMatch->theMatch,
 				 NETWORK_RETRACT);
@@ -128,6 +128,82 @@ CL_Network_Retract (Environment * theEnv,
     }
 }
 
+/******************************************************************/
+/* CL_Network_RetractJoins: First step of the retraction of a set */
+/*   of data entities, once every one of them is known to be      */
+/*   deleted by its isDeleted function. Removes the partial       */
+/*   matches derived from the alpha matches of an entity, and     */
+/*   their activations. Called for each entity of the set before  */
+/*   CL_Network_RetractAlphaMatches is called for any of them, so */
+/*   the partial matches blocked by the set which are removed     */
+/*   anyway are not unblocked first.                              */
+/******************************************************************/
+void
+CL_Network_RetractJoins (Environment * theEnv,
+			 struct patternMatch *listOfMatchedPatterns)
+{
+  struct patternMatch *tempMatch;
+
+  for (tempMatch = listOfMatchedPatterns;
+       tempMatch != NULL; tempMatch = tempMatch->next)
+    {
+      tempMatch->theMatch->deleting = true;
+
+      if (tempMatch->theMatch->children != NULL)
+	{
+	  CL_PosEntry_RetractAlpha (theEnv, tempMatch->theMatch,
+				    NETWORK_RETRACT);
+	}
+    }
+}
+
+/******************************************************************/
+/* CL_Network_RetractAlphaMatches: Last step of the retraction of */
+/*   a set of data entities. The partial matches of negated and   */
+/*   exists joins blocked by the alpha matches of an entity are   */
+/*   checked once: since the other matches of the set are being   */
+/*   deleted, they are not searched for another blocking match.   */
+/*   The alpha matches are then removed from the alpha memories,  */
+/*   and the list of the patterns the entity matched returned.    */
+/*   When the alpha memories are flushed afterwards, the matches  */
+/*   are only marked as busy, so that the flush puts them on the  */
+/*   list of garbage partial matches, as they may still be used   */
+/*   by the RHS of an executing rule.                             */
+/******************************************************************/
+void
+CL_Network_RetractAlphaMatches (Environment * theEnv,
+				struct patternMatch *listOfMatchedPatterns,
+				bool flushed)
+{
+  struct patternMatch *tempMatch, *nextMatch;
+
+  for (tempMatch = listOfMatchedPatterns;
+       tempMatch != NULL; tempMatch = nextMatch)
+    {
+      nextMatch = tempMatch->next;
+
+      if (PMBlockList (tempMatch->theMatch) != NULL)
+	{
+	  NegEntry_RetractAlpha (theEnv, tempMatch->theMatch,
+				 NETWORK_RETRACT);
+	}
+
+      if (flushed)
+	{
+	  tempMatch->theMatch->busy = true;
+	}
+      else
+	{
+	  RemoveAlphaMemory_Matches (theEnv, tempMatch->matchingPattern,
+				     tempMatch->theMatch,
+				     tempMatch->theMatch->binds[0].gm.
+				     theMatch);
+	}
+
+      rtn_struct (theEnv, patternMatch, tempMatch);
+    }
+}
+
 /*************************/
 /* CL_PosEntry_RetractAlpha: */
 /*************************/
@@ -191,7 +267,7 @@ NegEntry_RetractAlpha (Environment * theEnv,
   struct partialMatch *betaMatch;
   struct joinNode *joinPtr;
 
-  betaMatch = alphaMatch->blockList;
+  betaMatch = PMBlockList (alphaMatch);
   while (betaMatch != NULL)
     {
       joinPtr = (struct joinNode *) betaMatch->owner;
@@ -200,13 +276,13 @@ NegEntry_RetractAlpha (Environment * theEnv,
 	  (!joinPtr->patternIsExists) && (!joinPtr->joinFromTheRight))
 	{
 	  CL_SystemError (theEnv, "RETRACT", 117);
-	  betaMatch = betaMatch->nextBlocked;
+	  betaMatch = PMNextBlocked (betaMatch);
 	  continue;
 	}
 
       NegEntry_RetractBeta (theEnv, joinPtr, alphaMatch, betaMatch,
 			    operation);
-      betaMatch = alphaMatch->blockList;
+      betaMatch = PMBlockList (alphaMatch);
     }
 }
 
@@ -224,7 +300,7 @@ NegEntry_RetractBeta (Environment * theEnv,
   /* the LHS partial match from being satisifed.          */
    /*======================================================*/
 
-  CL_RemoveBlockedLink (betaMatch);
+  CL_RemoveBlockedLink (theEnv, betaMatch);
 
   if (FindNextConflictingMatch
       (theEnv, betaMatch, alphaMatch->nextInMemory, joinPtr, alphaMatch,
@@ -316,7 +392,7 @@ CL_PosEntry_RetractBeta (Environment * theEnv,
 	  betaMatch->leftParent->children = NULL;
 	}
 
-      if (betaMatch->blockList != NULL)
+      if (PMBlockList (betaMatch) != NULL)
 	{
 	  NegEntry_RetractAlpha (theEnv, betaMatch, operation);
 	}
@@ -342,7 +418,7 @@ CL_PosEntry_RetractBeta (Environment * theEnv,
 				   betaMatch, LHS);
 	}
 
-      if (betaMatch->dependents != NULL)
+      if (PMDependents (betaMatch) != NULL)
 	CL_RemoveLogicalSupport (theEnv, betaMatch);
       CL_ReturnPartialMatch (theEnv, betaMatch);
 
@@ -380,6 +456,18 @@ FindNextConflictingMatch (Environment * theEnv,
       EngineData (theEnv)->leftToRightLoops++;
     }
 #endif
+   /*=================================================*/
+  /* No match can conflict when every match of the   */
+  /* alpha memory is removed by a bulk retraction.   */
+   /*=================================================*/
+
+  if ((operation == NETWORK_RETRACT) && (!theJoin->joinFromTheRight) &&
+      ((struct patternNodeHeader *) theJoin->rightSideEntryStructure)->
+      flushing)
+    {
+      possibleConflicts = NULL;
+    }
+
    /*====================================*/
   /* Set up the evaluation environment. */
    /*====================================*/
@@ -482,7 +570,7 @@ FindNextConflictingMatch (Environment * theEnv,
 
       if (result != false)
 	{
-	  CL_AddBlockedLink (theBind, possibleConflicts);
+	  CL_AddBlockedLink (theEnv, theBind, possibleConflicts);
 	  EngineData (theEnv)->GlobalLHSBinds = oldLHSBinds;
 	  EngineData (theEnv)->GlobalRHSBinds = oldRHSBinds;
 	  EngineData (theEnv)->GlobalJoin = oldJoin;
@@ -589,7 +677,7 @@ CL_DeletePartial_Matches (Environment * theEnv,
       /* result of a logical CE.                        */
       /*================================================*/
 
-      if (listOfPMs->dependents != NULL)
+      if (PMDependents (listOfPMs) != NULL)
 	CL_RemoveLogicalSupport (theEnv, listOfPMs);
 
       /*==========================================================*/
@@ -657,13 +745,15 @@ CL_ReturnPartialMatch (Environment * theEnv, struct partialMatch *waste)
   /* the logical CE.                                 */
    /*=================================================*/
 
-  if (waste->dependents != NULL)
+  if (PMDependents (waste) != NULL)
     RemovePM_Dependencies (theEnv, waste);
 
    /*======================================================*/
   /* Return the partial match to the pool of free memory. */
    /*======================================================*/
 
+  if (waste->extra != NULL)
+    rtn_struct (theEnv, partialMatchExtra, waste->extra);
   rtn_var_struct (theEnv, partialMatch, sizeof (struct genericMatch *) *
 		  (waste->bcount - 1), waste);
 }
@@ -697,13 +787,15 @@ CL_DestroyPartialMatch (Environment * theEnv, struct partialMatch *waste)
   /* the logical CE.                                 */
    /*=================================================*/
 
-  if (waste->dependents != NULL)
+  if (PMDependents (waste) != NULL)
     DestroyPM_Dependencies (theEnv, waste);
 
    /*======================================================*/
   /* Return the partial match to the pool of free memory. */
    /*======================================================*/
 
+  if (waste->extra != NULL)
+    rtn_struct (theEnv, partialMatchExtra, waste->extra);
   rtn_var_struct (theEnv, partialMatch, sizeof (struct genericMatch *) *
 		  (waste->bcount - 1), waste);
 }
@@ -776,6 +868,13 @@ CL_FlushGarbagePartial_Matches (Environment * theEnv)
 			     EngineData (theEnv)->GarbagePartial_Matches);
       EngineData (theEnv)->GarbagePartial_Matches = pmPtr;
     }
+
+   /*==============================================*/
+  /* Now that no join traverses its beta memories, */
+  /* shrink those left sparse by the retractions.  */
+   /*==============================================*/
+
+  CL_ShrinkBetaMemories (theEnv);
 }
 
 #endif /* DEFRULE_CONSTRUCT */
@@ -50,6 +50,7 @@
 #include "agenda.h"
 #include "bload.h"
 #include "bsave.h"
+#include "drive.h"
 #include "engine.h"
 #include "envrnmnt.h"
 #include "memalloc.h"
@@ -132,6 +133,8 @@ DeallocateDefrule_BloadData (Environment * theEnv)
       CL_ReturnLeftMemory (theEnv, &DefruleBinaryData (theEnv)->JoinArray[i]);
       CL_ReturnRightMemory (theEnv,
 			    &DefruleBinaryData (theEnv)->JoinArray[i]);
+      CL_ReleaseJoinTests (theEnv,
+			   &DefruleBinaryData (theEnv)->JoinArray[i]);
     }
 
   for (i = 0; i < DefruleBinaryData (theEnv)->NumberOf_DefruleModules; i++)
@@ -143,6 +146,7 @@ DeallocateDefrule_BloadData (Environment * theEnv)
 	{
 	  tmpActivation = theActivation->next;
 
+	  CL_ReturnActivationIndex (theEnv, theActivation);
 	  rtn_struct (theEnv, activation, theActivation);
 
 	  theActivation = tmpActivation;
@@ -157,6 +161,8 @@ DeallocateDefrule_BloadData (Environment * theEnv)
 
 	  theGroup = tmpGroup;
 	}
+
+      CL_ReturnSalienceIndex (theEnv, theModuleItem);
     }
 
   space =
@@ -985,6 +991,8 @@ Update_DefruleModule (Environment * theEnv, void *buf, unsigned long obji)
 				DefruleBinaryData (theEnv)->DefruleArray);
   DefruleBinaryData (theEnv)->ModuleArray[obji].agenda = NULL;
   DefruleBinaryData (theEnv)->ModuleArray[obji].groupings = NULL;
+  DefruleBinaryData (theEnv)->ModuleArray[obji].salienceIndex = NULL;
+  DefruleBinaryData (theEnv)->ModuleArray[obji].reorderNeeded = false;
 
 }
 
@@ -1018,6 +1026,11 @@ UpdateDefrule (Environment * theEnv, void *buf, unsigned long obji)
   DefruleBinaryData (theEnv)->DefruleArray[obji].disjunct =
     CL_BloadDefrulePointer (DefruleBinaryData (theEnv)->DefruleArray,
 			    br->disjunct);
+  DefruleBinaryData (theEnv)->DefruleArray[obji].joinCEs = NULL;
+  DefruleBinaryData (theEnv)->DefruleArray[obji].joinCECount = 0;
+  DefruleBinaryData (theEnv)->DefruleArray[obji].salienceDependency =
+    SALIENCE_UNANALYZED;
+  DefruleBinaryData (theEnv)->DefruleArray[obji].salienceStamp = 0;
   DefruleBinaryData (theEnv)->DefruleArray[obji].salience = br->salience;
   DefruleBinaryData (theEnv)->DefruleArray[obji].localVarCnt =
     br->localVarCnt;
@@ -1087,6 +1100,9 @@ UpdateJoin (Environment * theEnv, void *buf, unsigned long obji)
   DefruleBinaryData (theEnv)->JoinArray[obji].bsaveID = 0L;
   DefruleBinaryData (theEnv)->JoinArray[obji].leftMemory = NULL;
   DefruleBinaryData (theEnv)->JoinArray[obji].rightMemory = NULL;
+  DefruleBinaryData (theEnv)->JoinArray[obji].compiledTests = NULL;
+  DefruleBinaryData (theEnv)->JoinArray[obji].rightUnlinked = 0;
+  DefruleBinaryData (theEnv)->JoinArray[obji].nextActiveJoin = NULL;
 
   CL_AddBetaMemoriesToJoin (theEnv,
 			    &DefruleBinaryData (theEnv)->JoinArray[obji]);
@@ -1131,6 +1147,9 @@ CL_UpdatePatternNodeHeader (Environment * theEnv,
   theHeader->marked = 0;
   theHeader->firstHash = NULL;
   theHeader->lastHash = NULL;
+  theHeader->activeJoinsValid = false;
+  theHeader->flushing = false;
+  theHeader->activeJoin = NULL;
   theHeader->rightHash = HashedExpressionPointer (the_BsaveHeader->rightHash);
 
   theJoin = CL_BloadJoinPointer (the_BsaveHeader->entryJoin);
@@ -1198,6 +1217,8 @@ CL_Clear_Bload (Environment * theEnv)
 			  RHS);
       CL_ReturnRightMemory (theEnv,
 			    &DefruleBinaryData (theEnv)->JoinArray[i]);
+      CL_ReleaseJoinTests (theEnv,
+			   &DefruleBinaryData (theEnv)->JoinArray[i]);
     }
 
    /*================================================*/
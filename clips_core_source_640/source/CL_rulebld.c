@@ -1207,6 +1207,11 @@ CreateNewJoin (Environment * theEnv,
 	  newJoin->leftMemory->last = NULL;
 	  newJoin->leftMemory->size = 1;
 	  newJoin->leftMemory->count = 0;
+	  newJoin->leftMemory->used = 0;
+	  newJoin->leftMemory->hashes = NULL;
+	  newJoin->leftMemory->live = 0;
+	  newJoin->leftMemory->shrinkPending = false;
+	  newJoin->leftMemory->nextShrinking = NULL;
 	}
       else
 	{
@@ -1221,6 +1226,11 @@ CreateNewJoin (Environment * theEnv,
 	  newJoin->leftMemory->last = NULL;
 	  newJoin->leftMemory->size = INITIAL_BETA_HASH_SIZE;
 	  newJoin->leftMemory->count = 0;
+	  newJoin->leftMemory->used = 0;
+	  newJoin->leftMemory->hashes = NULL;
+	  newJoin->leftMemory->live = 0;
+	  newJoin->leftMemory->shrinkPending = false;
+	  newJoin->leftMemory->nextShrinking = NULL;
 	}
 
       /*===========================================================*/
@@ -1260,6 +1270,11 @@ CreateNewJoin (Environment * theEnv,
 	  newJoin->rightMemory->last[0] = NULL;
 	  newJoin->rightMemory->size = 1;
 	  newJoin->rightMemory->count = 0;
+	  newJoin->rightMemory->used = 0;
+	  newJoin->rightMemory->hashes = NULL;
+	  newJoin->rightMemory->live = 0;
+	  newJoin->rightMemory->shrinkPending = false;
+	  newJoin->rightMemory->nextShrinking = NULL;
 	}
       else
 	{
@@ -1280,6 +1295,11 @@ CreateNewJoin (Environment * theEnv,
 		  sizeof (struct partialMatch *) * INITIAL_BETA_HASH_SIZE);
 	  newJoin->rightMemory->size = INITIAL_BETA_HASH_SIZE;
 	  newJoin->rightMemory->count = 0;
+	  newJoin->rightMemory->used = 0;
+	  newJoin->rightMemory->hashes = NULL;
+	  newJoin->rightMemory->live = 0;
+	  newJoin->rightMemory->shrinkPending = false;
+	  newJoin->rightMemory->nextShrinking = NULL;
 	}
     }
   else if (rhsEntryStruct == NULL)
@@ -1297,6 +1317,11 @@ CreateNewJoin (Environment * theEnv,
       newJoin->rightMemory->last[0] = newJoin->rightMemory->beta[0];
       newJoin->rightMemory->size = 1;
       newJoin->rightMemory->count = 1;
+      newJoin->rightMemory->used = 0;
+      newJoin->rightMemory->hashes = NULL;
+      newJoin->rightMemory->live = 0;
+      newJoin->rightMemory->shrinkPending = false;
+      newJoin->rightMemory->nextShrinking = NULL;
     }
   else
     {
@@ -1320,6 +1345,9 @@ CreateNewJoin (Environment * theEnv,
   newJoin->initialize = true;
   newJoin->logicalJoin = false;
   newJoin->ruleToActivate = NULL;
+  newJoin->compiledTests = NULL;
+  newJoin->rightUnlinked = false;
+  newJoin->nextActiveJoin = NULL;
   newJoin->memoryLeftAdds = 0;
   newJoin->memoryRightAdds = 0;
   newJoin->memoryLeftDeletes = 0;
@@ -1448,6 +1476,8 @@ CreateNewJoin (Environment * theEnv,
       newJoin->rightMatchNode =
 	((struct patternNodeHeader *) rhsEntryStruct)->entryJoin;
       ((struct patternNodeHeader *) rhsEntryStruct)->entryJoin = newJoin;
+      ((struct patternNodeHeader *) rhsEntryStruct)->activeJoinsValid =
+	false;
     }
 
    /*================================*/
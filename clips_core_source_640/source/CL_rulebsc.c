@@ -184,7 +184,7 @@ CL_ResetDefrules (Environment * theEnv, void *context)
 
 	  if (notParent->marker)
 	    {
-	      CL_RemoveBlockedLink (notParent);
+	      CL_RemoveBlockedLink (theEnv, notParent);
 	    }
 
 	 /*==========================================================*/
@@ -199,7 +199,7 @@ CL_ResetDefrules (Environment * theEnv, void *context)
 				       NETWORK_ASSERT);
 	    }
 	  /*
-	     if (notParent->dependents != NULL)
+	     if (PMDependents (notParent) != NULL)
 	     { CL_RemoveLogicalSupport(theEnv,notParent); } */
 	}
     }
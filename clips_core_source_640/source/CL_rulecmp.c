@@ -574,13 +574,14 @@ JoinToCode (Environment * theEnv,
   /* Flags and Integer Values. */
    /*===========================*/
 
-  fprintf (joinFile, "{%d,%d,%d,%d,%d,0,0,%d,%d,0,0,0,0,0,0,",
+  fprintf (joinFile, "{%d,%d,%d,%d,%d,0,0,%d,%d,0,0,0,0,0,0,0,",
 	   theJoin->firstJoin, theJoin->logicalJoin,
 	   theJoin->joinFromTheRight, theJoin->patternIsNegated,
 	   theJoin->patternIsExists,
 	   // initialize,
 	   // marked
 	   theJoin->rhsType, theJoin->depth);
+  // rightUnlinked
   // bsaveID
   // memoryLeftAdds
   // memoryRightAdds
@@ -699,11 +700,11 @@ JoinToCode (Environment * theEnv,
 
   if (theJoin->ruleToActivate == NULL)
     {
-      fprintf (joinFile, "NULL}");
+      fprintf (joinFile, "NULL,NULL}");
     }
   else
     {
-      fprintf (joinFile, "&%s%d_%ld[%ld]}",
+      fprintf (joinFile, "&%s%d_%ld[%ld],NULL}",
 	       ConstructPrefix (DefruleData (theEnv)->DefruleCodeItem),
 	       imageID,
 	       (theJoin->ruleToActivate->header.bsaveID / maxIndices) + 1,
@@ -90,11 +90,13 @@
 #include "lgcldpnd.h"
 #include "memalloc.h"
 #include "multifld.h"
+#include "parsefun.h"
 #include "pattern.h"
 #include "prntutil.h"
 #include "reteutil.h"
 #include "router.h"
 #include "ruledlt.h"
+#include "strngfun.h"
 #include "sysdep.h"
 #include "utility.h"
 #include "watch.h"
@@ -109,6 +111,11 @@
 /* LOCAL INTERNAL FUNCTION DEFINITIONS */
 /***************************************/
 
+#if (! RUN_TIME) && (! BLOAD_ONLY)
+static bool CollectJoinOrderStatistics (Environment *, Defrule *,
+					struct joinOrderRequest *);
+static unsigned long AlphaMemoryCount (struct patternNodeHeader *);
+#endif
 #if DEVELOPER
 static void ShowJoins (Environment *, Defrule *);
 #endif
@@ -189,6 +196,23 @@ CL_DefruleCommands (Environment * theEnv)
   CL_AddUDF (theEnv, "set-beta-memory-resizing", "b", 1, 1, NULL,
 	     CL_SetBetaMemoryResizingCommand,
 	     "CL_SetBetaMemoryResizingCommand", NULL);
+  CL_AddUDF (theEnv, "get-beta-memory-thresholds", "m", 0, 0, NULL,
+	     CL_GetBetaMemoryThresholdsCommand,
+	     "CL_GetBetaMemoryThresholdsCommand", NULL);
+  CL_AddUDF (theEnv, "set-beta-memory-thresholds", "b", 2, 2, "l",
+	     CL_SetBetaMemoryThresholdsCommand,
+	     "CL_SetBetaMemoryThresholdsCommand", NULL);
+  CL_AddUDF (theEnv, "get-join-test-compilation", "b", 0, 0, NULL,
+	     CL_GetJoinTestCompilationCommand,
+	     "CL_GetJoinTestCompilationCommand", NULL);
+  CL_AddUDF (theEnv, "set-join-test-compilation", "b", 1, 1, NULL,
+	     CL_SetJoinTestCompilationCommand,
+	     "CL_SetJoinTestCompilationCommand", NULL);
+#if ! BLOAD_ONLY
+  CL_AddUDF (theEnv, "optimize-rule-joins", "l", 0, 1, "y",
+	     CL_OptimizeRuleJoinsCommand, "CL_OptimizeRuleJoinsCommand",
+	     NULL);
+#endif
 
   CL_AddUDF (theEnv, "get-strategy", "y", 0, 0, NULL, CL_GetStrategyCommand,
 	     "CL_GetStrategyCommand", NULL);
@@ -287,6 +311,483 @@ CL_GetBetaMemoryResizingCommand (Environment * theEnv,
     CL_CreateBoolean (theEnv, CL_GetBetaMemoryResizing (theEnv));
 }
 
+/*************************************************/
+/* CL_GetBetaMemoryThresholds: C access routine     */
+/*   for the get-beta-memory-thresholds command. */
+/*************************************************/
+void
+CL_GetBetaMemoryThresholds (Environment * theEnv,
+			    unsigned short *growLoad,
+			    unsigned short *shrinkLoad)
+{
+  *growLoad = DefruleData (theEnv)->BetaMemoryGrowLoad;
+  *shrinkLoad = DefruleData (theEnv)->BetaMemoryShrinkLoad;
+}
+
+/*****************************************************/
+/* CL_SetBetaMemoryThresholds: C access routine         */
+/*   for the set-beta-memory-thresholds command. The */
+/*   grow load, in per cent of the slots of a hashed */
+/*   beta memory holding partial matches, must be    */
+/*   between 10 and 70, and the shrink load at most  */
+/*   half of it, so a shrunk memory does not shrink  */
+/*   again. A shrink load of 0 disables shrinking.   */
+/*****************************************************/
+bool
+CL_SetBetaMemoryThresholds (Environment * theEnv,
+			    unsigned short growLoad,
+			    unsigned short shrinkLoad)
+{
+  if ((growLoad < 10) || (growLoad > 70) || (shrinkLoad > (growLoad / 2)))
+    {
+      return false;
+    }
+
+  DefruleData (theEnv)->BetaMemoryGrowLoad = growLoad;
+  DefruleData (theEnv)->BetaMemoryShrinkLoad = shrinkLoad;
+
+  return true;
+}
+
+/******************************************************/
+/* CL_GetBetaMemoryThresholdsCommand: H/L access routine */
+/*   for the get-beta-memory-thresholds command.      */
+/******************************************************/
+void
+CL_GetBetaMemoryThresholdsCommand (Environment * theEnv,
+				   UDFContext * context,
+				   UDFValue * returnValue)
+{
+  unsigned short growLoad, shrinkLoad;
+
+  CL_GetBetaMemoryThresholds (theEnv, &growLoad, &shrinkLoad);
+
+  returnValue->begin = 0;
+  returnValue->range = 2;
+  returnValue->value = CL_CreateMultifield (theEnv, 2L);
+  returnValue->multifieldValue->contents[0].integerValue =
+    CL_CreateInteger (theEnv, growLoad);
+  returnValue->multifieldValue->contents[1].integerValue =
+    CL_CreateInteger (theEnv, shrinkLoad);
+}
+
+/******************************************************/
+/* CL_SetBetaMemoryThresholdsCommand: H/L access routine */
+/*   for the set-beta-memory-thresholds command.      */
+/******************************************************/
+void
+CL_SetBetaMemoryThresholdsCommand (Environment * theEnv,
+				   UDFContext * context,
+				   UDFValue * returnValue)
+{
+  UDFValue growArg, shrinkArg;
+  long long growLoad, shrinkLoad;
+
+  returnValue->lexemeValue = FalseSymbol (theEnv);
+
+  if (!CL_UDFFirstArgument (context, INTEGER_BIT, &growArg))
+    {
+      return;
+    }
+
+  growLoad = growArg.integerValue->contents;
+  if ((growLoad < 10) || (growLoad > 70))
+    {
+      CL_UDFInvalidArgumentMessage (context, "integer from 10 to 70");
+      return;
+    }
+
+  if (!CL_UDFNextArgument (context, INTEGER_BIT, &shrinkArg))
+    {
+      return;
+    }
+
+  shrinkLoad = shrinkArg.integerValue->contents;
+  if ((shrinkLoad < 0) || (shrinkLoad > (growLoad / 2)))
+    {
+      CL_UDFInvalidArgumentMessage (context,
+				    "integer from 0 to half the grow load");
+      return;
+    }
+
+  CL_SetBetaMemoryThresholds (theEnv, (unsigned short) growLoad,
+			      (unsigned short) shrinkLoad);
+  returnValue->lexemeValue = TrueSymbol (theEnv);
+}
+
+/****************************************************/
+/* CL_GetJoinTestCompilation: C access routine         */
+/*   for the get-join-test-compilation command.     */
+/****************************************************/
+bool
+CL_GetJoinTestCompilation (Environment * theEnv)
+{
+  return DefruleData (theEnv)->CompileJoinTestsFlag;
+}
+
+/****************************************************/
+/* CL_SetJoinTestCompilation: C access routine         */
+/*   for the set-join-test-compilation command. The */
+/*   tests of a join are compiled the first time    */
+/*   they are evaluated with compilation enabled,   */
+/*   and kept until the join is deleted.            */
+/****************************************************/
+bool
+CL_SetJoinTestCompilation (Environment * theEnv, bool value)
+{
+  bool ov;
+
+  ov = DefruleData (theEnv)->CompileJoinTestsFlag;
+
+  DefruleData (theEnv)->CompileJoinTestsFlag = value;
+
+  return (ov);
+}
+
+/*****************************************************/
+/* CL_SetJoinTestCompilationCommand: H/L access routine */
+/*   for the set-join-test-compilation command.      */
+/*****************************************************/
+void
+CL_SetJoinTestCompilationCommand (Environment * theEnv,
+				  UDFContext * context,
+				  UDFValue * returnValue)
+{
+  UDFValue theArg;
+
+  returnValue->lexemeValue =
+    CL_CreateBoolean (theEnv, CL_GetJoinTestCompilation (theEnv));
+
+   /*==================================================*/
+  /* The symbol FALSE disables join test compilation. */
+  /* Any other value enables join test compilation.   */
+   /*==================================================*/
+
+  if (!CL_UDFFirstArgument (context, ANY_TYPE_BITS, &theArg))
+    {
+      return;
+    }
+
+  if (theArg.value == FalseSymbol (theEnv))
+    {
+      CL_SetJoinTestCompilation (theEnv, false);
+    }
+  else
+    {
+      CL_SetJoinTestCompilation (theEnv, true);
+    }
+}
+
+/*****************************************************/
+/* CL_GetJoinTestCompilationCommand: H/L access routine */
+/*   for the get-join-test-compilation command.      */
+/*****************************************************/
+void
+CL_GetJoinTestCompilationCommand (Environment * theEnv,
+				  UDFContext * context,
+				  UDFValue * returnValue)
+{
+  returnValue->lexemeValue =
+    CL_CreateBoolean (theEnv, CL_GetJoinTestCompilation (theEnv));
+}
+
+#if (! RUN_TIME) && (! BLOAD_ONLY)
+
+/***********************************************************/
+/* CL_OptimizeRuleJoinsCommand: H/L access routine for the */
+/*   optimize-rule-joins command. Reorders the joins of    */
+/*   the specified rule, or of every rule in the current   */
+/*   module, and returns the number of rules rebuilt.      */
+/***********************************************************/
+void
+CL_OptimizeRuleJoinsCommand (Environment * theEnv,
+			     UDFContext * context, UDFValue * returnValue)
+{
+  UDFValue theArg;
+  const char *ruleName;
+  Defrule *theRule;
+  CLIPSLexeme **ruleNames;
+  unsigned long ruleCount = 0, i;
+  long long rebuilt = 0;
+
+  if (UDFHasNextArgument (context))
+    {
+      if (!CL_UDFFirstArgument (context, SYMBOL_BIT, &theArg))
+	{
+	  return;
+	}
+
+      ruleName = theArg.lexemeValue->contents;
+      theRule = CL_FindDefrule (theEnv, ruleName);
+      if (theRule == NULL)
+	{
+	  CL_CantFindItemErrorMessage (theEnv, "defrule", ruleName, true);
+	}
+      else if (CL_OptimizeRuleJoins (theEnv, theRule))
+	{
+	  rebuilt++;
+	}
+
+      returnValue->integerValue = CL_CreateInteger (theEnv, rebuilt);
+      return;
+    }
+
+   /*=======================================================*/
+  /* Rebuilding a rule moves it to the end of the list of  */
+  /* rules, so the names of the rules are collected first. */
+   /*=======================================================*/
+
+  for (theRule = CL_GetNextDefrule (theEnv, NULL);
+       theRule != NULL; theRule = CL_GetNextDefrule (theEnv, theRule))
+    {
+      ruleCount++;
+    }
+
+  if (ruleCount != 0)
+    {
+      ruleNames = (CLIPSLexeme **)
+	CL_genalloc (theEnv, sizeof (CLIPSLexeme *) * ruleCount);
+
+      for (theRule = CL_GetNextDefrule (theEnv, NULL), i = 0;
+	   theRule != NULL; theRule = CL_GetNextDefrule (theEnv, theRule), i++)
+	{
+	  ruleNames[i] = theRule->header.name;
+	  IncrementLexemeCount (ruleNames[i]);
+	}
+
+      for (i = 0; i < ruleCount; i++)
+	{
+	  theRule = CL_FindDefrule (theEnv, ruleNames[i]->contents);
+	  if ((theRule != NULL) && CL_OptimizeRuleJoins (theEnv, theRule))
+	    {
+	      rebuilt++;
+	    }
+	  CL_ReleaseLexeme (theEnv, ruleNames[i]);
+	}
+
+      CL_genfree (theEnv, ruleNames, sizeof (CLIPSLexeme *) * ruleCount);
+    }
+
+  returnValue->integerValue = CL_CreateInteger (theEnv, rebuilt);
+}
+
+/**************************************************************/
+/* CL_OptimizeRuleJoins: C access routine for the             */
+/*   optimize-rule-joins command. The statistics of the joins */
+/*   of a rule, the size of their alpha memories and the      */
+/*   number of partial matches they produced per partial      */
+/*   match they received, are used to reorder its pattern     */
+/*   CEs, except the first one of each disjunct, whose match  */
+/*   orders the activations under the mea strategy. The       */
+/*   patterns listed by the matches command follow the new    */
+/*   order. The rule is then rebuilt from its pretty print    */
+/*   form, which is unchanged, and primed by the incremental  */
+/*   reset. As with any redefinition, its activations are     */
+/*   recreated, so this is meant to be used after facts are   */
+/*   loaded and before the rules are run. Returns true if the */
+/*   rule was rebuilt, in which case the pointer to the rule  */
+/*   is no longer valid.                                      */
+/**************************************************************/
+bool
+CL_OptimizeRuleJoins (Environment * theEnv, Defrule * theRule)
+{
+  struct joinOrderRequest *theRequest;
+  char *theText;
+  size_t length;
+  UDFValue result;
+  bool rebuilt = false;
+
+  if ((theRule->header.ppFo_rm == NULL) ||
+      (!CL_DefruleIsDeletable (theRule)) ||
+      (DefruleData (theEnv)->JoinOrderRequest != NULL))
+    {
+      return false;
+    }
+
+  theRequest = get_struct (theEnv, joinOrderRequest);
+  theRequest->disjunctCount =
+    (unsigned short) CL_GetDisjunctCount (theEnv, theRule);
+  theRequest->statistics = (struct joinOrderCE *)
+    CL_genalloc (theEnv,
+		 sizeof (struct joinOrderCE) * JOIN_ORDER_MAX_CE *
+		 theRequest->disjunctCount);
+  theRequest->changed = false;
+
+  if (!CollectJoinOrderStatistics (theEnv, theRule, theRequest))
+    {
+      CL_genfree (theEnv, theRequest->statistics,
+		  sizeof (struct joinOrderCE) * JOIN_ORDER_MAX_CE *
+		  theRequest->disjunctCount);
+      rtn_struct (theEnv, joinOrderRequest, theRequest);
+      return false;
+    }
+
+   /*=========================================================*/
+  /* The pretty print form is freed when the rule is deleted */
+  /* by its redefinition, so it is parsed from a copy.       */
+   /*=========================================================*/
+
+  length = strlen (theRule->header.ppFo_rm) + 1;
+  theText = (char *) CL_genalloc (theEnv, length);
+  memcpy (theText, theRule->header.ppFo_rm, length);
+
+   /*===================================================*/
+  /* First check whether the rule would be reordered.  */
+  /* If it would, rebuild it, and if that fails (which */
+  /* should not happen), rebuild it in its own order.  */
+   /*===================================================*/
+
+  DefruleData (theEnv)->JoinOrderRequest = theRequest;
+
+  if ((!CL_CheckSyntax (theEnv, theText, &result)) && theRequest->changed)
+    {
+      theRequest->changed = false;
+      if (CL_Build (theEnv, theText) == BE_NO_ERROR)
+	{
+	  rebuilt = true;
+	}
+      else
+	{
+	  DefruleData (theEnv)->JoinOrderRequest = NULL;
+	  CL_Build (theEnv, theText);
+	}
+    }
+
+  DefruleData (theEnv)->JoinOrderRequest = NULL;
+
+  CL_genfree (theEnv, theText, length);
+  CL_genfree (theEnv, theRequest->statistics,
+	      sizeof (struct joinOrderCE) * JOIN_ORDER_MAX_CE *
+	      theRequest->disjunctCount);
+  rtn_struct (theEnv, joinOrderRequest, theRequest);
+
+  return rebuilt;
+}
+
+/************************************************************/
+/* CollectJoinOrderStatistics: Collects the statistics of   */
+/*   the joins of each disjunct of a rule, indexed by the   */
+/*   user CE they match. Returns false if there are none.   */
+/************************************************************/
+static bool
+CollectJoinOrderStatistics (Environment * theEnv,
+			    Defrule * theRule,
+			    struct joinOrderRequest *theRequest)
+{
+  Defrule *theDisjunct;
+  struct joinNode *theJoin, *nextJoin;
+  struct joinOrderCE *statistics, *theCE;
+  unsigned short disjunctIndex, position, i;
+  bool found = false;
+
+  for (theDisjunct = theRule, disjunctIndex = 0;
+       (theDisjunct != NULL) &&
+       (disjunctIndex < theRequest->disjunctCount);
+       theDisjunct = theDisjunct->disjunct, disjunctIndex++)
+    {
+      statistics =
+	&theRequest->statistics[disjunctIndex * JOIN_ORDER_MAX_CE];
+
+      for (i = 0; i < JOIN_ORDER_MAX_CE; i++)
+	{
+	  statistics[i].known = false;
+	}
+
+      /*============================================*/
+      /* The joins are traversed from the last one, */
+      /* and the output of a join is counted by the */
+      /* additions to the left memory of the next.  */
+      /*============================================*/
+
+      position = theDisjunct->joinCECount;
+      nextJoin = theDisjunct->lastJoin;
+      for (theJoin = nextJoin->lastLevel;
+	   (theJoin != NULL) && (position > 0);
+	   nextJoin = theJoin, theJoin = theJoin->lastLevel)
+	{
+	  position--;
+	  if (theDisjunct->joinCEs[position] == 0)
+	    {
+	      continue;
+	    }
+
+	  theCE = &statistics[theDisjunct->joinCEs[position]];
+	  theCE->known = true;
+	  theCE->position = position;
+	  theCE->cardinality = (double)
+	    AlphaMemoryCount ((struct patternNodeHeader *)
+			      theJoin->rightSideEntryStructure);
+
+	  if ((!theJoin->firstJoin) && (theJoin->memoryLeftAdds > 0))
+	    {
+	      theCE->fanout = (double) nextJoin->memoryLeftAdds /
+		(double) theJoin->memoryLeftAdds;
+	    }
+	  else
+	    {
+	      theCE->fanout = -1.0;
+	    }
+
+	  found = true;
+	}
+    }
+
+  return found;
+}
+
+/*********************************************************/
+/* AlphaMemoryCount: Returns the number of alpha matches */
+/*   stored in the alpha memories of a pattern node.     */
+/*********************************************************/
+static unsigned long
+AlphaMemoryCount (struct patternNodeHeader *theHeader)
+{
+  struct alphaMemoryHash *theHash;
+  struct partialMatch *theMatch;
+  unsigned long count = 0;
+
+  for (theHash = theHeader->firstHash;
+       theHash != NULL; theHash = theHash->nextHash)
+    {
+      for (theMatch = theHash->alphaMemory;
+	   theMatch != NULL; theMatch = theMatch->nextInMemory)
+	{
+	  count++;
+	}
+    }
+
+  return count;
+}
+
+#else
+
+/*************************************************************/
+/* CL_OptimizeRuleJoinsCommand: This is the non-functional   */
+/*   stub provided for use with a run-time version. Rules of */
+/*   a run-time or bload only environment can't be rebuilt.  */
+/*************************************************************/
+void
+CL_OptimizeRuleJoinsCommand (Environment * theEnv,
+			     UDFContext * context, UDFValue * returnValue)
+{
+  CL_PrintErrorID (theEnv, "RULECOM", 1, false);
+  CL_WriteString (theEnv, STDERR,
+		  "Function 'optimize-rule-joins' does not work in run time modules.\n");
+  returnValue->integerValue = CL_CreateInteger (theEnv, 0);
+}
+
+/****************************************************/
+/* CL_OptimizeRuleJoins: This is the non-functional */
+/*   stub provided for use with a run-time version. */
+/****************************************************/
+bool
+CL_OptimizeRuleJoins (Environment * theEnv, Defrule * theRule)
+{
+  return false;
+}
+
+#endif /* (! RUN_TIME) && (! BLOAD_ONLY) */
+
 /******************************************/
 /* Get_FocusFunction: H/L access routine   */
 /*   for the get-focus function.          */
@@ -157,9 +157,14 @@ CL_InitializeDefrules (Environment * theEnv)
     DefruleData (theEnv)->AlphaMemoryTable[i] = NULL;
 
   DefruleData (theEnv)->BetaMemoryResizingFlag = true;
+  DefruleData (theEnv)->BetaMemoryGrowLoad = BETA_MEMORY_GROW_LOAD;
+  DefruleData (theEnv)->BetaMemoryShrinkLoad = BETA_MEMORY_SHRINK_LOAD;
+  DefruleData (theEnv)->ShrinkingMemories = NULL;
+  DefruleData (theEnv)->CompileJoinTestsFlag = false;
 
   DefruleData (theEnv)->RightPrimeJoins = NULL;
   DefruleData (theEnv)->LeftPrimeJoins = NULL;
+  DefruleData (theEnv)->JoinOrderRequest = NULL;
 }
 
 /**************************************************/
@@ -197,6 +202,7 @@ DeallocateDefruleData (Environment * theEnv)
 	{
 	  tmpActivation = theActivation->next;
 
+	  CL_ReturnActivationIndex (theEnv, theActivation);
 	  rtn_struct (theEnv, activation, theActivation);
 
 	  theActivation = tmpActivation;
@@ -212,6 +218,8 @@ DeallocateDefruleData (Environment * theEnv)
 	  theGroup = tmpGroup;
 	}
 
+      CL_ReturnSalienceIndex (theEnv, theModuleItem);
+
 #if ! RUN_TIME
       rtn_struct (theEnv, defruleModule, theModuleItem);
 #endif
@@ -271,6 +279,8 @@ AllocateModule (Environment * theEnv)
   theItem = get_struct (theEnv, defruleModule);
   theItem->agenda = NULL;
   theItem->groupings = NULL;
+  theItem->salienceIndex = NULL;
+  theItem->reorderNeeded = false;
   return ((void *) theItem);
 }
 
@@ -494,6 +504,11 @@ CL_AddBetaMemoriesToJoin (Environment * theEnv, struct joinNode *theNode)
 	  theNode->leftMemory->beta[0] = NULL;
 	  theNode->leftMemory->size = 1;
 	  theNode->leftMemory->count = 0;
+	  theNode->leftMemory->used = 0;
+	  theNode->leftMemory->hashes = NULL;
+	  theNode->leftMemory->live = 0;
+	  theNode->leftMemory->shrinkPending = false;
+	  theNode->leftMemory->nextShrinking = NULL;
 	  theNode->leftMemory->last = NULL;
 	}
       else
@@ -508,6 +523,11 @@ CL_AddBetaMemoriesToJoin (Environment * theEnv, struct joinNode *theNode)
 		  sizeof (struct partialMatch *) * INITIAL_BETA_HASH_SIZE);
 	  theNode->leftMemory->size = INITIAL_BETA_HASH_SIZE;
 	  theNode->leftMemory->count = 0;
+	  theNode->leftMemory->used = 0;
+	  theNode->leftMemory->hashes = NULL;
+	  theNode->leftMemory->live = 0;
+	  theNode->leftMemory->shrinkPending = false;
+	  theNode->leftMemory->nextShrinking = NULL;
 	  theNode->leftMemory->last = NULL;
 	}
 
@@ -541,6 +561,11 @@ CL_AddBetaMemoriesToJoin (Environment * theEnv, struct joinNode *theNode)
 	  theNode->rightMemory->last[0] = NULL;
 	  theNode->rightMemory->size = 1;
 	  theNode->rightMemory->count = 0;
+	  theNode->rightMemory->used = 0;
+	  theNode->rightMemory->hashes = NULL;
+	  theNode->rightMemory->live = 0;
+	  theNode->rightMemory->shrinkPending = false;
+	  theNode->rightMemory->nextShrinking = NULL;
 	}
       else
 	{
@@ -561,6 +586,11 @@ CL_AddBetaMemoriesToJoin (Environment * theEnv, struct joinNode *theNode)
 		  sizeof (struct partialMatch **) * INITIAL_BETA_HASH_SIZE);
 	  theNode->rightMemory->size = INITIAL_BETA_HASH_SIZE;
 	  theNode->rightMemory->count = 0;
+	  theNode->rightMemory->used = 0;
+	  theNode->rightMemory->hashes = NULL;
+	  theNode->rightMemory->live = 0;
+	  theNode->rightMemory->shrinkPending = false;
+	  theNode->rightMemory->nextShrinking = NULL;
 	}
     }
   else if (theNode->rightSideEntryStructure == NULL)
@@ -578,6 +608,11 @@ CL_AddBetaMemoriesToJoin (Environment * theEnv, struct joinNode *theNode)
       theNode->rightMemory->last[0] = theNode->rightMemory->beta[0];
       theNode->rightMemory->size = 1;
       theNode->rightMemory->count = 1;
+      theNode->rightMemory->used = 0;
+      theNode->rightMemory->hashes = NULL;
+      theNode->rightMemory->live = 0;
+      theNode->rightMemory->shrinkPending = false;
+      theNode->rightMemory->nextShrinking = NULL;
     }
   else
     {
@@ -182,6 +182,15 @@ CL_ReturnDefrule (Environment * theEnv, Defrule * theDefrule)
 	  CL_ReturnPackedExpression (theEnv, theDefrule->actions);
 	}
 
+      /*=======================================*/
+      /* Get rid of the CE order of the joins. */
+      /*=======================================*/
+
+      if (theDefrule->joinCEs != NULL)
+	{
+	  CL_genfree (theEnv, theDefrule->joinCEs, theDefrule->joinCECount);
+	}
+
       /*===============================*/
       /* Move on to the next disjunct. */
       /*===============================*/
@@ -258,6 +267,11 @@ CL_DestroyDefrule (Environment * theEnv, Defrule * theDefrule)
 	{
 	  CL_ReturnPackedExpression (theEnv, theDefrule->actions);
 	}
+
+      if (theDefrule->joinCEs != NULL)
+	{
+	  CL_genfree (theEnv, theDefrule->joinCEs, theDefrule->joinCECount);
+	}
 #endif
 
       nextDisjunct = theDefrule->disjunct;
@@ -555,6 +569,8 @@ DetachJoins (Environment * theEnv, struct joinNode *join, bool destroy)
       /* Delete the join. */
       /*==================*/
 
+      CL_ReleaseJoinTests (theEnv, join);
+
 #if (! RUN_TIME) && (! BLOAD_ONLY)
       rtn_struct (theEnv, joinNode, join);
 #endif
@@ -630,6 +646,7 @@ RemoveIntranetworkLink (Environment * theEnv, struct joinNode *join)
 	      lastJoin->rightMatchNode = joinPtr->rightMatchNode;
 	    }
 
+	  patternPtr->activeJoinsValid = false;
 	  joinPtr = NULL;
 	}
       else
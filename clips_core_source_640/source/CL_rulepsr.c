@@ -107,6 +107,8 @@ static Defrule *ProcessRuleLHS (Environment *, struct lhsParseNode *,
 static Defrule *CreateNewDisjunct (Environment *, CLIPSLexeme *,
 				   unsigned short, struct expr *,
 				   unsigned int, unsigned, struct joinNode *);
+static void RecordJoinCEs (Environment *, Defrule *,
+			   struct lhsParseNode *);
 static unsigned short RuleComplexity (Environment *, struct lhsParseNode *);
 static unsigned short ExpressionComplexity (Environment *, struct expr *);
 static int LogicalAnalysis (Environment *, struct lhsParseNode *);
@@ -499,6 +501,7 @@ ProcessRuleLHS (Environment * theEnv,
       currentDisjunct =
 	CreateNewDisjunct (theEnv, ruleName, localVarCnt, packPtr, complexity,
 			   (unsigned) logicalJoin, lastJoin);
+      RecordJoinCEs (theEnv, currentDisjunct, tempNode);
 
       /*============================================================*/
       /* Place the disjunct in the list of disjuncts for this rule. */
@@ -560,6 +563,8 @@ CreateNewDisjunct (Environment * theEnv,
   newDisjunct->header.usrData = NULL;
   newDisjunct->logicalJoin = NULL;
   newDisjunct->disjunct = NULL;
+  newDisjunct->joinCEs = NULL;
+  newDisjunct->joinCECount = 0;
   newDisjunct->header.constructType = DEFRULE;
   newDisjunct->header.env = theEnv;
   newDisjunct->header.name = ruleName;
@@ -573,6 +578,8 @@ CreateNewDisjunct (Environment * theEnv,
   newDisjunct->complexity = complexity;
   newDisjunct->auto_Focus = PatternData (theEnv)->GlobalAuto_Focus;
   newDisjunct->dynamicSalience = PatternData (theEnv)->SalienceExpression;
+  newDisjunct->salienceDependency = SALIENCE_UNANALYZED;
+  newDisjunct->salienceStamp = 0;
   newDisjunct->localVarCnt = localVarCnt;
 
    /*=====================================*/
@@ -613,6 +620,103 @@ CreateNewDisjunct (Environment * theEnv,
   return (newDisjunct);
 }
 
+/*************************************************************/
+/* RecordJoinCEs: Remembers which user CE each join of the   */
+/*   outer join chain of a disjunct matches, so that the     */
+/*   statistics gathered by optimize-rule-joins can be       */
+/*   related to CEs when the rule is rebuilt. Joins from the */
+/*   right and joins of added patterns are recorded as CE 0. */
+/*   The top level CEs are traversed the same way as in      */
+/*   CL_ConstructJoins, and nothing is recorded unless the   */
+/*   result is consistent with the joins which were built.   */
+/*************************************************************/
+static void
+RecordJoinCEs (Environment * theEnv,
+	       Defrule * theDisjunct, struct lhsParseNode *theLHS)
+{
+  unsigned char theCEs[JOIN_ORDER_MAX_CE];
+  unsigned short count = 0, i;
+  struct joinNode *theJoin;
+
+  while (theLHS != NULL)
+    {
+      if (count == JOIN_ORDER_MAX_CE)
+	{
+	  return;
+	}
+
+      if ((theLHS->pnType == PATTERN_CE_NODE) && theLHS->userCE &&
+	  (theLHS->beginNandDepth == 1) && (theLHS->endNandDepth == 1))
+	{
+	  theCEs[count++] = (unsigned char) theLHS->whichCE;
+	}
+      else
+	{
+	  theCEs[count++] = 0;
+	}
+
+      /*=================================================*/
+      /* Skip over a not/and group and the test CE which */
+      /* may follow it, since they share a single join.  */
+      /*=================================================*/
+
+      if (theLHS->endNandDepth > 1)
+	{
+	  while ((theLHS->bottom != NULL) &&
+		 (theLHS->bottom->endNandDepth > 1))
+	    {
+	      theLHS = theLHS->bottom;
+	    }
+
+	  theLHS = theLHS->bottom;
+
+	  if ((theLHS != NULL) && (theLHS->bottom != NULL) &&
+	      (theLHS->bottom->pnType == TEST_CE_NODE))
+	    {
+	      theLHS = theLHS->bottom;
+	    }
+	}
+
+      if (theLHS != NULL)
+	{
+	  theLHS = theLHS->bottom;
+	}
+    }
+
+   /*=====================================================*/
+  /* Check that each recorded pattern CE has a join with */
+  /* a positive pattern, and that the counts agree.      */
+   /*=====================================================*/
+
+  i = count;
+  for (theJoin = theDisjunct->lastJoin->lastLevel;
+       theJoin != NULL; theJoin = theJoin->lastLevel)
+    {
+      if (i == 0)
+	{
+	  return;
+	}
+      i--;
+
+      if ((theCEs[i] != 0) &&
+	  (theJoin->joinFromTheRight ||
+	   (theJoin->rightSideEntryStructure == NULL) ||
+	   theJoin->patternIsNegated || theJoin->patternIsExists))
+	{
+	  return;
+	}
+    }
+
+  if ((i != 0) || (count == 0))
+    {
+      return;
+    }
+
+  theDisjunct->joinCEs = (unsigned char *) CL_genalloc (theEnv, count);
+  memcpy (theDisjunct->joinCEs, theCEs, count);
+  theDisjunct->joinCECount = count;
+}
+
 /****************************************************************/
 /* ReplaceExpressionVariables: Replaces all symbolic references */
 /*   to variables (local and global) found in an expression on  */
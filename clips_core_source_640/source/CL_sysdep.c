@@ -171,6 +171,8 @@ struct systemDependentData
   int (*Before_OpenFunction) (Environment *);
   int (*After_OpenFunction) (Environment *);
   jmp_buf *jmpBuffer;
+  CL_FileOpenFunction *FileOpenFunction;
+  void *FileOpenContext;
 };
 
 #define SystemDependentData(theEnv) ((struct systemDependentData *) GetEnvironmentData(theEnv,SYSTEM_DEPENDENT_DATA))
@@ -519,6 +521,20 @@ int (*SetBefore_OpenFunction (Environment * theEnv,
   return (tempFunction);
 }
 
+/****************************************************************/
+/* CL_SetFileOpenFunction: Sets the function called with the    */
+/*   name and access type of each file CL_GenOpen opens, e.g.   */
+/*   to know which files a load or batch command read. A NULL   */
+/*   function removes it.                                       */
+/****************************************************************/
+void
+CL_SetFileOpenFunction (Environment * theEnv,
+			CL_FileOpenFunction * theFunction, void *context)
+{
+  SystemDependentData (theEnv)->FileOpenFunction = theFunction;
+  SystemDependentData (theEnv)->FileOpenContext = context;
+}
+
 /**********************************/
 /* SetAfter_OpenFunction: Sets the */
 /*  value of After_OpenFunction.   */
@@ -623,6 +639,21 @@ CL_GenOpen (Environment * theEnv,
 	}
     }
 
+   /*========================================*/
+  /* Tell the file open function which file */
+  /* was opened.                            */
+   /*========================================*/
+
+  if ((theFile != NULL) &&
+      (SystemDependentData (theEnv)->FileOpenFunction != NULL))
+    {
+      (*SystemDependentData (theEnv)->FileOpenFunction) (theEnv, fileName,
+							 accessType,
+							 SystemDependentData
+							 (theEnv)->
+							 FileOpenContext);
+    }
+
    /*=================================*/
   /* Invoke the after open function. */
    /*=================================*/
@@ -575,9 +575,12 @@ UpdateDeftemplate (Environment * theEnv, void *buf, unsigned long obji)
   theDeftemplate->watch = FactData (theEnv)->CL_Watch_Facts;
 #endif
   theDeftemplate->inScope = false;
+  theDeftemplate->noDuplicateCheck = false;
   theDeftemplate->numberOfSlots = bdtPtr->numberOfSlots;
   theDeftemplate->factList = NULL;
   theDeftemplate->lastFact = NULL;
+  theDeftemplate->lazySlotFunction = NULL;
+  theDeftemplate->lazySlotContext = NULL;
 }
 
 /************************************************/
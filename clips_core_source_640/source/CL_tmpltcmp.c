@@ -336,12 +336,13 @@ DeftemplateToCode (Environment * theEnv,
 	       imageID, (slotCount / maxIndices) + 1, slotCount % maxIndices);
     }
 
-   /*==========================================*/
+   /*=============================================*/
   /* Implied Flag, CL_Watch Flag, In Scope Flag, */
-  /* Number of Slots, and Busy Count.         */
-   /*==========================================*/
+  /* No Duplicate Check Flag, Number of Slots,   */
+  /* and Busy Count.                             */
+   /*=============================================*/
 
-  fprintf (theFile, "%d,0,0,%d,%ld,", theTemplate->implied,
+  fprintf (theFile, "%d,0,0,0,%d,%ld,", theTemplate->implied,
 	   theTemplate->numberOfSlots, theTemplate->busyCount);
 
    /*=================*/
@@ -363,7 +364,7 @@ DeftemplateToCode (Environment * theEnv,
   /* and close the structure.                   */
    /*============================================*/
 
-  fprintf (theFile, ",NULL,NULL}");
+  fprintf (theFile, ",NULL,NULL,NULL,NULL}");
 }
 
 /*****************************************************/
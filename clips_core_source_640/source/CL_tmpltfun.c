@@ -284,18 +284,7 @@ CL_ModifyCommand (Environment * theEnv,
 	  return;
 	}
 
-      oldFact = CL_GetNextFact (theEnv, NULL);
-      while (oldFact != NULL)
-	{
-	  if (oldFact->factIndex == factNum)
-	    {
-	      break;
-	    }
-	  else
-	    {
-	      oldFact = oldFact->nextFact;
-	    }
-	}
+      oldFact = CL_FindIndexedFact (theEnv, factNum);
 
       if (oldFact == NULL)
 	{
@@ -346,6 +335,8 @@ CL_ModifyCommand (Environment * theEnv,
   if (templatePtr->implied)
     return;
 
+  CL_MaterializeFact (theEnv, oldFact);
+
    /*========================================================*/
   /* Create a data object array to hold the updated values. */
    /*========================================================*/
@@ -759,18 +750,7 @@ CL_DuplicateCommand (Environment * theEnv,
 	  return;
 	}
 
-      oldFact = CL_GetNextFact (theEnv, NULL);
-      while (oldFact != NULL)
-	{
-	  if (oldFact->factIndex == factNum)
-	    {
-	      break;
-	    }
-	  else
-	    {
-	      oldFact = oldFact->nextFact;
-	    }
-	}
+      oldFact = CL_FindIndexedFact (theEnv, factNum);
 
       if (oldFact == NULL)
 	{
@@ -821,6 +801,8 @@ CL_DuplicateCommand (Environment * theEnv,
   if (templatePtr->implied)
     return;
 
+  CL_MaterializeFact (theEnv, oldFact);
+
    /*================================================================*/
   /* Duplicate the values from the old fact (skipping multifields). */
    /*================================================================*/
@@ -193,9 +193,12 @@ CL_ParseDeftemplate (Environment * theEnv, const char *readSource)
   newDeftemplate->busyCount = 0;
   newDeftemplate->watch = 0;
   newDeftemplate->inScope = true;
+  newDeftemplate->noDuplicateCheck = false;
   newDeftemplate->patternNetwork = NULL;
   newDeftemplate->factList = NULL;
   newDeftemplate->lastFact = NULL;
+  newDeftemplate->lazySlotFunction = NULL;
+  newDeftemplate->lazySlotContext = NULL;
   newDeftemplate->header.whichModule = (struct defmoduleItemHeader *)
     CL_GetModuleItem (theEnv, NULL,
 		      DeftemplateData (theEnv)->CL_DeftemplateModuleIndex);
@@ -459,6 +459,7 @@ CL_PrintTemplateFact (Environment * theEnv,
    /*==============================*/
 
   theDeftemplate = theFact->whichDeftemplate;
+  CL_MaterializeFact (theEnv, theFact);
   sublist = theFact->theProposition.contents;
 
    /*=============================================*/
@@ -623,9 +624,12 @@ CL_CreateImpliedDeftemplate (Environment * theEnv,
   newDeftemplate->implied = setFlag;
   newDeftemplate->numberOfSlots = 0;
   newDeftemplate->inScope = 1;
+  newDeftemplate->noDuplicateCheck = false;
   newDeftemplate->patternNetwork = NULL;
   newDeftemplate->factList = NULL;
   newDeftemplate->lastFact = NULL;
+  newDeftemplate->lazySlotFunction = NULL;
+  newDeftemplate->lazySlotContext = NULL;
   newDeftemplate->busyCount = 0;
   newDeftemplate->watch = false;
   newDeftemplate->header.next = NULL;
@@ -78,10 +78,25 @@ typedef enum
 #define MAX_DEFRULE_SALIENCE  10000
 #define MIN_DEFRULE_SALIENCE -10000
 
+#define ACTIVATION_INDEX_LEVELS 16
+
+#define SALIENCE_RANGE (MAX_DEFRULE_SALIENCE - MIN_DEFRULE_SALIENCE + 1)
+#define SALIENCE_INDEX_CHUNK 128
+#define SALIENCE_INDEX_CHUNKS \
+  ((SALIENCE_RANGE + SALIENCE_INDEX_CHUNK - 1) / SALIENCE_INDEX_CHUNK)
+#define SALIENCE_INDEX_WORDS ((SALIENCE_RANGE + 63) / 64)
+#define SALIENCE_SUMMARY_WORDS ((SALIENCE_INDEX_WORDS + 63) / 64)
+
 /*******************/
 /* DATA STRUCTURES */
 /*******************/
 
+struct activationLink
+{
+  struct activation *next;
+  struct activation *prev;
+};
+
 struct activation
 {
   Defrule *theRule;
@@ -91,6 +106,8 @@ struct activation
   int randomID;
   struct activation *prev;
   struct activation *next;
+  unsigned short indexLevels;
+  struct activationLink *indexLinks;
 };
 
 struct salienceGroup
@@ -100,8 +117,27 @@ struct salienceGroup
   struct activation *last;
   struct salienceGroup *next;
   struct salienceGroup *prev;
+  unsigned short indexLevels;
+  struct activation *indexHead[ACTIVATION_INDEX_LEVELS];
+};
+
+/*==========================================================*/
+/* The salience groups of the agenda of a defrule module,   */
+/* by salience. The groups are held in chunks of pointers   */
+/* allocated on demand. A bitmap of the saliences having a  */
+/* group, summarized by a bitmap of its non-zero words,     */
+/* finds where a new group goes in the list of groups.      */
+/*==========================================================*/
+
+struct salienceIndex
+{
+  struct salienceGroup **chunks[SALIENCE_INDEX_CHUNKS];
+  unsigned long long levels[SALIENCE_INDEX_WORDS];
+  unsigned long long summary[SALIENCE_SUMMARY_WORDS];
 };
 
+struct defruleModule;
+
 #include "crstrtgy.h"
 
 #define AGENDA_DATA 17
@@ -150,6 +186,7 @@ Salience_EvaluationType SetSalience_Evaluation (Environment *,
 						Salience_EvaluationType);
 void CL_Refresh_Agenda (Defmodule *);
 void CL_RefreshAll_Agendas (Environment *);
+void CL_UpdateAll_AgendaSaliences (Environment *);
 void Reorder_Agenda (Defmodule *);
 void ReorderAll_Agendas (Environment *);
 void Initialize_Agenda (Environment *);
@@ -158,6 +195,7 @@ void GetSalience_EvaluationCommand (Environment *, UDFContext *, UDFValue *);
 void CL_Refresh_AgendaCommand (Environment *, UDFContext *, UDFValue *);
 void CL_RefreshCommand (Environment *, UDFContext *, UDFValue *);
 void CL_Refresh (Defrule *);
+void CL_ReturnSalienceIndex (Environment *, struct defruleModule *);
 #if DEBUGGING_FUNCTIONS
 void CL_AgendaCommand (Environment *, UDFContext *, UDFValue *);
 #endif
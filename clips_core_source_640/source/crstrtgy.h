@@ -76,6 +76,9 @@ typedef enum
 
 void CL_PlaceActivation (Environment *, Activation **, Activation *,
 			 struct salienceGroup *);
+void CL_UnindexActivation (Environment *, Activation *,
+			   struct salienceGroup *);
+void CL_ReturnActivationIndex (Environment *, Activation *);
 StrategyType CL_SetStrategy (Environment *, StrategyType);
 StrategyType CL_GetStrategy (Environment *);
 void CL_SetStrategyCommand (Environment *, UDFContext *, UDFValue *);
@@ -65,5 +65,7 @@ bool CL_EvaluateSecondaryNetworkTest (Environment *, struct partialMatch *,
 				      struct joinNode *);
 void CL_EPMDrive (Environment *, struct partialMatch *, struct joinNode *,
 		  int);
+void CL_CompileJoinTests (Environment *, struct joinNode *);
+void CL_ReleaseJoinTests (Environment *, struct joinNode *);
 
 #endif /* _H_drive */
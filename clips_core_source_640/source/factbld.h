@@ -37,6 +37,7 @@
 #define _H_factbld
 
 struct factPatternNode;
+struct deftemplate;
 
 #include "network.h"
 #include "expressn.h"
@@ -57,5 +58,6 @@ struct factPatternNode
 
 void CL_InitializeFactPatterns (Environment *);
 void CL_DestroyFactPatternNetwork (Environment *, struct factPatternNode *);
+bool CL_DeftemplateHasPatterns (struct deftemplate *);
 
 #endif /* _H_factbld */
@@ -66,12 +66,18 @@
 void CL_FactCommandDefinitions (Environment *);
 void CL_AssertCommand (Environment *, UDFContext *, UDFValue *);
 void CL_RetractCommand (Environment *, UDFContext *, UDFValue *);
+void CL_RetractDeftemplateFactsCommand (Environment *, UDFContext *,
+					UDFValue *);
 void CL_AssertStringFunction (Environment *, UDFContext *, UDFValue *);
 void CL_FactsCommand (Environment *, UDFContext *, UDFValue *);
 void CL_Facts (Environment *, const char *, Defmodule *, long long, long long,
 	       long long);
 void CL_SetFactDuplicationCommand (Environment *, UDFContext *, UDFValue *);
 void CL_GetFactDuplicationCommand (Environment *, UDFContext *, UDFValue *);
+void CL_SetAlphaMatchThreadsCommand (Environment *, UDFContext *,
+				     UDFValue *);
+void CL_GetAlphaMatchThreadsCommand (Environment *, UDFContext *,
+				     UDFValue *);
 void CL_Save_FactsCommand (Environment *, UDFContext *, UDFValue *);
 void CL_Load_FactsCommand (Environment *, UDFContext *, UDFValue *);
 bool CL_Save_Facts (Environment *, const char *, CL_SaveScope);
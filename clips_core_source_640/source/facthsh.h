@@ -61,10 +61,13 @@ typedef struct factHashEntry FactHashEntry;
 struct factHashEntry
 {
   Fact *theFact;
+  unsigned long hashValue;
   FactHashEntry *next;
 };
 
-#define SIZE_FACT_HASH 16231
+#define SIZE_FACT_HASH 16384
+#define FACT_HASH_MOVE_STEP 2
+#define SIZE_FACT_INDEX_HASH 1024
 
 void CL_AddHashedFact (Environment *, Fact *, size_t);
 bool CL_RemoveHashedFact (Environment *, Fact *);
@@ -72,6 +75,9 @@ size_t CL_HandleFactDuplication (Environment *, Fact *, Fact **, long long);
 bool CL_GetFactDuplication (Environment *);
 bool CL_SetFactDuplication (Environment *, bool);
 void CL_InitializeFactHashTable (Environment *);
+void CL_AddIndexedFact (Environment *, Fact *);
+void CL_RemoveIndexedFact (Environment *, Fact *);
+Fact *CL_LookupIndexedFact (Environment *, long long);
 void ShowFactHashTableCommand (Environment *, UDFContext *, UDFValue *);
 size_t CL_HashFact (Fact *);
 bool FactWillBe_Asserted (Environment *, Fact *);
@@ -52,6 +52,50 @@
 #include "factbld.h"
 #include "factmngr.h"
 
+/***************************************************************/
+/* batchAlphaMatch: An alpha match found for a fact asserted   */
+/*   while a batch of assertions is open. It is sent to the    */
+/*   joins of its pattern when the batch ends. The position of */
+/*   the match and of the first match of its pattern order the */
+/*   matches when they are sent.                               */
+/***************************************************************/
+struct batchAlphaMatch
+{
+  Fact *theFact;
+  struct multifieldMarker *markers;
+  struct factPatternNode *thePattern;
+  unsigned long hashValue;
+  unsigned long position;
+  unsigned long groupPosition;
+  struct batchAlphaMatch *next;
+};
+
+/*************************************************************/
+/* The facts of a batch of assertions are pattern matched by */
+/* worker threads when there are at least this many facts    */
+/* for each thread.                                          */
+/*************************************************************/
+
+#define ALPHA_MATCH_THREAD_FACTS 64
+#define ALPHA_MATCH_MAX_THREADS 64
+
+/****************************************************************/
+/* factPatternMemo: Records that the pattern nodes beneath a    */
+/*   node produced no alpha match when their slot was matched   */
+/*   from a position of the current fact. Multifield wildcards  */
+/*   and variables reach the same position thru many different  */
+/*   bindings, so these failures are not matched again. An      */
+/*   entry is only valid for the generation of its fact match.  */
+/****************************************************************/
+struct factPatternMemo
+{
+  struct factPatternNode *thePattern;
+  size_t position;
+  unsigned long generation;
+};
+
+#define FACT_PATTERN_MEMO_SIZE 1024
+
 void CL_FactPatternMatch (Environment *, Fact *,
 			  struct factPatternNode *, size_t, size_t,
 			  struct multifieldMarker *,
@@ -60,5 +104,9 @@ void MarkFactPatternForCL_Incremental_Reset (Environment *,
 					     struct patternNodeHeader *,
 					     bool);
 void CL_FactsCL_Incremental_Reset (Environment *);
+bool CL_DeferFactPatternMatch (Environment *, Fact *);
+void CL_FlushBatchAlphaMatches (Environment *);
+void CL_ReturnBatchAlphaMatches (Environment *);
+void CL_ReturnFactPatternMemo (Environment *);
 
 #endif /* _H_factmch */
@@ -84,6 +84,7 @@
 
 typedef struct fact_Builder Fact_Builder;
 typedef struct factModifier FactModifier;
+struct batchAlphaMatch;
 
 #include "entities.h"
 #include "conscomp.h"
@@ -97,7 +98,8 @@ typedef enum
   RE_NO_ERROR = 0,
   RE_NULL_POINTER_ERROR,
   RE_COULD_NOT_RETRACT_ERROR,
-  RE_RULE_NETWORK_ERROR
+  RE_RULE_NETWORK_ERROR,
+  RE_NOT_FOUND_ERROR
 } CL_RetractError;
 
 typedef enum
@@ -164,6 +166,8 @@ struct fact
   Fact *previousTemplateFact;
   Fact *nextTemplateFact;
   Multifield *basisSlots;
+  void *lazySource;
+  Fact *nextIndexedFact;
   Multifield theProposition;
 };
 
@@ -172,6 +176,7 @@ struct fact_Builder
   Environment *fbEnv;
   Deftemplate *fbDeftemplate;
   CLIPSValue *fbValueArray;
+  void *fbLazySource;
 };
 
 struct factModifier
@@ -210,24 +215,59 @@ struct factsData
 #endif
   struct factHashEntry **FactHashTable;
   unsigned long FactHashTableSize;
+  struct factHashEntry **OldFactHashTable;
+  unsigned long OldFactHashTableSize;
+  unsigned long FactHashBucketsMoved;
+  Fact **FactIndexTable;
+  unsigned long FactIndexTableSize;
+  unsigned long FactIndexTableCount;
   bool FactDuplication;
 #if DEFRULE_CONSTRUCT
   Fact *CurrentPatternFact;
   struct multifieldMarker *CurrentPatternMarks;
+  bool BatchingAlphaMatches;
+  struct batchAlphaMatch *BatchAlphaMatches;
+  struct batchAlphaMatch *LastBatchAlphaMatch;
+  unsigned long BatchAlphaMatchCount;
+  Fact **DeferredFacts;
+  size_t DeferredFactCount;
+  size_t DeferredFactMax;
+  struct factPatternMemo *PatternMemo;
+  unsigned long PatternMemoGeneration;
+  unsigned long PatternMatchCount;
+  size_t PatternMemoMark;
 #endif
+  unsigned int AssertBatchDepth;
+  unsigned int AlphaMatchThreads;
   long LastModuleIndex;
   CL_RetractError retractError;
   CL_AssertError assertError;
   CL_AssertStringError assertStringError;
   FactModifierError factModifierError;
   Fact_BuilderError fact_BuilderError;
+  bool BulkRetractInProgress;
 };
 
 #define FactData(theEnv) ((struct factsData *) GetEnvironmentData(theEnv,FACTS_DATA))
 
+/*=====================================================*/
+/* The slots of a fact of a lazy deftemplate stay void */
+/* until they are first read thru this macro.          */
+/*=====================================================*/
+
+#define FactSlotContents(theEnv,theFact,theSlot) \
+   (((theFact)->theProposition.contents[theSlot].header->type == CL_VOID_TYPE) ? \
+    CL_FillLazyFactSlot(theEnv,theFact,theSlot) : \
+    &(theFact)->theProposition.contents[theSlot])
+
 Fact *CL_Assert (Fact *);
 CL_AssertStringError Get_AssertStringError (Environment *);
 Fact *CL_AssertDriver (Fact *, long long, Fact *, Fact *, char *);
+void CL_BeginAssertBatch (Environment *);
+void CL_EndAssertBatch (Environment *);
+size_t CL_AssertBatch (Environment *, Fact **, size_t);
+unsigned int CL_GetAlphaMatchThreads (Environment *);
+unsigned int CL_SetAlphaMatchThreads (Environment *, unsigned int);
 Fact *CL_AssertString (Environment *, const char *);
 Fact *CL_CreateFact (Deftemplate *);
 void CL_ReleaseFact (Fact *);
@@ -242,6 +282,15 @@ void CL_PrintFactIdentifierInLongFo_rm (Environment *, const char *, Fact *);
 CL_RetractError CL_Retract (Fact *);
 CL_RetractError CL_RetractDriver (Environment *, Fact *, bool, char *);
 CL_RetractError CL_RetractAll_Facts (Environment *);
+long long CL_FactMark (Environment *);
+bool CL_SetDeftemplateLazy (Deftemplate *, CL_LazySlotFunction *, void *);
+bool CL_SetDeftemplateDuplicateCheck (Deftemplate *, bool);
+void *CL_FactLazySource (Fact *);
+CLIPSValue *CL_FillLazyFactSlot (Environment *, Fact *, unsigned short);
+void CL_MaterializeFact (Environment *, Fact *);
+CL_RetractError CL_RetractFactsSince (Environment *, long long);
+CL_RetractError CL_RetractDeftemplateFacts (Deftemplate *);
+CL_RetractError CL_RetractIndexedFact (Environment *, long long);
 Fact *CL_CreateFactBySize (Environment *, size_t);
 void CL_FactInstall (Environment *, Fact *);
 void CL_FactDeinstall (Environment *, Fact *);
@@ -274,7 +323,10 @@ bool CL_Add_RetractFunction (Environment *, const char *,
 bool CL_Remove_RetractFunction (Environment *, const char *);
 Fact_Builder *CL_CreateFact_Builder (Environment *, const char *);
 PutSlotError CL_FBPutSlot (Fact_Builder *, const char *, CLIPSValue *);
+PutSlotError CL_FBPutSlotByIndex (Fact_Builder *, unsigned short,
+				  CLIPSValue *);
 Fact *FB_Assert (Fact_Builder *);
+void CL_FBSetLazySource (Fact_Builder *, void *);
 void CL_FBDispose (Fact_Builder *);
 void CL_FBAbort (Fact_Builder *);
 Fact_BuilderError CL_FBSetDeftemplate (Fact_Builder *, const char *);
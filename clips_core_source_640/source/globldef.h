@@ -80,6 +80,7 @@ struct defglobalData
   Construct *DefglobalConstruct;
   unsigned CL_DefglobalModuleIndex;
   bool ChangeToGlobals;
+  unsigned long long ChangeStamp;
 #if DEBUGGING_FUNCTIONS
   bool CL_WatchGlobals;
 #endif
@@ -101,6 +102,7 @@ struct defglobal
   long busyCount;
   CLIPSValue current;
   struct expr *initial;
+  unsigned long long changeStamp;
 };
 
 struct defglobalModule
@@ -40,6 +40,7 @@
 typedef struct genericMatch GenericMatch;
 typedef struct patternMatch PatternMatch;
 typedef struct partialMatch PartialMatch;
+typedef struct partialMatchExtra PartialMatchExtra;
 typedef struct alphaMatch AlphaMatch;
 typedef struct multifieldMarker MultifieldMarker;
 
@@ -81,7 +82,7 @@ struct partialMatch
   unsigned long hashValue;
   void *owner;
   void *marker;
-  void *dependents;
+  PartialMatchExtra *extra;
   PartialMatch *nextInMemory;
   PartialMatch *prevInMemory;
   PartialMatch *children;
@@ -91,12 +92,31 @@ struct partialMatch
   PartialMatch *leftParent;
   PartialMatch *nextLeftChild;
   PartialMatch *prevLeftChild;
+  GenericMatch binds[1];
+};
+
+/*********************************************************/
+/* partialMatchExtra: The links of a partial match which */
+/*   only matter for logical CEs and for not and exists  */
+/*   CEs. It is allocated only when one of them is set.  */
+/*********************************************************/
+struct partialMatchExtra
+{
+  void *dependents;
   PartialMatch *blockList;
   PartialMatch *nextBlocked;
   PartialMatch *prevBlocked;
-  GenericMatch binds[1];
 };
 
+#define PMDependents(pm) \
+   (((pm)->extra == NULL) ? NULL : (pm)->extra->dependents)
+#define PMBlockList(pm) \
+   (((pm)->extra == NULL) ? NULL : (pm)->extra->blockList)
+#define PMNextBlocked(pm) \
+   (((pm)->extra == NULL) ? NULL : (pm)->extra->nextBlocked)
+#define PMPrevBlocked(pm) \
+   (((pm)->extra == NULL) ? NULL : (pm)->extra->prevBlocked)
+
 /**************/
 /* alphaMatch */
 /**************/
@@ -158,6 +158,7 @@ struct memoryPtr
 struct memoryData
 {
   long long MemoryAmount;
+  long long MemoryPeak;
   long long MemoryCalls;
   bool ConserveMemory;
   OutOfMemoryFunction *OutOfMemoryCallback;
@@ -177,6 +178,7 @@ void CL_genfree (Environment *, void *, size_t);
 void *CL_genrealloc (Environment *, void *, size_t, size_t);
 long long CL_MemUsed (Environment *);
 long long CL_MemRequests (Environment *);
+long long CL_MemPeak (Environment *);
 long long CL_UpdateMemoryUsed (Environment *, long long);
 long long CL_UpdateMemoryRequests (Environment *, long long);
 long long CL_ReleaseMem (Environment *, long long);
@@ -54,6 +54,9 @@ struct patternNodeHeader
   unsigned int beginSlot:1;
   unsigned int endSlot:1;
   unsigned int selector:1;
+  unsigned int activeJoinsValid:1;
+  unsigned int flushing:1;
+  struct joinNode *activeJoin;
 };
 
 #include "match.h"
@@ -89,12 +92,30 @@ typedef struct alphaMemoryHash ALPHA_MEMORY_HASH;
 
 #define INITIAL_BETA_HASH_SIZE 17
 
+/*****************************************************/
+/* A hashed beta memory (size > 1) is an open        */
+/*   addressing table: each slot of beta/last holds  */
+/*   the chain of the partial matches sharing one    */
+/*   hash value, and hashes[slot] is that hash value */
+/*   plus one, or 0 for a free slot, so probing only */
+/*   reads the contiguous hashes array. A slot whose */
+/*   chain becomes empty stays claimed until the     */
+/*   memory is rehashed; used counts claimed slots,  */
+/*   and live the slots with a non empty chain. A    */
+/*   memory left sparse by retractions is queued     */
+/*   thru nextShrinking to be shrunk at a safe point.*/
+/*****************************************************/
 struct betaMemory
 {
   unsigned long size;
   unsigned long count;
+  unsigned long used;
+  unsigned long live;
   struct partialMatch **beta;
   struct partialMatch **last;
+  unsigned long *hashes;
+  bool shrinkPending;
+  struct betaMemory *nextShrinking;
 };
 
 struct joinLink
@@ -105,6 +126,49 @@ struct joinLink
   unsigned long bsaveID;
 };
 
+/***************************************************************/
+/* joinTestStep: One expression of a compiled join test or     */
+/*   hash expression. Slot comparisons between two facts are   */
+/*   decoded into the step, the evaluation function of other   */
+/*   primitives is looked up once, and the remaining           */
+/*   expressions are evaluated as usual. See                   */
+/*   set-join-test-compilation.                                */
+/***************************************************************/
+
+#define JOIN_STEP_GENERAL        0
+#define JOIN_STEP_NESTED         1
+#define JOIN_STEP_PRIMITIVE      2
+#define JOIN_STEP_SLOT_COMPARE   3
+
+struct joinTestStep
+{
+  unsigned int kind:2;
+  unsigned int pass:1;
+  unsigned int fail:1;
+  unsigned int p2rhs:1;
+  unsigned short pattern1;
+  unsigned short slot1;
+  unsigned short pattern2;
+  unsigned short slot2;
+  Entity_EvaluationFunction *evaluateFunction;
+  Expression *theExpression;
+};
+
+struct joinTestCode
+{
+  bool andLogic;
+  unsigned short stepCount;
+  struct joinTestStep steps[1];
+};
+
+struct compiledJoinTests
+{
+  struct joinTestCode *networkTest;
+  struct joinTestCode *secondaryNetworkTest;
+  struct joinTestCode *leftHash;
+  struct joinTestCode *rightHash;
+};
+
 struct joinNode
 {
   unsigned int firstJoin:1;
@@ -116,6 +180,7 @@ struct joinNode
   unsigned int marked:1;
   unsigned int rhsType:3;
   unsigned int depth:16;
+  unsigned int rightUnlinked:1;
   unsigned long bsaveID;
   long long memoryLeftAdds;
   long long memoryRightAdds;
@@ -133,6 +198,8 @@ struct joinNode
   struct joinNode *lastLevel;
   struct joinNode *rightMatchNode;
   Defrule *ruleToActivate;
+  struct compiledJoinTests *compiledTests;
+  struct joinNode *nextActiveJoin;
 };
 
 #endif /* _H_network */
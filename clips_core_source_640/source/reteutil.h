@@ -66,6 +66,10 @@
 #define NETWORK_ASSERT  0
 #define NETWORK_RETRACT 1
 
+#define RIGHT_UNLINKABLE_JOIN(join) \
+   ((! (join)->firstJoin) && (! (join)->joinFromTheRight) && \
+    ((join)->rightSideEntryStructure != NULL))
+
 void CL_PrintPartialMatch (Environment *, const char *,
 			   struct partialMatch *);
 struct partialMatch *CL_CopyPartialMatch (Environment *,
@@ -80,10 +84,13 @@ struct partialMatch *CL_GetAlphaMemory (Environment *,
 struct partialMatch *CL_GetLeftBetaMemory (struct joinNode *, unsigned long);
 struct partialMatch *CL_GetRightBetaMemory (struct joinNode *, unsigned long);
 void CL_ReturnLeftMemory (Environment *, struct joinNode *);
+void CL_ShrinkBetaMemories (Environment *);
 void CL_ReturnRightMemory (Environment *, struct joinNode *);
 void CL_DestroyBetaMemory (Environment *, struct joinNode *, int);
 void CL_FlushBetaMemory (Environment *, struct joinNode *, int);
 bool CL_BetaMemoryNotEmpty (struct joinNode *);
+struct joinNode *CL_FirstActiveJoin (struct patternNodeHeader *);
+struct joinNode *CL_NextActiveJoin (struct joinNode *);
 void RemoveAlphaMemory_Matches (Environment *, struct patternNodeHeader *,
 				struct partialMatch *, struct alphaMatch *);
 void CL_DestroyAlphaMemory (Environment *, struct patternNodeHeader *, bool);
@@ -114,9 +121,14 @@ void CL_UnlinkBetaPMFromNodeAndLineage (Environment *, struct joinNode *,
 void CL_UnlinkNonLeftLineage (Environment *, struct joinNode *,
 			      struct partialMatch *, int);
 struct partialMatch *CL_CreateEmptyPartialMatch (Environment *);
+unsigned long long CL_GetPartialMatchCount (Environment *);
 void CL_MarkRuleJoins (struct joinNode *, bool);
-void CL_AddBlockedLink (struct partialMatch *, struct partialMatch *);
-void CL_RemoveBlockedLink (struct partialMatch *);
+void CL_AddBlockedLink (Environment *, struct partialMatch *,
+			struct partialMatch *);
+void CL_RemoveBlockedLink (Environment *, struct partialMatch *);
+struct partialMatchExtra *CL_GetPartialMatchExtra (Environment *,
+						   struct partialMatch *);
+void CL_ReleasePartialMatchExtra (Environment *, struct partialMatch *);
 unsigned long CL_PrintBetaMemory (Environment *, const char *,
 				  struct betaMemory *, bool, const char *,
 				  int);
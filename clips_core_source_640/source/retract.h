@@ -60,6 +60,9 @@ struct rdriveinfo
 };
 
 void CL_Network_Retract (Environment *, struct patternMatch *);
+void CL_Network_RetractJoins (Environment *, struct patternMatch *);
+void CL_Network_RetractAlphaMatches (Environment *, struct patternMatch *,
+				     bool);
 void CL_ReturnPartialMatch (Environment *, struct partialMatch *);
 void CL_DestroyPartialMatch (Environment *, struct partialMatch *);
 void CL_FlushGarbagePartial_Matches (Environment *);
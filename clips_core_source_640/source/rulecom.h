@@ -94,6 +94,22 @@ void CL_GetBetaMemoryResizingCommand (Environment *, UDFContext *,
 				      UDFValue *);
 void CL_SetBetaMemoryResizingCommand (Environment *, UDFContext *,
 				      UDFValue *);
+void CL_GetBetaMemoryThresholds (Environment *, unsigned short *,
+				 unsigned short *);
+bool CL_SetBetaMemoryThresholds (Environment *, unsigned short,
+				 unsigned short);
+void CL_GetBetaMemoryThresholdsCommand (Environment *, UDFContext *,
+					UDFValue *);
+void CL_SetBetaMemoryThresholdsCommand (Environment *, UDFContext *,
+					UDFValue *);
+bool CL_GetJoinTestCompilation (Environment *);
+bool CL_SetJoinTestCompilation (Environment *, bool);
+void CL_GetJoinTestCompilationCommand (Environment *, UDFContext *,
+				       UDFValue *);
+void CL_SetJoinTestCompilationCommand (Environment *, UDFContext *,
+				       UDFValue *);
+bool CL_OptimizeRuleJoins (Environment *, Defrule *);
+void CL_OptimizeRuleJoinsCommand (Environment *, UDFContext *, UDFValue *);
 void CL_Matches (Defrule *, Verbosity, CLIPSValue *);
 void CL_JoinActivity (Environment *, Defrule *, int, UDFValue *);
 void CL_DefruleCommands (Environment *);
@@ -76,6 +76,10 @@
 
 #define GetDisjunctIndex(r) (r->header.bsaveID)
 
+#define SALIENCE_UNANALYZED    0
+#define SALIENCE_READS_GLOBALS 1
+#define SALIENCE_VOLATILE      2
+
 typedef struct defrule Defrule;
 struct defruleModule;
 
@@ -100,6 +104,10 @@ struct defrule
   struct joinNode *logicalJoin;
   struct joinNode *lastJoin;
   Defrule *disjunct;
+  unsigned char *joinCEs;
+  unsigned short joinCECount;
+  unsigned short salienceDependency;
+  unsigned long long salienceStamp;
 };
 
 #include "agenda.h"
@@ -115,12 +123,53 @@ struct defruleModule
   struct defmoduleItemHeader header;
   struct salienceGroup *groupings;
   struct activation *agenda;
+  struct salienceIndex *salienceIndex;
+  bool reorderNeeded;
 };
 
 #ifndef ALPHA_MEMORY_HASH_SIZE
 #define ALPHA_MEMORY_HASH_SIZE       63559L
 #endif
 
+/*==========================================================*/
+/* A hashed beta memory grows when more than GROW_LOAD per  */
+/* cent of its slots hold partial matches, and is shrunk at */
+/* the next safe point when less than SHRINK_LOAD per cent  */
+/* of them do. See set-beta-memory-thresholds.              */
+/*==========================================================*/
+
+#ifndef BETA_MEMORY_GROW_LOAD
+#define BETA_MEMORY_GROW_LOAD         50
+#endif
+
+#ifndef BETA_MEMORY_SHRINK_LOAD
+#define BETA_MEMORY_SHRINK_LOAD        5
+#endif
+
+/*==========================================================*/
+/* Statistics gathered by optimize-rule-joins for each user */
+/* CE of each disjunct of a rule, indexed by the CE number. */
+/* While a rule is rebuilt with a pending request, its      */
+/* pattern CEs are reordered according to them.             */
+/*==========================================================*/
+
+#define JOIN_ORDER_MAX_CE            128
+
+struct joinOrderCE
+{
+  bool known;
+  unsigned short position;
+  double cardinality;
+  double fanout;
+};
+
+struct joinOrderRequest
+{
+  unsigned short disjunctCount;
+  struct joinOrderCE *statistics;
+  bool changed;
+};
+
 #define DEFRULE_DATA 16
 
 struct defruleData
@@ -130,8 +179,14 @@ struct defruleData
   unsigned long long CurrentEntityTimeTag;
   struct alphaMemoryHash **AlphaMemoryTable;
   bool BetaMemoryResizingFlag;
+  unsigned short BetaMemoryGrowLoad;
+  unsigned short BetaMemoryShrinkLoad;
+  struct betaMemory *ShrinkingMemories;
+  bool CompileJoinTestsFlag;
   struct joinLink *RightPrimeJoins;
   struct joinLink *LeftPrimeJoins;
+  unsigned long long PartialMatchCount;
+  struct joinOrderRequest *JoinOrderRequest;
 
 #if DEBUGGING_FUNCTIONS
   bool CL_WatchRules;
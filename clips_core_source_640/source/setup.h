@@ -457,6 +457,21 @@ extern void CLGCC_dodbgprintf (const char *srcfil, int lin, const char *fmt,
 #define PROFILING_FUNCTIONS 1
 #endif
 
+/******************************************************/
+/* ALPHA_MATCH_THREADS: Enables worker threads (POSIX */
+/*   threads) for pattern matching the facts of a     */
+/*   batch of assertions. Their number is set with    */
+/*   the set-alpha-match-threads command.             */
+/******************************************************/
+
+#ifndef ALPHA_MATCH_THREADS
+#if LINUX || DARWIN || UNIX_V || UNIX_7
+#define ALPHA_MATCH_THREADS 1
+#else
+#define ALPHA_MATCH_THREADS 0
+#endif
+#endif
+
 /*******************************************************************/
 /* WINDOW_INTERFACE : Set this flag if you are recompiling any of  */
 /*   the machine specific GUI interfaces. Currently, when enabled, */
@@ -105,6 +105,14 @@
 #include <stdio.h>
 #include <setjmp.h>
 
+/*====================================================*/
+/* Called with the name and access type of each file  */
+/* opened by CL_GenOpen, see CL_SetFileOpenFunction.  */
+/*====================================================*/
+
+typedef void CL_FileOpenFunction (Environment *, const char *, const char *,
+				  void *);
+
 double CL_gentime (void);
 int CL_gensystem (Environment *, const char *);
 int CL_GenOpenReadBinary (Environment *, const char *, const char *);
@@ -130,6 +138,7 @@ int (*SetBefore_OpenFunction (Environment *, int (*)(Environment *)))
   (Environment *);
 int (*SetAfter_OpenFunction (Environment *, int (*)(Environment *)))
   (Environment *);
+void CL_SetFileOpenFunction (Environment *, CL_FileOpenFunction *, void *);
 int CL_gensprintf (char *, const char *, ...);
 char *CL_genstrcpy (char *, const char *);
 char *CL_genstrncpy (char *, const char *, size_t);
@@ -83,6 +83,15 @@ struct deftemplateModule
 #include "constrnt.h"
 #include "factbld.h"
 
+/*==================================================*/
+/* Computes the value of a slot of a fact asserted */
+/* with a lazy source, see CL_SetDeftemplateLazy.  */
+/* Leaving the value void gives the slot default.  */
+/*==================================================*/
+
+typedef bool CL_LazySlotFunction (Environment *, Fact *, unsigned short,
+				  CLIPSValue *, void *);
+
 struct deftemplate
 {
   ConstructHeader header;
@@ -90,11 +99,14 @@ struct deftemplate
   unsigned int implied:1;
   unsigned int watch:1;
   unsigned int inScope:1;
+  unsigned int noDuplicateCheck:1;
   unsigned short numberOfSlots;
   long busyCount;
   struct factPatternNode *patternNetwork;
   Fact *factList;
   Fact *lastFact;
+  CL_LazySlotFunction *lazySlotFunction;
+  void *lazySlotContext;
 };
 
 struct templateSlot
@@ -0,0 +1,28 @@
+// 
+//
+//  https://github.com/bstarynk/clips-rules-gcc
+//
+//  file testdir/T002_gimple/input.c
+//
+//  Copyright © 2020 CEA (Commissariat à l'énergie atomique et aux énergies alternatives)
+//  contributed by Basile Starynkevitch.
+
+#include <stdio.h>
+
+static int
+sum_squares (int n)
+{
+  int s = 0;
+  for (int i = 0; i < n; i++)
+    s += i * i;
+  return s;
+}
+
+int
+main (int argc, char **argv)
+{
+  printf ("hello from %s: %d\n", argv[0], sum_squares (argc));
+  return 0;
+}
+
+// end of file testdir/T002_gimple/input.c
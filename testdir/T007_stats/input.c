@@ -0,0 +1,34 @@
+// 
+//
+//  https://github.com/bstarynk/clips-rules-gcc
+//
+//  file testdir/T007_stats/input.c
+//
+//  Copyright © 2020 CEA (Commissariat à l'énergie atomique et aux énergies alternatives)
+//  contributed by Basile Starynkevitch.
+
+#include <stdio.h>
+
+int
+twice (int x)
+{
+  return 2 * x;
+}
+
+int
+sum_twice (int n)
+{
+  int s = 0;
+  for (int i = 0; i < n; i++)
+    s += twice (i);
+  return s;
+}
+
+int
+main (int argc, char **argv)
+{
+  printf ("hello from %s: %d\n", argv[0], sum_twice (argc));
+  return 0;
+}
+
+// end of file testdir/T007_stats/input.c
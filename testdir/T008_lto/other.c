@@ -0,0 +1,25 @@
+// 
+//
+//  https://github.com/bstarynk/clips-rules-gcc
+//
+//  file testdir/T008_lto/other.c
+//
+//  Copyright © 2020 CEA (Commissariat à l'énergie atomique et aux énergies alternatives)
+//  contributed by Basile Starynkevitch.
+
+static int
+twice (int x)
+{
+  return 2 * x;
+}
+
+int
+sum_twice (int n)
+{
+  int s = 0;
+  for (int i = 0; i < n; i++)
+    s += twice (i);
+  return s;
+}
+
+// end of file testdir/T008_lto/other.c
@@ -0,0 +1,28 @@
+// 
+//
+//  https://github.com/bstarynk/clips-rules-gcc
+//
+//  file testdir/T010_server/input.c
+//
+//  Copyright © 2020 CEA (Commissariat à l'énergie atomique et aux énergies alternatives)
+//  contributed by Basile Starynkevitch.
+
+#include <stdio.h>
+
+extern void show (const char *msg, int n);
+
+int
+main (int argc, char **argv)
+{
+  printf ("hello from %s: %d\n", argv[0], argc);
+  show ("argc", argc);
+  return 0;
+}
+
+void
+show (const char *msg, int n)
+{
+  printf ("%s is %d\n", msg, n);
+}
+
+// end of file testdir/T010_server/input.c